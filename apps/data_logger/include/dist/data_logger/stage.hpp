@@ -0,0 +1,15 @@
+#pragma once
+
+#include "dist/common/stage.hpp"
+
+namespace dist::data_logger {
+
+// Data logger: stores processed frames until --bench input goes quiet or
+// request_stop(), taking the same command line as the `data_logger` binary. Runs once per
+// process; returns the exit status.
+int run(int argc, char** argv, const dist::common::StageRuntime& runtime = {});
+
+// Stop receiving; queued frames are still written before run() returns (thread-safe).
+void request_stop();
+
+}  // namespace dist::data_logger
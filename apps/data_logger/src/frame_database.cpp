@@ -0,0 +1,508 @@
+#include "frame_database.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "dist/common/metrics.hpp"
+#include "dist/common/utils.hpp"
+
+namespace dist::data_logger {
+
+namespace {
+
+constexpr std::size_t kDefaultBatchSize = 64;
+
+// Bump together with a new entry in ensure_schema(); stored in PRAGMA user_version.
+constexpr int kSchemaVersion = 7;
+
+// The original single-table layout. Blob columns stay for old rows; new rows keep
+// their keypoints and descriptors in frame_features (v2).
+constexpr const char* kFramesTableSql = R"SQL(
+    CREATE TABLE IF NOT EXISTS frames (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        frame_id INTEGER,
+        loop_iteration INTEGER,
+        source_timestamp TEXT,
+        processed_timestamp TEXT,
+        filename TEXT,
+        width INTEGER,
+        height INTEGER,
+        channels INTEGER,
+        encoding TEXT,
+        keypoint_count INTEGER,
+        descriptor_rows INTEGER,
+        descriptor_cols INTEGER,
+        descriptor_elem_size INTEGER,
+        descriptor_type INTEGER,
+        descriptors_bytes INTEGER,
+        image_path TEXT,
+        metadata_json TEXT,
+        descriptors BLOB,
+        created_at TEXT,
+        keypoints BLOB,
+        image_segment INTEGER,
+        image_offset INTEGER,
+        image_length INTEGER,
+        annotated_segment INTEGER,
+        annotated_offset INTEGER,
+        annotated_length INTEGER
+    );
+)SQL";
+
+// v2: bulky per-frame blobs move to a side table so metadata scans stay on small pages.
+constexpr const char* kFeaturesTableSql = R"SQL(
+    CREATE TABLE IF NOT EXISTS frame_features (
+        frame_row_id INTEGER PRIMARY KEY REFERENCES frames(id) ON DELETE CASCADE,
+        keypoints BLOB,
+        descriptors BLOB
+    );
+    INSERT OR IGNORE INTO frame_features (frame_row_id, keypoints, descriptors)
+        SELECT id, keypoints, descriptors FROM frames
+        WHERE keypoints IS NOT NULL OR descriptors IS NOT NULL;
+    UPDATE frames SET keypoints = NULL, descriptors = NULL
+        WHERE keypoints IS NOT NULL OR descriptors IS NOT NULL;
+)SQL";
+
+// v3: integer epoch timestamps for range queries, plus the lookup indexes. Julian days
+// keep the fraction strftime('%s') would drop; ROUND absorbs the double's error.
+constexpr const char* kTimeIndexSql = R"SQL(
+    ALTER TABLE frames ADD COLUMN source_time_ms INTEGER;
+    ALTER TABLE frames ADD COLUMN processed_time_ms INTEGER;
+    UPDATE frames SET
+        source_time_ms =
+            CAST(ROUND((julianday(source_timestamp) - 2440587.5) * 86400000) AS INTEGER),
+        processed_time_ms =
+            CAST(ROUND((julianday(processed_timestamp) - 2440587.5) * 86400000) AS INTEGER);
+    CREATE INDEX IF NOT EXISTS idx_frames_frame_id ON frames(frame_id);
+    CREATE INDEX IF NOT EXISTS idx_frames_loop_iteration ON frames(loop_iteration);
+    CREATE INDEX IF NOT EXISTS idx_frames_processed_time ON frames(processed_time_ms);
+)SQL";
+
+// v4: descriptor blobs may be compressed; NULL on older rows means "none".
+constexpr const char* kDescriptorCodecSql = R"SQL(
+    ALTER TABLE frames ADD COLUMN descriptor_compression TEXT;
+)SQL";
+
+// v5: per-stage latency of each frame, from the FrameTrace stamps carried in the headers.
+// Durations are nanoseconds between consecutive stage boundaries; NULL when a stage was
+// not stamped (older generator or extractor).
+constexpr const char* kTracesTableSql = R"SQL(
+    CREATE TABLE IF NOT EXISTS frame_traces (
+        frame_row_id INTEGER PRIMARY KEY REFERENCES frames(id) ON DELETE CASCADE,
+        read_time_ns INTEGER,
+        encode_ns INTEGER,
+        send_ns INTEGER,
+        transit_in_ns INTEGER,
+        decode_ns INTEGER,
+        detect_ns INTEGER,
+        serialize_ns INTEGER,
+        transit_out_ns INTEGER,
+        persist_ns INTEGER,
+        total_ns INTEGER
+    );
+)SQL";
+
+// v6: frames from several cameras share the table; frame ids repeat across streams.
+// Rows from before streams existed keep NULL, i.e. the single default stream.
+constexpr const char* kStreamColumnSql = R"SQL(
+    ALTER TABLE frames ADD COLUMN stream_id TEXT;
+    CREATE INDEX IF NOT EXISTS idx_frames_stream_frame ON frames(stream_id, frame_id);
+)SQL";
+
+// v7: earlier v3 backfills truncated legacy rows to whole seconds. Only values on a
+// second boundary can be affected; recomputing one that is exact leaves it unchanged.
+constexpr const char* kSubsecondTimesSql = R"SQL(
+    UPDATE frames SET source_time_ms =
+            CAST(ROUND((julianday(source_timestamp) - 2440587.5) * 86400000) AS INTEGER)
+        WHERE source_time_ms % 1000 = 0;
+    UPDATE frames SET processed_time_ms =
+            CAST(ROUND((julianday(processed_timestamp) - 2440587.5) * 86400000) AS INTEGER)
+        WHERE processed_time_ms % 1000 = 0;
+)SQL";
+
+// frame_traces columns after read_time_ns follow dist::common::kTraceSpans in order.
+using dist::common::TraceStage;
+
+void bind_time(sqlite3_stmt* stmt, int index, const std::string& timestamp) {
+    if (const auto millis = dist::common::iso8601_to_epoch_ms(timestamp)) {
+        sqlite3_bind_int64(stmt, index, *millis);
+    } else {
+        sqlite3_bind_null(stmt, index);
+    }
+}
+
+void bind_blob(sqlite3_stmt* stmt, int index, const void* data, std::size_t size) {
+    if (size > 0) {
+        sqlite3_bind_blob(stmt, index, data, static_cast<int>(size), SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_null(stmt, index);
+    }
+}
+
+// Pragma values are spliced into SQL, so only accept the documented keywords.
+template <std::size_t N>
+std::string pick(std::string_view value,
+                 const std::array<std::string_view, N>& allowed,
+                 std::string_view fallback,
+                 std::string_view setting) {
+    std::string upper(value);
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char ch) {
+        return static_cast<char>(std::toupper(ch));
+    });
+    if (std::find(allowed.begin(), allowed.end(), upper) != allowed.end()) {
+        return upper;
+    }
+    spdlog::warn("{}={} is invalid; using {}", setting, value, fallback);
+    return std::string(fallback);
+}
+
+}  // namespace
+
+FrameDatabase::FrameDatabase(const dist::common::DataLoggerConfig& config) {
+    if (sqlite3_open(config.db_path.string().c_str(), &db_) != SQLITE_OK) {
+        std::string message = db_ != nullptr ? sqlite3_errmsg(db_) : "out of memory";
+        sqlite3_close(db_);
+        db_ = nullptr;
+        throw std::runtime_error("Unable to open database at " + config.db_path.string() + ": " +
+                                 message);
+    }
+
+    if (config.batch_size > 0) {
+        batch_size_ = static_cast<std::size_t>(config.batch_size);
+    } else {
+        spdlog::warn("DATA_LOGGER_BATCH_SIZE={} is invalid; using default {}",
+                     config.batch_size,
+                     kDefaultBatchSize);
+        batch_size_ = kDefaultBatchSize;
+    }
+    flush_interval_ = std::chrono::milliseconds(std::max(config.flush_interval_ms, 0));
+
+    try {
+        ensure_schema(config);
+    } catch (...) {
+        sqlite3_close(db_);
+        db_ = nullptr;
+        throw;
+    }
+
+    static constexpr const char* insert_sql = R"SQL(
+        INSERT INTO frames (
+            frame_id, loop_iteration, source_timestamp, processed_timestamp, filename,
+            width, height, channels, encoding,
+            keypoint_count, descriptor_rows, descriptor_cols, descriptor_elem_size,
+            descriptor_type, descriptors_bytes, image_path, metadata_json, created_at,
+            image_segment, image_offset, image_length,
+            annotated_segment, annotated_offset, annotated_length,
+            source_time_ms, processed_time_ms, descriptor_compression, stream_id
+        ) VALUES (
+            ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?
+        );
+    )SQL";
+    static constexpr const char* features_sql = R"SQL(
+        INSERT INTO frame_features (frame_row_id, keypoints, descriptors) VALUES (?, ?, ?);
+    )SQL";
+    static constexpr const char* traces_sql = R"SQL(
+        INSERT INTO frame_traces (
+            frame_row_id, read_time_ns, encode_ns, send_ns, transit_in_ns, decode_ns,
+            detect_ns, serialize_ns, transit_out_ns, persist_ns, total_ns
+        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+    )SQL";
+
+    if (sqlite3_prepare_v2(db_, insert_sql, -1, &insert_stmt_, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db_, features_sql, -1, &features_stmt_, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db_, traces_sql, -1, &traces_stmt_, nullptr) != SQLITE_OK) {
+        std::string message = sqlite3_errmsg(db_);
+        sqlite3_finalize(insert_stmt_);
+        sqlite3_finalize(features_stmt_);
+        sqlite3_close(db_);
+        db_ = nullptr;
+        throw std::runtime_error("Failed to prepare insert statements: " + message);
+    }
+}
+
+FrameDatabase::~FrameDatabase() {
+    try {
+        flush();
+    } catch (const std::exception& ex) {
+        spdlog::error("{}", ex.what());
+    }
+    sqlite3_finalize(insert_stmt_);
+    sqlite3_finalize(features_stmt_);
+    sqlite3_finalize(traces_stmt_);
+    sqlite3_close(db_);
+}
+
+void FrameDatabase::exec(const char* sql, const char* what) {
+    char* errmsg = nullptr;
+    if (sqlite3_exec(db_, sql, nullptr, nullptr, &errmsg) != SQLITE_OK) {
+        std::string message = errmsg ? errmsg : "unknown error";
+        sqlite3_free(errmsg);
+        throw std::runtime_error(std::string("Failed to ") + what + ": " + message);
+    }
+}
+
+// Idempotent table creation so the logger can start from a blank directory.
+void FrameDatabase::ensure_schema(const dist::common::DataLoggerConfig& config) {
+    // WAL lets a commit append to the log instead of rewriting pages; with
+    // synchronous=NORMAL it only fsyncs at checkpoints.
+    static constexpr std::array<std::string_view, 6> kJournalModes{
+        "WAL", "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "OFF"};
+    static constexpr std::array<std::string_view, 4> kSyncModes{"OFF", "NORMAL", "FULL", "EXTRA"};
+    const std::string journal_mode =
+        pick(config.sqlite_journal_mode, kJournalModes, "WAL", "DATA_LOGGER_SQLITE_JOURNAL_MODE");
+    const std::string synchronous =
+        pick(config.sqlite_synchronous, kSyncModes, "NORMAL", "DATA_LOGGER_SQLITE_SYNCHRONOUS");
+    const std::string pragmas = "PRAGMA journal_mode=" + journal_mode + ";" +
+                                "PRAGMA synchronous=" + synchronous + ";" +
+                                "PRAGMA cache_size=" + std::to_string(config.sqlite_cache_size) + ";";
+    exec(pragmas.c_str(), "configure database pragmas");
+
+    const int version = user_version();
+    if (version > kSchemaVersion) {
+        throw std::runtime_error("Database schema version " + std::to_string(version) +
+                                 " is newer than this logger supports (" +
+                                 std::to_string(kSchemaVersion) + ")");
+    }
+
+    // Migrations run in order, each in its own transaction with the version bump.
+    if (version < 1) {
+        migrate(1, kFramesTableSql + legacy_column_sql(), "frames table");
+    }
+    if (version < 2) {
+        migrate(2, kFeaturesTableSql, "frame_features side table");
+    }
+    if (version < 3) {
+        migrate(3, kTimeIndexSql, "epoch timestamps and indexes");
+    }
+    if (version < 4) {
+        migrate(4, kDescriptorCodecSql, "descriptor compression column");
+    }
+    if (version < 5) {
+        migrate(5, kTracesTableSql, "frame_traces table");
+    }
+    if (version < 6) {
+        migrate(6, kStreamColumnSql, "stream_id column");
+    }
+    if (version < 7) {
+        migrate(7, kSubsecondTimesSql, "sub-second legacy timestamps");
+    }
+}
+
+int FrameDatabase::user_version() {
+    int version = 0;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db_, "PRAGMA user_version;", -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        version = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return version;
+}
+
+// Databases from before schema versioning may lack columns added since the first release.
+std::string FrameDatabase::legacy_column_sql() {
+    static constexpr std::array<std::pair<std::string_view, std::string_view>, 7> kAddedColumns{{
+        {"keypoints", "BLOB"},
+        {"image_segment", "INTEGER"},
+        {"image_offset", "INTEGER"},
+        {"image_length", "INTEGER"},
+        {"annotated_segment", "INTEGER"},
+        {"annotated_offset", "INTEGER"},
+        {"annotated_length", "INTEGER"},
+    }};
+    std::vector<std::string> existing;
+    sqlite3_stmt* info = nullptr;
+    if (sqlite3_prepare_v2(db_, "PRAGMA table_info(frames);", -1, &info, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(info) == SQLITE_ROW) {
+            if (const auto* name = reinterpret_cast<const char*>(sqlite3_column_text(info, 1))) {
+                existing.emplace_back(name);
+            }
+        }
+    }
+    sqlite3_finalize(info);
+
+    std::string sql;
+    if (existing.empty()) {
+        return sql;  // Fresh database: the CREATE TABLE already has every column
+    }
+    for (const auto& [name, type] : kAddedColumns) {
+        if (std::find(existing.begin(), existing.end(), name) == existing.end()) {
+            sql += "ALTER TABLE frames ADD COLUMN " + std::string(name) + " " + std::string(type) + ";";
+        }
+    }
+    return sql;
+}
+
+void FrameDatabase::migrate(int version, const std::string& sql, const char* what) {
+    exec("BEGIN;", "begin migration");
+    try {
+        exec(sql.c_str(), what);
+        const std::string bump = "PRAGMA user_version=" + std::to_string(version) + ";";
+        exec(bump.c_str(), "record schema version");
+        exec("COMMIT;", "commit migration");
+    } catch (...) {
+        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+        throw;
+    }
+    spdlog::info("Database schema migrated to version {} ({})", version, what);
+}
+
+bool FrameDatabase::insert(const FrameRow& row) {
+    if (sqlite3_get_autocommit(db_) != 0) {
+        exec("BEGIN;", "begin batch");
+        batch_started_ = std::chrono::steady_clock::now();
+    }
+
+    // Prepare SQLite statement for reuse before binding.
+    sqlite3_reset(insert_stmt_);
+    sqlite3_clear_bindings(insert_stmt_);
+
+    const FrameRecord& record = *row.record;
+    const std::string created_at = dist::common::now_iso8601();
+
+    // Bind all values in positional order (matches INSERT statement).
+    int bind_index = 1;
+    sqlite3_bind_int(insert_stmt_, bind_index++, record.frame_id);
+    sqlite3_bind_int(insert_stmt_, bind_index++, record.loop_iteration);
+    sqlite3_bind_text(insert_stmt_, bind_index++, record.source_timestamp.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(insert_stmt_, bind_index++, record.processed_timestamp.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(insert_stmt_, bind_index++, record.filename.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(insert_stmt_, bind_index++, record.layout.width);
+    sqlite3_bind_int(insert_stmt_, bind_index++, record.layout.height);
+    sqlite3_bind_int(insert_stmt_, bind_index++, record.channels);
+    sqlite3_bind_text(insert_stmt_, bind_index++, record.layout.encoding.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(insert_stmt_, bind_index++, static_cast<sqlite3_int64>(record.keypoint_count));
+    sqlite3_bind_int(insert_stmt_, bind_index++, record.descriptor_rows);
+    sqlite3_bind_int(insert_stmt_, bind_index++, record.descriptor_cols);
+    sqlite3_bind_int(insert_stmt_, bind_index++, record.descriptor_elem_size);
+    sqlite3_bind_int(insert_stmt_, bind_index++, record.descriptor_type);
+    sqlite3_bind_int(insert_stmt_, bind_index++, static_cast<int>(row.descriptors_size));
+    if (row.image_path.empty()) {
+        sqlite3_bind_null(insert_stmt_, bind_index++);
+    } else {
+        sqlite3_bind_text(insert_stmt_, bind_index++, row.image_path.c_str(), -1, SQLITE_TRANSIENT);
+    }
+    sqlite3_bind_text(insert_stmt_, bind_index++, row.metadata_json.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(insert_stmt_, bind_index++, created_at.c_str(), -1, SQLITE_TRANSIENT);
+
+    // Segment locations replace image_path in segment storage; NULL otherwise.
+    for (const auto* location : {&row.image_location, &row.annotated_location}) {
+        if (location->has_value()) {
+            sqlite3_bind_int64(insert_stmt_, bind_index++, (*location)->segment_id);
+            sqlite3_bind_int64(insert_stmt_, bind_index++, static_cast<sqlite3_int64>((*location)->offset));
+            sqlite3_bind_int64(insert_stmt_, bind_index++, static_cast<sqlite3_int64>((*location)->length));
+        } else {
+            sqlite3_bind_null(insert_stmt_, bind_index++);
+            sqlite3_bind_null(insert_stmt_, bind_index++);
+            sqlite3_bind_null(insert_stmt_, bind_index++);
+        }
+    }
+
+    // Integer epoch copies of the timestamps back the range-query index.
+    bind_time(insert_stmt_, bind_index++, record.source_timestamp);
+    bind_time(insert_stmt_, bind_index++, record.processed_timestamp);
+    sqlite3_bind_text(
+        insert_stmt_, bind_index++, record.descriptor_compression.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(insert_stmt_, bind_index++, record.stream_id.c_str(), -1, SQLITE_TRANSIENT);
+
+    // A failed step only rolls back this statement; the rest of the batch survives.
+    bool ok = sqlite3_step(insert_stmt_) == SQLITE_DONE;
+    const sqlite3_int64 row_id = ok ? sqlite3_last_insert_rowid(db_) : 0;
+    if (!ok) {
+        spdlog::error("Failed to insert frame {}: {}", record.frame_id, sqlite3_errmsg(db_));
+    } else if (row.keypoints_size > 0 || row.descriptors_size > 0) {
+        // Packed keypoints and descriptors go to the side table, keyed by the new row id.
+        sqlite3_reset(features_stmt_);
+        sqlite3_clear_bindings(features_stmt_);
+        sqlite3_bind_int64(features_stmt_, 1, row_id);
+        bind_blob(features_stmt_, 2, row.keypoints, row.keypoints_size);
+        bind_blob(features_stmt_, 3, row.descriptors, row.descriptors_size);
+        ok = sqlite3_step(features_stmt_) == SQLITE_DONE;
+        if (!ok) {
+            spdlog::error("Failed to insert features for frame {}: {}",
+                          record.frame_id,
+                          sqlite3_errmsg(db_));
+            // Keep the tables consistent: a frame is stored with its features or not at all.
+            const std::string undo = "DELETE FROM frames WHERE id = " + std::to_string(row_id) + ";";
+            sqlite3_exec(db_, undo.c_str(), nullptr, nullptr, nullptr);
+        }
+    }
+    if (ok && !record.trace.empty()) {
+        // Latency is diagnostic; a failed trace row never costs the frame itself.
+        dist::common::FrameTrace trace = record.trace;
+        trace.mark(TraceStage::persist);
+        insert_trace(row_id, trace, record.frame_id);
+    }
+    if (ok) {
+        ++pending_rows_;
+    }
+
+    if (pending_rows_ >= batch_size_) {
+        flush();
+    } else {
+        maybe_flush();
+    }
+    return ok;
+}
+
+void FrameDatabase::insert_trace(sqlite3_int64 row_id,
+                                 const dist::common::FrameTrace& trace,
+                                 int frame_id) {
+    sqlite3_reset(traces_stmt_);
+    sqlite3_clear_bindings(traces_stmt_);
+    int bind_index = 1;
+    sqlite3_bind_int64(traces_stmt_, bind_index++, row_id);
+    if (const auto read_ns = trace.at(TraceStage::read); read_ns != 0) {
+        sqlite3_bind_int64(traces_stmt_, bind_index++, read_ns);
+    } else {
+        sqlite3_bind_null(traces_stmt_, bind_index++);
+    }
+    for (const auto& [name, from, to] : dist::common::kTraceSpans) {
+        if (const auto span = trace.between(from, to)) {
+            sqlite3_bind_int64(traces_stmt_, bind_index++, *span);
+        } else {
+            sqlite3_bind_null(traces_stmt_, bind_index++);
+        }
+    }
+    if (sqlite3_step(traces_stmt_) != SQLITE_DONE) {
+        spdlog::warn("Failed to insert trace for frame {}: {}", frame_id, sqlite3_errmsg(db_));
+    }
+}
+
+void FrameDatabase::maybe_flush() {
+    if (sqlite3_get_autocommit(db_) == 0 &&
+        std::chrono::steady_clock::now() - batch_started_ >= flush_interval_) {
+        flush();
+    }
+}
+
+void FrameDatabase::flush() {
+    if (sqlite3_get_autocommit(db_) != 0) {
+        pending_rows_ = 0;
+        return;  // No open transaction
+    }
+    static auto& commit_seconds =
+        dist::common::metrics().histogram("dist_logger_sqlite_commit_seconds",
+                                          "Batch COMMIT latency",
+                                          dist::common::latency_buckets());
+    static auto& batch_rows =
+        dist::common::metrics().histogram("dist_logger_sqlite_batch_rows",
+                                          "Rows per committed batch",
+                                          {1, 2, 4, 8, 16, 32, 64, 128, 256, 1024});
+    const auto commit_start = std::chrono::steady_clock::now();
+    exec("COMMIT;", "commit batch");
+    commit_seconds.observe(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - commit_start).count());
+    batch_rows.observe(static_cast<double>(pending_rows_));
+    spdlog::debug("Committed {} frames", pending_rows_);
+    pending_rows_ = 0;
+}
+
+}  // namespace dist::data_logger
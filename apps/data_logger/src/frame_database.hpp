@@ -0,0 +1,70 @@
+#pragma once
+
+#include <sqlite3.h>
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "dist/common/config.hpp"
+#include "dist/common/segment_store.hpp"
+#include "frame_record.hpp"
+
+namespace dist::data_logger {
+
+// One frames-table row. Blob pointers only need to stay valid until insert() returns.
+struct FrameRow {
+    const FrameRecord* record = nullptr;
+    std::string image_path;  // Empty (NULL) when the payload lives in a segment
+    std::optional<dist::common::SegmentLocation> image_location;
+    std::optional<dist::common::SegmentLocation> annotated_location;
+    std::string metadata_json;
+    const void* descriptors = nullptr;
+    std::size_t descriptors_size = 0;
+    const void* keypoints = nullptr;  // Packed keypoints
+    std::size_t keypoints_size = 0;
+};
+
+// Owns the SQLite connection and groups inserts into transactions that commit
+// after `batch_size` rows or `flush_interval`, whichever comes first, so the
+// per-commit fsync is paid once per batch instead of once per frame. The schema is
+// versioned through PRAGMA user_version and migrated forward on open.
+class FrameDatabase {
+  public:
+    // Opens (creating if needed) the database; throws std::runtime_error on failure.
+    explicit FrameDatabase(const dist::common::DataLoggerConfig& config);
+    ~FrameDatabase();
+
+    FrameDatabase(const FrameDatabase&) = delete;
+    FrameDatabase& operator=(const FrameDatabase&) = delete;
+
+    // Append a row to the open batch; commits when the batch is full.
+    bool insert(const FrameRow& row);
+
+    // Commit the current batch if its time window has elapsed (call when idle too).
+    void maybe_flush();
+    void flush();
+
+    [[nodiscard]] std::size_t pending_rows() const { return pending_rows_; }
+
+  private:
+    void exec(const char* sql, const char* what);
+    void ensure_schema(const dist::common::DataLoggerConfig& config);
+    void migrate(int version, const std::string& sql, const char* what);
+    int user_version();
+    std::string legacy_column_sql();
+    void insert_trace(sqlite3_int64 row_id, const dist::common::FrameTrace& trace, int frame_id);
+
+    sqlite3* db_ = nullptr;
+    sqlite3_stmt* insert_stmt_ = nullptr;
+    sqlite3_stmt* features_stmt_ = nullptr;  // frame_features side table
+    sqlite3_stmt* traces_stmt_ = nullptr;    // frame_traces latency table
+    std::size_t batch_size_ = 1;
+    std::chrono::milliseconds flush_interval_{0};
+    std::size_t pending_rows_ = 0;
+    std::chrono::steady_clock::time_point batch_started_{};
+};
+
+}  // namespace dist::data_logger
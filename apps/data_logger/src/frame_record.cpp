@@ -0,0 +1,105 @@
+#include "frame_record.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <iterator>
+
+#include "dist/common/utils.hpp"
+#include "dist/common/wire_format.hpp"
+
+namespace dist::data_logger {
+
+namespace wire = dist::common::wire;
+
+std::optional<FrameRecord> record_from_json(std::string_view text) {
+    FrameRecord record;
+    try {
+        record.metadata = nlohmann::json::parse(text);
+    } catch (const std::exception& ex) {
+        spdlog::warn("Failed to parse metadata JSON: {}", ex.what());
+        return std::nullopt;
+    }
+
+    const auto& header = record.metadata;
+    const auto source = header.value("source", nlohmann::json::object());
+    record.frame_id = source.value("frame_id", -1);
+    record.loop_iteration = source.value("loop_iteration", 0);
+    record.source_timestamp = source.value("timestamp", "");
+    record.processed_timestamp = header.value("processed_timestamp", dist::common::now_iso8601());
+    record.filename = source.value("filename", record.filename);
+    record.channels = source.value("channels", 0);
+    record.layout = dist::features::layout_from_header(source);
+    record.keypoint_count = header.value<std::size_t>("keypoint_count", 0);
+    record.descriptor_rows = header.value("descriptor_rows", 0);
+    record.descriptor_cols = header.value("descriptor_cols", 0);
+    record.descriptor_elem_size = header.value("descriptor_elem_size", 0);
+    record.descriptor_type = header.value("descriptor_type", 0);
+    record.descriptor_compression = header.value("descriptor_compression", record.descriptor_compression);
+    record.annotate = header.value("annotate", false);
+    // The stamps go to frame_traces; keep them out of metadata_json.
+    record.trace = dist::common::trace_from_json(header.value("trace", nlohmann::json{}));
+    record.metadata.erase("trace");
+    if (auto it = record.metadata.find("source"); it != record.metadata.end() && it->is_object()) {
+        it->erase("trace");
+    }
+    return record;
+}
+
+std::optional<FrameRecord> record_from_binary(const void* data, std::size_t size) {
+    const auto header = wire::read_frame_header(data, size);
+    if (!header) {
+        spdlog::warn("Discarding binary header ({} bytes) with unexpected layout", size);
+        return std::nullopt;
+    }
+
+    FrameRecord record;
+    record.frame_id = static_cast<int>(header->frame_id);
+    record.loop_iteration = static_cast<int>(header->loop_iteration);
+    record.source_timestamp = wire::get_field(header->source_timestamp);
+    record.processed_timestamp = wire::get_field(header->processed_timestamp);
+    if (record.processed_timestamp.empty()) {
+        record.processed_timestamp = dist::common::now_iso8601();
+    }
+    if (const auto filename = wire::get_field(header->filename); !filename.empty()) {
+        record.filename = filename;
+    }
+    record.channels = header->channels;
+    record.layout.encoding = wire::get_field(header->encoding);
+    record.layout.width = header->width;
+    record.layout.height = header->height;
+    record.layout.cv_type = header->cv_type;
+    record.layout.step = static_cast<std::size_t>(header->step);
+    record.layout.compression = wire::get_field(header->compression);
+    record.keypoint_count = static_cast<std::size_t>(header->keypoint_count);
+    record.descriptor_rows = header->descriptor_rows;
+    record.descriptor_cols = header->descriptor_cols;
+    record.descriptor_elem_size = header->descriptor_elem_size;
+    record.descriptor_type = header->descriptor_type;
+    if (const auto codec = wire::get_field(header->descriptor_compression); !codec.empty()) {
+        record.descriptor_compression = codec;
+    }
+    record.annotate = (header->flags & wire::kFlagAnnotate) != 0;
+    std::copy(std::begin(header->trace_ns), std::end(header->trace_ns), record.trace.ns.begin());
+
+    record.metadata = {
+        {"header_format", "binary"},
+        {"raw_bytes", header->raw_bytes},
+        {"image_bytes", header->image_bytes},
+        {"descriptors_bytes", header->descriptors_bytes},
+        {"descriptors_raw_bytes", header->descriptors_raw_bytes},
+        {"detector", wire::get_field(header->detector)},
+        {"annotated_bytes", header->annotated_bytes},
+    };
+    if ((header->flags & wire::kFlagReused) != 0) {
+        record.metadata["reused"] = true;
+    }
+    if (record.layout.encoding == "raw") {
+        record.metadata["cv_type"] = record.layout.cv_type;
+        record.metadata["step"] = record.layout.step;
+        record.metadata["compression"] = record.layout.compression;
+    }
+    return record;
+}
+
+}  // namespace dist::data_logger
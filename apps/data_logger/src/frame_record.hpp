@@ -0,0 +1,44 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "dist/common/stream.hpp"
+#include "dist/common/trace.hpp"
+#include "dist/features/frame_decode.hpp"
+
+namespace dist::data_logger {
+
+// Everything the logger persists about a frame, filled from either header format.
+struct FrameRecord {
+    std::string stream_id{dist::common::kDefaultStream};  // From the message topic
+    int frame_id = -1;
+    int loop_iteration = 0;
+    std::string source_timestamp;
+    std::string processed_timestamp;
+    std::string filename = "frame.png";
+    int channels = 0;
+    dist::features::FrameLayout layout;
+    std::size_t keypoint_count = 0;
+    int descriptor_rows = 0;
+    int descriptor_cols = 0;
+    int descriptor_elem_size = 0;
+    int descriptor_type = 0;
+    std::string descriptor_compression = "none";  // Descriptor blob codec (stored as-is)
+    bool annotate = false;     // Extractor deferred the overlay to us
+    dist::common::FrameTrace trace;  // Stored as per-stage durations in frame_traces
+    nlohmann::json metadata;  // Stored verbatim as metadata_json
+};
+
+// Parse the JSON debug header; nullopt if it is not valid JSON.
+[[nodiscard]] std::optional<FrameRecord> record_from_json(std::string_view text);
+
+// Read a binary FrameHeader in place; nullopt on size/magic/version mismatch.
+// Metadata keeps only the scalar fields, so no keypoint JSON is ever built.
+[[nodiscard]] std::optional<FrameRecord> record_from_binary(const void* data, std::size_t size);
+
+}  // namespace dist::data_logger
@@ -0,0 +1,280 @@
+#include "logger_pipeline.hpp"
+
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#include "dist/common/image_encoding.hpp"
+#include "dist/features/annotation.hpp"
+#include "dist/features/frame_decode.hpp"
+#include "dist/features/keypoints.hpp"
+
+namespace dist::data_logger {
+
+namespace {
+
+constexpr std::size_t kDefaultQueueDepth = 256;
+constexpr auto kIdleFlushPoll = std::chrono::milliseconds(100);
+
+// Keep filenames filesystem-friendly (avoid spaces or exotic characters).
+std::string sanitize_filename(std::string value) {
+    for (char& ch : value) {
+        if (!(std::isalnum(static_cast<unsigned char>(ch)) || ch == '-' || ch == '_' ||
+              ch == '.')) {
+            ch = '_';
+        }
+    }
+    return value;
+}
+
+std::unique_ptr<dist::common::SegmentWriter> make_segment_writer(
+    const dist::common::DataLoggerConfig& config) {
+    if (config.storage == "files") {
+        return nullptr;
+    }
+    if (config.storage != "segments") {
+        spdlog::warn("DATA_LOGGER_STORAGE={} is invalid; using files", config.storage);
+        return nullptr;
+    }
+    const auto max_bytes = static_cast<std::uint64_t>(std::max(config.segment_max_mb, 1)) * 1024 * 1024;
+    return std::make_unique<dist::common::SegmentWriter>(config.segment_dir, max_bytes);
+}
+
+std::size_t queue_depth(int configured) {
+    if (configured > 0) {
+        return static_cast<std::size_t>(configured);
+    }
+    spdlog::warn("DATA_LOGGER_QUEUE_DEPTH={} is invalid; using default {}", configured, kDefaultQueueDepth);
+    return kDefaultQueueDepth;
+}
+
+}  // namespace
+
+LoggerPipeline::LoggerPipeline(const dist::common::DataLoggerConfig& config,
+                               std::unique_ptr<FrameDatabase> database)
+    : config_(config),
+      database_(std::move(database)),
+      file_queue_(queue_depth(config.queue_depth)),
+      db_queue_(file_queue_.capacity()),
+      segments_(make_segment_writer(config)),
+      write_batch_(static_cast<std::size_t>(std::max(config.write_batch, 1))) {
+    if (segments_) {
+        spdlog::info("Payload storage: segments under {} (segment {}, {} MB max{})",
+                     config.segment_dir.string(),
+                     segments_->current_segment(),
+                     config.segment_max_mb,
+                     config.fdatasync ? ", fdatasync" : "");
+    } else {
+        writer_ = make_payload_writer(config.payload_backend, config.fdatasync);
+        spdlog::info("Payload writer: {} ({} frames per batch{})",
+                     writer_->name(),
+                     write_batch_,
+                     config.fdatasync ? ", fdatasync" : "");
+    }
+    file_thread_ = std::thread([this] { run_file_writer(); });
+    db_thread_ = std::thread([this] { run_db_writer(); });
+}
+
+LoggerPipeline::~LoggerPipeline() {
+    stop();
+}
+
+bool LoggerPipeline::submit(LoggedFrame&& frame) {
+    received_.fetch_add(1);
+    if (!file_queue_.try_push(frame)) {
+        dropped_.fetch_add(1);
+        return false;
+    }
+    return true;
+}
+
+void LoggerPipeline::stop() {
+    // Closing drains: each stage finishes what is queued before its pop returns nullopt.
+    file_queue_.close();
+    if (file_thread_.joinable()) {
+        file_thread_.join();
+    }
+    db_queue_.close();
+    if (db_thread_.joinable()) {
+        db_thread_.join();
+    }
+    database_.reset();  // Commits the final partial batch
+}
+
+PipelineStats LoggerPipeline::stats() const {
+    PipelineStats stats;
+    stats.received = received_.load();
+    stats.dropped = dropped_.load();
+    stats.stored = stored_.load();
+    stats.failed = failed_.load();
+    stats.file_queue_depth = file_queue_.size();
+    stats.db_queue_depth = db_queue_.size();
+    return stats;
+}
+
+void LoggerPipeline::run_file_writer() {
+    std::vector<LoggedFrame> batch;
+    batch.reserve(write_batch_);
+    while (auto first = file_queue_.pop()) {
+        // Take whatever else is already queued so the backend completes it in one go.
+        batch.clear();
+        batch.push_back(std::move(*first));
+        while (batch.size() < write_batch_) {
+            auto more = file_queue_.try_pop();
+            if (!more) {
+                break;
+            }
+            batch.push_back(std::move(*more));
+        }
+
+        for (auto& frame : batch) {
+            stage_files(frame);
+        }
+        // Segment appends are already complete; only the optional sync is batched.
+        const bool synced = !segments_ || !config_.fdatasync || segments_->sync();
+        const std::vector<bool>* results = segments_ ? nullptr : &writer_->flush();
+
+        for (auto& frame : batch) {
+            const bool stored =
+                results != nullptr ? (*results)[frame.image_slot] : synced && frame.image_location;
+            if (!stored) {
+                failed_.fetch_add(1);
+                continue;
+            }
+            if (results != nullptr && frame.annotated_slot != LoggedFrame::kNoSlot &&
+                (*results)[frame.annotated_slot]) {
+                frame.record.metadata["annotated_path"] = std::move(frame.annotated_path);
+            }
+            // The DB stage only needs the payload bytes it stores; free the rest early.
+            frame.image = zmq::message_t{};
+            frame.annotated = zmq::message_t{};
+            frame.rendered = {};
+            // Blocking here pushes a slow database back onto the file queue.
+            db_queue_.push(std::move(frame));
+        }
+    }
+}
+
+void LoggerPipeline::stage_files(LoggedFrame& frame) {
+    auto& record = frame.record;
+    const int frame_id = record.frame_id;
+    frame.image_bytes = frame.image.size();
+
+    // Overlays the extractor deferred are drawn here, off the detection path.
+    if (!frame.has_annotated && config_.render_annotations && record.annotate) {
+        const cv::Mat decoded = dist::features::decode_frame(record.layout, frame.image);
+        const auto keypoints =
+            dist::features::unpack_keypoints(frame.keypoints.data(), frame.keypoints.size());
+        frame.rendered = dist::features::render_annotation(decoded, keypoints);
+        if (frame.rendered.empty()) {
+            spdlog::warn("Failed to render annotation for frame {}", frame_id);
+        }
+    }
+    const void* annotated_data = frame.has_annotated ? frame.annotated.data() : frame.rendered.data();
+    const std::size_t annotated_size =
+        frame.has_annotated ? frame.annotated.size() : frame.rendered.size();
+
+    if (segments_) {
+        stage_segments(frame, annotated_data, annotated_size);
+        return;
+    }
+
+    // Persist file names with monotonically increasing prefix; the extension follows the
+    // payload's encoding since pass-through sources keep their original codec. Frame ids
+    // count per stream, so non-default streams prefix their id.
+    const auto stamp = sanitize_filename(record.processed_timestamp);
+    const auto& compression = record.layout.compression;
+    const auto prefix = record.stream_id == dist::common::kDefaultStream
+                            ? std::string("frame")
+                            : record.stream_id + "_frame";
+    auto image_path =
+        config_.raw_image_dir /
+        fmt::format("{}_{:06}_{}{}{}",
+                    prefix,
+                    std::max(frame_id, 0),
+                    stamp,
+                    dist::common::extension_for_encoding(record.layout.encoding),
+                    compression == "none" ? "" : "." + compression);
+
+    // Persist the raw payload to disk so downstream inspection is trivial.
+    frame.image_path = image_path.string();
+    frame.image_slot = writer_->write(std::move(image_path), frame.image.data(), frame.image.size());
+
+    if (annotated_size > 0) {
+        // Annotated frames mirror the raw naming convention with suffix.
+        auto annotated_path =
+            config_.annotated_image_dir /
+            fmt::format("{}_{:06}_{}_annotated.png", prefix, std::max(frame_id, 0), stamp);
+        frame.annotated_path = annotated_path.string();
+        frame.annotated_slot = writer_->write(std::move(annotated_path), annotated_data, annotated_size);
+    }
+}
+
+void LoggerPipeline::stage_segments(LoggedFrame& frame,
+                                    const void* annotated_data,
+                                    std::size_t annotated_size) {
+    const std::int64_t frame_id = frame.record.frame_id;
+    frame.image_location = segments_->append(
+        frame_id, dist::common::SegmentRecordKind::raw, frame.image.data(), frame.image.size());
+    if (frame.image_location && annotated_size > 0) {
+        frame.annotated_location = segments_->append(
+            frame_id, dist::common::SegmentRecordKind::annotated, annotated_data, annotated_size);
+    }
+}
+
+void LoggerPipeline::run_db_writer() {
+    while (true) {
+        auto frame = db_queue_.pop_for(kIdleFlushPoll);
+        if (!frame) {
+            if (db_queue_.closed() && db_queue_.size() == 0) {
+                break;
+            }
+            // Idle: do not hold a partial batch open past its window.
+            try {
+                database_->maybe_flush();
+            } catch (const std::exception& ex) {
+                spdlog::error("{}", ex.what());
+            }
+            continue;
+        }
+
+        FrameRow row;
+        row.record = &frame->record;
+        row.image_path = frame->image_path;
+        row.image_location = frame->image_location;
+        row.annotated_location = frame->annotated_location;
+        row.metadata_json = frame->record.metadata.dump();
+        row.descriptors = frame->descriptors.data();
+        row.descriptors_size = frame->descriptors.size();
+        row.keypoints = frame->keypoints.data();
+        row.keypoints_size = frame->keypoints.size();
+        try {
+            if (!database_->insert(row)) {
+                failed_.fetch_add(1);
+                continue;
+            }
+        } catch (const std::exception& ex) {
+            spdlog::error("{}", ex.what());
+            failed_.fetch_add(1);
+            continue;
+        }
+        stored_.fetch_add(1);
+        if (on_stored_) {
+            frame->record.trace.mark(dist::common::TraceStage::persist);
+            on_stored_(frame->record);
+        }
+
+        spdlog::debug("Stored frame {} ({} keypoints, {} bytes)",
+                     frame->record.frame_id,
+                     frame->record.keypoint_count,
+                     frame->image_bytes);
+    }
+}
+
+}  // namespace dist::data_logger
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <zmq.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "dist/common/bounded_queue.hpp"
+#include "dist/common/config.hpp"
+#include "dist/common/segment_store.hpp"
+#include "frame_database.hpp"
+#include "frame_record.hpp"
+#include "payload_writer.hpp"
+
+namespace dist::data_logger {
+
+// A received frame on its way through the file and database stages.
+struct LoggedFrame {
+    static constexpr std::size_t kNoSlot = static_cast<std::size_t>(-1);
+
+    FrameRecord record;
+    zmq::message_t keypoints;  // Packed keypoints (binary headers only)
+    zmq::message_t descriptors;
+    zmq::message_t image;
+    zmq::message_t annotated;
+    bool has_annotated = false;
+    std::string image_path;  // Filled in by the file stage (files storage)
+    std::size_t image_bytes = 0;
+    // Filled in by the file stage (segments storage).
+    std::optional<dist::common::SegmentLocation> image_location;
+    std::optional<dist::common::SegmentLocation> annotated_location;
+    // File-stage scratch: payload writer slots, and a logger-rendered overlay that
+    // must outlive the batch flush.
+    std::size_t image_slot = kNoSlot;
+    std::size_t annotated_slot = kNoSlot;
+    std::string annotated_path;
+    std::vector<std::uint8_t> rendered;
+};
+
+// Counters sampled by the receiver for periodic stats logging.
+struct PipelineStats {
+    std::uint64_t received = 0;
+    std::uint64_t dropped = 0;  // File queue full when the frame arrived
+    std::uint64_t stored = 0;
+    std::uint64_t failed = 0;   // File or insert errors
+    std::size_t file_queue_depth = 0;
+    std::size_t db_queue_depth = 0;
+};
+
+// Receiver -> [file queue] -> file writer -> [db queue] -> DB writer. submit() never
+// blocks, so a stalled disk fills the bounded queue (and is counted) instead of
+// backing up into the socket, where ZeroMQ would drop frames silently.
+class LoggerPipeline {
+  public:
+    // Throws std::runtime_error when segment storage cannot be opened.
+    LoggerPipeline(const dist::common::DataLoggerConfig& config,
+                   std::unique_ptr<FrameDatabase> database);
+    ~LoggerPipeline();
+
+    LoggerPipeline(const LoggerPipeline&) = delete;
+    LoggerPipeline& operator=(const LoggerPipeline&) = delete;
+
+    // Called on the database thread after each row insert, with the trace's persist
+    // stamp set (e.g. a --bench report). Set before the first submit().
+    void on_stored(std::function<void(const FrameRecord&)> callback) {
+        on_stored_ = std::move(callback);
+    }
+
+    // Hand a frame to the file stage; false (and counted as dropped) when it is full.
+    bool submit(LoggedFrame&& frame);
+
+    // Drain both stages, commit the last batch and join the threads.
+    void stop();
+
+    [[nodiscard]] PipelineStats stats() const;
+
+  private:
+    void run_file_writer();
+    void run_db_writer();
+    void stage_files(LoggedFrame& frame);
+    void stage_segments(LoggedFrame& frame, const void* annotated_data, std::size_t annotated_size);
+
+    const dist::common::DataLoggerConfig config_;
+    std::unique_ptr<FrameDatabase> database_;
+    dist::common::BoundedQueue<LoggedFrame> file_queue_;
+    dist::common::BoundedQueue<LoggedFrame> db_queue_;
+    std::unique_ptr<PayloadWriter> writer_;  // File thread only ("files" storage)
+    std::unique_ptr<dist::common::SegmentWriter> segments_;  // File thread only ("segments")
+    std::size_t write_batch_;
+    std::thread file_thread_;
+    std::thread db_thread_;
+
+    std::atomic<std::uint64_t> received_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> stored_{0};
+    std::atomic<std::uint64_t> failed_{0};
+    std::function<void(const FrameRecord&)> on_stored_;
+};
+
+}  // namespace dist::data_logger
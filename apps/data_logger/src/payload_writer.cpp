@@ -0,0 +1,245 @@
+#include "payload_writer.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#if defined(DIST_HAVE_LIBURING)
+#include <liburing.h>
+#endif
+
+namespace dist::data_logger {
+
+namespace {
+
+struct PendingWrite {
+    std::filesystem::path path;
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+    int fd = -1;
+    bool ok = false;
+};
+
+int open_for_write(const std::filesystem::path& path) {
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        spdlog::error("Failed to open {} for writing: {}", path.string(), std::strerror(errno));
+    }
+    return fd;
+}
+
+// Finish a write from `offset`, retrying short writes and EINTR.
+bool write_all(int fd, const std::uint8_t* data, std::size_t size, std::size_t offset) {
+    while (offset < size) {
+        const ssize_t written =
+            ::pwrite(fd, data + offset, size - offset, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        offset += static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+// Shared batch bookkeeping; backends only differ in how a batch is completed.
+class BatchedWriter : public PayloadWriter {
+  public:
+    explicit BatchedWriter(bool fdatasync) : fdatasync_(fdatasync) {}
+
+    std::size_t write(std::filesystem::path path, const void* data, std::size_t size) override {
+        if (!results_.empty()) {
+            results_.clear();  // First write after a flush starts a new batch
+        }
+        PendingWrite pending;
+        pending.path = std::move(path);
+        pending.data = static_cast<const std::uint8_t*>(data);
+        pending.size = size;
+        pending.fd = open_for_write(pending.path);
+        pending_.push_back(std::move(pending));
+        return pending_.size() - 1;
+    }
+
+    const std::vector<bool>& flush() override {
+        complete(pending_);
+        results_.assign(pending_.size(), false);
+        for (std::size_t i = 0; i < pending_.size(); ++i) {
+            auto& pending = pending_[i];
+            if (pending.fd >= 0 && ::close(pending.fd) != 0) {
+                pending.ok = false;
+            }
+            if (pending.fd >= 0 && !pending.ok) {
+                spdlog::error("Failed to write {}", pending.path.string());
+            }
+            results_[i] = pending.ok;
+        }
+        pending_.clear();
+        return results_;
+    }
+
+  protected:
+    // Write (and optionally fdatasync) every entry with fd >= 0, setting `ok`.
+    virtual void complete(std::vector<PendingWrite>& batch) = 0;
+
+    bool fdatasync_;
+
+  private:
+    std::vector<PendingWrite> pending_;
+    std::vector<bool> results_;
+};
+
+// The previous behaviour: one blocking syscall chain per file.
+class PosixPayloadWriter final : public BatchedWriter {
+  public:
+    using BatchedWriter::BatchedWriter;
+
+    [[nodiscard]] std::string_view name() const override { return "posix"; }
+
+  protected:
+    void complete(std::vector<PendingWrite>& batch) override {
+        for (auto& pending : batch) {
+            if (pending.fd >= 0) {
+                pending.ok = write_all(pending.fd, pending.data, pending.size, 0);
+            }
+        }
+        if (!fdatasync_) {
+            return;
+        }
+        // Syncing after all writes lets the device merge the batch.
+        for (auto& pending : batch) {
+            if (pending.ok && ::fdatasync(pending.fd) != 0) {
+                pending.ok = false;
+            }
+        }
+    }
+};
+
+#if defined(DIST_HAVE_LIBURING)
+constexpr unsigned kRingEntries = 64;
+
+// Queues every write of the batch on one ring and reaps completions together,
+// then (optionally) does the same for IORING_FSYNC_DATASYNC.
+class UringPayloadWriter final : public BatchedWriter {
+  public:
+    explicit UringPayloadWriter(bool fdatasync) : BatchedWriter(fdatasync) {
+        init_error_ = -io_uring_queue_init(kRingEntries, &ring_, 0);
+    }
+    ~UringPayloadWriter() override {
+        if (init_error_ == 0) {
+            io_uring_queue_exit(&ring_);
+        }
+    }
+
+    UringPayloadWriter(const UringPayloadWriter&) = delete;
+    UringPayloadWriter& operator=(const UringPayloadWriter&) = delete;
+
+    [[nodiscard]] std::string_view name() const override { return "io_uring"; }
+    // errno from io_uring_queue_init; non-zero when the kernel lacks io_uring.
+    [[nodiscard]] int init_error() const { return init_error_; }
+
+  protected:
+    void complete(std::vector<PendingWrite>& batch) override {
+        for (auto& pending : batch) {
+            pending.ok = pending.fd >= 0;
+        }
+        run(batch, false);
+        if (fdatasync_) {
+            run(batch, true);
+        }
+    }
+
+  private:
+    void run(std::vector<PendingWrite>& batch, bool sync) {
+        std::size_t next = 0;
+        std::size_t in_flight = 0;
+        while (next < batch.size() || in_flight > 0) {
+            // Fill the submission queue without exceeding what the completion queue can hold.
+            while (next < batch.size() && in_flight < kRingEntries) {
+                auto& pending = batch[next];
+                if (!pending.ok || (!sync && pending.size == 0)) {
+                    ++next;
+                    continue;
+                }
+                io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+                if (sqe == nullptr) {
+                    break;
+                }
+                if (sync) {
+                    io_uring_prep_fsync(sqe, pending.fd, IORING_FSYNC_DATASYNC);
+                } else {
+                    io_uring_prep_write(sqe, pending.fd, pending.data, static_cast<unsigned>(pending.size), 0);
+                }
+                io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(static_cast<std::uintptr_t>(next)));
+                ++next;
+                ++in_flight;
+            }
+            if (in_flight == 0) {
+                continue;
+            }
+
+            const int submitted = io_uring_submit_and_wait(&ring_, 1);
+            if (submitted < 0 && submitted != -EINTR) {
+                spdlog::error("io_uring submit failed: {}", std::strerror(-submitted));
+                for (auto& pending : batch) {
+                    pending.ok = false;
+                }
+                return;
+            }
+
+            io_uring_cqe* cqe = nullptr;
+            while (io_uring_peek_cqe(&ring_, &cqe) == 0) {
+                const auto index =
+                    static_cast<std::size_t>(reinterpret_cast<std::uintptr_t>(io_uring_cqe_get_data(cqe)));
+                auto& pending = batch[index];
+                const int res = cqe->res;
+                io_uring_cqe_seen(&ring_, cqe);
+                --in_flight;
+                if (res < 0) {
+                    pending.ok = false;
+                } else if (!sync && static_cast<std::size_t>(res) < pending.size) {
+                    // Rare for regular files; finish the tail synchronously.
+                    pending.ok = write_all(pending.fd, pending.data, pending.size, static_cast<std::size_t>(res));
+                }
+            }
+        }
+    }
+
+    io_uring ring_{};
+    int init_error_ = 0;
+};
+#endif
+
+}  // namespace
+
+std::unique_ptr<PayloadWriter> make_payload_writer(std::string_view backend, bool fdatasync) {
+    if (backend != "auto" && backend != "posix" && backend != "io_uring") {
+        spdlog::warn("DATA_LOGGER_PAYLOAD_BACKEND={} is invalid; using auto", backend);
+        backend = "auto";
+    }
+#if defined(DIST_HAVE_LIBURING)
+    if (backend != "posix") {
+        auto writer = std::make_unique<UringPayloadWriter>(fdatasync);
+        if (writer->init_error() == 0) {
+            return writer;
+        }
+        spdlog::warn("io_uring unavailable ({}); falling back to posix writes",
+                     std::strerror(writer->init_error()));
+    }
+#else
+    if (backend == "io_uring") {
+        spdlog::warn("Built without liburing; falling back to posix writes");
+    }
+#endif
+    return std::make_unique<PosixPayloadWriter>(fdatasync);
+}
+
+}  // namespace dist::data_logger
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace dist::data_logger {
+
+// Storage backend for frame payload files. Writes are queued per batch and
+// completed together by flush(), which lets io_uring issue them as one
+// submission and lets fdatasync be paid once per batch instead of per file.
+class PayloadWriter {
+  public:
+    virtual ~PayloadWriter() = default;
+
+    // Queue a whole-file write and return its slot in the current batch.
+    // `data` must stay valid until flush() returns.
+    virtual std::size_t write(std::filesystem::path path, const void* data, std::size_t size) = 0;
+
+    // Complete every queued write; the result is indexed by slot and valid until the next write().
+    virtual const std::vector<bool>& flush() = 0;
+
+    [[nodiscard]] virtual std::string_view name() const = 0;
+};
+
+// "auto" picks io_uring when it was found at build time and the kernel supports
+// it, otherwise "posix" (blocking open/write/close per file).
+[[nodiscard]] std::unique_ptr<PayloadWriter> make_payload_writer(std::string_view backend,
+                                                                 bool fdatasync);
+
+}  // namespace dist::data_logger
@@ -0,0 +1,466 @@
+#include "dist/data_logger/stage.hpp"
+
+#include <CLI/CLI.hpp>
+#include <spdlog/spdlog.h>
+#include <zmq.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dist/common/bench_report.hpp"
+#include "dist/common/config.hpp"
+#include "dist/common/distribution.hpp"
+#include "dist/common/env_loader.hpp"
+#include "dist/common/metrics.hpp"
+#include "dist/common/reactor.hpp"
+#include "dist/common/shm_transport.hpp"
+#include "dist/common/stream.hpp"
+#include "dist/common/utils.hpp"
+#include "dist/common/version.hpp"
+#include "dist/common/wire_format.hpp"
+#include "dist/features/keypoints.hpp"
+#include "frame_database.hpp"
+#include "frame_record.hpp"
+#include "logger_pipeline.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::atomic_bool g_keep_running{true};
+constexpr int kZmqRetryAttempts = 3;
+constexpr std::size_t kMaxFrameParts = 6;  // Topic, binary header parts, annotated overlay
+constexpr auto kZmqRetryBackoff = std::chrono::seconds(1);
+constexpr std::size_t kMaxFramesPerWake = 64;
+constexpr auto kWaitLogInterval = std::chrono::seconds(5);
+constexpr auto kBenchIdleExit = std::chrono::seconds(3);  // --bench ends after this much silence
+
+// Make a best-effort attempt at connecting until upstream is ready.
+bool connect_with_retry(zmq::socket_t& socket, const std::string& endpoint) {
+    int attempt = 1;
+    while (g_keep_running.load()) {
+        try {
+            socket.connect(endpoint);
+            return true;
+        } catch (const zmq::error_t& ex) {
+            spdlog::warn("Failed to connect SUB socket to {} (attempt {}): {}. Waiting for feature "
+                         "extractor...",
+                         endpoint,
+                         attempt,
+                         ex.what());
+            ++attempt;
+            std::this_thread::sleep_for(kZmqRetryBackoff);
+        }
+    }
+    return false;
+}
+
+// PUSH/PULL fan-in: the logger owns the endpoint and every extractor connects to it.
+bool bind_with_retry(zmq::socket_t& socket, const std::string& endpoint) {
+    for (int attempt = 1; attempt <= kZmqRetryAttempts; ++attempt) {
+        try {
+            socket.bind(endpoint);
+            return true;
+        } catch (const zmq::error_t& ex) {
+            spdlog::error("Failed to bind PULL socket on {} (attempt {}/{}): {}. Another process "
+                          "might be using this endpoint.",
+                          endpoint,
+                          attempt,
+                          kZmqRetryAttempts,
+                          ex.what());
+            if (attempt == kZmqRetryAttempts) {
+                break;
+            }
+            std::this_thread::sleep_for(kZmqRetryBackoff);
+        }
+    }
+    return false;
+}
+
+// Swap shm:// descriptors for the payloads they reference; false if one was already reused.
+bool resolve_shm_parts(std::vector<zmq::message_t>& parts) {
+    for (auto& part : parts) {
+        auto mapped = dist::common::shm_reader().resolve(std::move(part));
+        if (!mapped) {
+            return false;
+        }
+        part = std::move(*mapped);
+    }
+    return true;
+}
+
+// Shared logic to honor CLI flags, env overrides, and repo defaults.
+fs::path resolve_env_path(const std::string& cli_env_path,
+                          const char* env_override,
+                          const fs::path& root) {
+    if (!cli_env_path.empty()) {
+        return cli_env_path;
+    }
+    if (env_override != nullptr) {
+        return env_override;
+    }
+    return root / ".env";
+}
+
+// Create directories declared in config so later file writes do not fail.
+bool ensure_output_directories(const dist::common::DataLoggerConfig& cfg) {
+    try {
+        std::filesystem::create_directories(cfg.raw_image_dir);
+        std::filesystem::create_directories(cfg.annotated_image_dir);
+        if (!cfg.db_path.parent_path().empty()) {
+            std::filesystem::create_directories(cfg.db_path.parent_path());
+        }
+        return true;
+    } catch (const std::exception& ex) {
+        spdlog::error("Failed to create storage directories: {}", ex.what());
+        return false;
+    }
+}
+
+}  // namespace
+
+namespace dist::data_logger {
+
+int run(int argc, char** argv, const dist::common::StageRuntime& runtime) {
+    // Provide a minimal CLI so local testing is ergonomic.
+    CLI::App app{"Data Logger - consumes processed frames and stores them"};
+    std::string cli_env_path;
+    std::string cli_log_level;
+    app.add_option("--env", cli_env_path, "Path to the .env file (overrides DIST_ENV_PATH)");
+    app.add_option("--log-level", cli_log_level,
+                   "Override log level (trace|debug|info|warn|error|critical)");
+    bool bench_mode = false;
+    app.add_flag("--bench",
+                 bench_mode,
+                 "Exit once input goes quiet and report fps, per-stage latency and drops");
+
+    CLI11_PARSE(app, argc, argv);
+
+    // Load configuration from .env (CLI override takes precedence).
+    dist::common::EnvLoader loader;
+    const auto root = fs::current_path();
+    const char* env_override = std::getenv("DIST_ENV_PATH");
+    fs::path env_path = resolve_env_path(cli_env_path, env_override, root);
+    if (!loader.load_from_file(env_path)) {
+        spdlog::warn("Failed to read environment file at {}. Falling back to process environment "
+                     "variables.",
+                     env_path.string());
+        if (!loader.load_from_env()) {
+            spdlog::error("No configuration could be loaded. Provide a .env file or pass variables "
+                          "via docker --env-file.");
+            return 1;
+        }
+    }
+
+    for (const auto& [key, value] : runtime.env_overrides) {
+        loader.set(key, value);
+    }
+    const auto config = dist::common::load_app_config(loader, root);
+    const auto resolved_level =
+        cli_log_level.empty() ? config.global.log_level : cli_log_level;
+    if (runtime.configure_process) {
+        spdlog::set_level(dist::common::level_from_string(resolved_level));
+        spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] %v");
+    }
+
+    if (runtime.handle_signals) {
+        dist::common::install_signal_handlers(g_keep_running);
+    }
+
+    if (!ensure_output_directories(config.logger)) {
+        return 1;
+    }
+
+    // Database bootstrap + schema creation; inserts are batched into transactions.
+    std::unique_ptr<dist::data_logger::FrameDatabase> database;
+    try {
+        database = std::make_unique<dist::data_logger::FrameDatabase>(config.logger);
+    } catch (const std::exception& ex) {
+        spdlog::error("{}", ex.what());
+        return 1;
+    }
+
+    auto distribution = dist::common::parse_distribution(config.logger.distribution);
+    if (!distribution) {
+        spdlog::warn("DATA_LOGGER_DISTRIBUTION={} is invalid; using pubsub",
+                     config.logger.distribution);
+        distribution = dist::common::Distribution::pubsub;
+    }
+    const bool push_pull = *distribution == dist::common::Distribution::pushpull;
+    const auto stream_filter =
+        dist::common::parse_stream_list(config.logger.streams, "DATA_LOGGER_STREAMS");
+    if (push_pull && !stream_filter.empty()) {
+        spdlog::warn("DATA_LOGGER_STREAMS is ignored with pushpull distribution; PULL sockets "
+                     "cannot filter by topic");
+    }
+
+    // Networking stack (SUB socket facing the extractor pipeline, or a bound PULL fan-in).
+    // Owned here unless the fused pipeline passes in its shared one.
+    std::optional<zmq::context_t> own_context;
+    zmq::context_t& context =
+        runtime.context != nullptr ? *runtime.context : own_context.emplace(1);
+    zmq::socket_t sink{context, dist::common::receiver_socket_type(*distribution)};
+    sink.set(zmq::sockopt::rcvhwm, 100);
+    sink.set(zmq::sockopt::linger, 0);
+    if (!push_pull) {
+        dist::common::subscribe_streams(sink, stream_filter);
+    }
+    const auto sink_endpoint = dist::common::zmq_endpoint(config.logger.sub_endpoint);
+    const bool sink_ready = push_pull ? bind_with_retry(sink, sink_endpoint)
+                                      : connect_with_retry(sink, sink_endpoint);
+    const bool shm_input = dist::common::is_shm_endpoint(config.logger.sub_endpoint);
+    if (!sink_ready) {
+        return 1;
+    }
+
+    spdlog::info("[data_logger] Dist Imaging Services v{}", dist::common::version());
+    spdlog::info("Listening for processed frames on {} ({})",
+                 config.logger.sub_endpoint,
+                 dist::common::to_string(*distribution));
+    spdlog::info("Streams: {}",
+                 stream_filter.empty() || push_pull ? "all" : config.logger.streams);
+    if (config.logger.storage == "segments") {
+        spdlog::info("Appending raw and annotated frames to segments in {}",
+                     config.logger.segment_dir.string());
+    } else {
+        spdlog::info("Saving raw frames to {}", config.logger.raw_image_dir.string());
+        spdlog::info("Saving annotated PNGs to {}", config.logger.annotated_image_dir.string());
+    }
+    spdlog::info("Persisting metadata to {} (batches of {}, {} ms window)",
+                 config.logger.db_path.string(),
+                 config.logger.batch_size,
+                 config.logger.flush_interval_ms);
+
+    // File and database writes run on their own threads; this thread only receives.
+    std::unique_ptr<dist::data_logger::LoggerPipeline> pipeline;
+    try {
+        pipeline = std::make_unique<dist::data_logger::LoggerPipeline>(config.logger, std::move(database));
+    } catch (const std::exception& ex) {
+        spdlog::error("{}", ex.what());
+        return 1;
+    }
+
+    const auto log_stats = [&] {
+        const auto stats = pipeline->stats();
+        spdlog::info("Logger stats: received={}, stored={}, dropped={}, failed={}, file_queue={}, "
+                     "db_queue={}",
+                     stats.received,
+                     stats.stored,
+                     stats.dropped,
+                     stats.failed,
+                     stats.file_queue_depth,
+                     stats.db_queue_depth);
+    };
+
+    // The pipeline already counts every stage; the scrape samples those counters.
+    auto& registry = dist::common::metrics();
+    const auto sample = [&pipeline](auto field) {
+        return [&pipeline, field] { return static_cast<double>(pipeline->stats().*field); };
+    };
+    using Stats = dist::data_logger::PipelineStats;
+    registry.counter_callback("dist_logger_frames_received_total",
+                              "Frames handed to the writer pipeline",
+                              sample(&Stats::received));
+    registry.counter_callback("dist_logger_frames_stored_total",
+                              "Frames whose row was inserted",
+                              sample(&Stats::stored));
+    registry.counter_callback("dist_logger_frames_dropped_total",
+                              "Frames dropped because the file queue was full",
+                              sample(&Stats::dropped));
+    registry.counter_callback("dist_logger_frames_failed_total",
+                              "Frames lost to file or insert errors",
+                              sample(&Stats::failed));
+    registry.gauge_callback("dist_logger_queue_frames",
+                            "Frames waiting for a writer stage",
+                            sample(&Stats::file_queue_depth),
+                            "stage=\"file\"");
+    registry.gauge_callback("dist_logger_queue_frames",
+                            "Frames waiting for a writer stage",
+                            sample(&Stats::db_queue_depth),
+                            "stage=\"db\"");
+    const dist::common::CallbackFreeze freeze_callbacks{"dist_logger_"};
+    dist::common::StreamGaps gaps{registry,
+                                  "dist_logger_input_gap_frames_total",
+                                  "Frame ids missing from a subscribed stream"};
+    constexpr const char* kPartBytes = "dist_logger_part_bytes";
+    constexpr const char* kPartHelp = "Size of each received message part";
+    auto& descriptors_bytes = registry.histogram(
+        kPartBytes, kPartHelp, dist::common::byte_buckets(), "part=\"descriptors\"");
+    auto& image_bytes =
+        registry.histogram(kPartBytes, kPartHelp, dist::common::byte_buckets(), "part=\"image\"");
+    auto& annotated_bytes = registry.histogram(
+        kPartBytes, kPartHelp, dist::common::byte_buckets(), "part=\"annotated\"");
+    // Stored frames carry every stamp from the generator's read to this row's insert.
+    dist::common::BenchReport bench;
+    if (bench_mode) {
+        pipeline->on_stored([&bench](const dist::data_logger::FrameRecord& record) {
+            bench.record(record.trace);
+        });
+    }
+    // Declared after the pipeline so it stops before the sampled object goes away.
+    dist::common::MetricsServer metrics_server{context, config.logger.metrics_endpoint, registry};
+    metrics_server.start();
+
+    // Receive, stats and the idle notice all run off one poll; nothing waits on a timeout.
+    dist::common::Reactor reactor;
+    auto last_frame = std::chrono::steady_clock::now();
+
+    // Every message leads with its stream topic, then
+    // Binary: [header][keypoints][descriptors][raw image][optional annotated image].
+    // JSON:   [header][descriptors][raw image][optional annotated image].
+    const auto handle_frame = [&](std::vector<zmq::message_t>& parts) {
+        spdlog::debug("Received {} parts from extractor", parts.size());
+        auto stream = dist::common::stream_from_topic(parts[0].to_string_view());
+        if (!stream || parts.size() < 2) {
+            spdlog::warn("Discarding message without a stream topic");
+            return;
+        }
+        parts.erase(parts.begin());
+
+        // The header format is self-identifying: binary headers start with a magic number.
+        const bool binary = dist::common::wire::is_frame_header(parts[0].data(), parts[0].size());
+        const std::size_t descriptors_index = binary ? 2 : 1;
+        if (parts.size() < descriptors_index + 2) {
+            spdlog::warn("Discarding message with {} parts (descriptors or image missing)",
+                         parts.size());
+            return;
+        }
+        auto record = binary ? dist::data_logger::record_from_binary(parts[0].data(), parts[0].size())
+                             : dist::data_logger::record_from_json(parts[0].to_string_view());
+        if (!record) {
+            return;
+        }
+
+        dist::data_logger::LoggedFrame frame;
+        frame.record = std::move(*record);
+        frame.record.stream_id = std::move(*stream);
+        frame.record.trace.mark(dist::common::TraceStage::logged);
+        std::size_t next = 1;
+        if (binary) {
+            frame.keypoints = std::move(parts[next++]);
+        } else if (auto it = frame.record.metadata.find("keypoints");
+                   it != frame.record.metadata.end()) {
+            // Pack inline JSON keypoints like binary ones so metadata_json stays small.
+            try {
+                const auto keypoints = dist::features::keypoints_from_json(*it);
+                frame.keypoints =
+                    zmq::message_t(keypoints.size() * sizeof(dist::common::wire::PackedKeypoint));
+                dist::features::pack_keypoints(keypoints, frame.keypoints.data());
+                frame.record.metadata.erase(it);
+            } catch (const nlohmann::json::exception& ex) {
+                spdlog::warn("Keeping malformed keypoints of frame {} inline: {}",
+                             frame.record.frame_id,
+                             ex.what());
+            }
+        }
+        frame.descriptors = std::move(parts[next++]);
+        frame.image = std::move(parts[next++]);
+        frame.has_annotated = next < parts.size();
+        if (frame.has_annotated) {
+            frame.annotated = std::move(parts[next]);
+            annotated_bytes.observe(static_cast<double>(frame.annotated.size()));
+        }
+        descriptors_bytes.observe(static_cast<double>(frame.descriptors.size()));
+        image_bytes.observe(static_cast<double>(frame.image.size()));
+        const int frame_id = frame.record.frame_id;
+        if (!push_pull) {
+            gaps.observe(frame.record.stream_id, frame_id);
+        }
+        const auto stream_id = frame.record.stream_id;
+        if (!pipeline->submit(std::move(frame))) {
+            spdlog::warn("Writer queue full; dropping {} frame {}", stream_id, frame_id);
+        }
+    };
+
+    // Drain what is queued on the socket, capped so timers still run under load.
+    const auto receive_frames = [&] {
+        for (std::size_t received = 0; received < kMaxFramesPerWake; ++received) {
+            std::vector<zmq::message_t> parts;
+            try {
+                zmq::message_t part;
+                if (!sink.recv(part, zmq::recv_flags::dontwait)) {
+                    return;  // Socket drained
+                }
+                bool more = part.more();
+                bool complete = true;
+                parts.push_back(std::move(part));
+                // The rest of a multipart message is delivered together with its first part.
+                while (more) {
+                    zmq::message_t next;
+                    if (!sink.recv(next, zmq::recv_flags::none)) {
+                        complete = false;
+                        break;
+                    }
+                    more = next.more();
+                    parts.push_back(std::move(next));
+                }
+                if (!complete || parts.size() > kMaxFrameParts) {
+                    spdlog::warn("Discarding incomplete or oversized multipart message ({} parts)",
+                                 parts.size());
+                    continue;
+                }
+                if (shm_input && !resolve_shm_parts(parts)) {
+                    spdlog::warn("Shared-memory payload was reused before it was read; dropping "
+                                 "frame");
+                    continue;
+                }
+            } catch (const zmq::error_t& ex) {
+                if (g_keep_running.load()) {
+                    spdlog::error("ZeroMQ receive error: {}", ex.what());
+                }
+                reactor.stop();
+                return;
+            }
+            last_frame = std::chrono::steady_clock::now();
+            handle_frame(parts);
+        }
+    };
+
+    reactor.add_socket(sink, ZMQ_POLLIN, receive_frames);
+    if (config.logger.stats_interval_ms > 0) {
+        reactor.add_timer(std::chrono::milliseconds(config.logger.stats_interval_ms), log_stats);
+    }
+    reactor.add_timer(kWaitLogInterval, [&] {
+        if (std::chrono::steady_clock::now() - last_frame >= kWaitLogInterval) {
+            spdlog::info("Waiting for processed frames on {}", config.logger.sub_endpoint);
+        }
+    });
+    if (bench_mode) {
+        reactor.add_timer(std::chrono::milliseconds(500), [&] {
+            if (pipeline->stats().received > 0 &&
+                std::chrono::steady_clock::now() - last_frame >= kBenchIdleExit) {
+                reactor.stop();
+            }
+        });
+    }
+    try {
+        reactor.run(g_keep_running);
+    } catch (const zmq::error_t& ex) {
+        if (g_keep_running.load()) {
+            spdlog::error("ZeroMQ poll error: {}", ex.what());
+        }
+    }
+
+    spdlog::info("Data logger shutting down");
+    metrics_server.stop();
+    pipeline->stop();  // Drains queued frames and commits the final partial batch
+    log_stats();
+    if (bench_mode) {
+        const auto stats = pipeline->stats();
+        bench.log_summary("logger", stats.dropped + stats.failed + gaps.total());
+    }
+    return 0;
+}
+
+void request_stop() {
+    g_keep_running.store(false);
+}
+
+}  // namespace dist::data_logger
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "dist/common/stage.hpp"
+
+namespace dist::feature_extractor {
+
+// Feature extractor: processes frames until --bench input goes quiet or
+// request_stop(), taking the same command line as the `feature_extractor` binary. Runs once per
+// process; returns the exit status.
+int run(int argc, char** argv, const dist::common::StageRuntime& runtime = {});
+
+// Stop processing (thread-safe).
+void request_stop();
+
+}  // namespace dist::feature_extractor
@@ -0,0 +1,99 @@
+#include "feature_cache.hpp"
+
+#include <opencv2/imgproc.hpp>
+
+#include <limits>
+#include <utility>
+
+namespace dist::feature_extractor {
+
+namespace {
+
+constexpr int kThumbnailSide = 32;
+
+std::size_t entry_bytes(const CachedFeatures& features) {
+    return features.keypoints.size() * sizeof(cv::KeyPoint) +
+           features.descriptors.total() * features.descriptors.elemSize() +
+           features.thumbnail.total() * features.thumbnail.elemSize() + sizeof(CachedFeatures);
+}
+
+}  // namespace
+
+FeatureCache::FeatureCache(std::size_t budget_bytes, double diff_threshold)
+    : budget_bytes_(budget_bytes), diff_threshold_(diff_threshold) {}
+
+std::shared_ptr<const CachedFeatures> FeatureCache::find(std::uint64_t hash) {
+    std::lock_guard lock(mutex_);
+    const auto it = index_.find(hash);
+    if (it == index_.end()) {
+        return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->features;
+}
+
+std::shared_ptr<const CachedFeatures> FeatureCache::find_similar(const cv::Mat& thumbnail,
+                                                                 cv::Size frame_size) {
+    if (!near_duplicates() || thumbnail.empty()) {
+        return nullptr;
+    }
+    const double area = static_cast<double>(thumbnail.total());
+    std::lock_guard lock(mutex_);
+    auto best = entries_.end();
+    double best_diff = std::numeric_limits<double>::max();
+    // A linear scan over 1 KB thumbnails; the budget keeps the entry count modest.
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        const auto& cached = *it->features;
+        if (cached.frame_size != frame_size || cached.thumbnail.empty()) {
+            continue;
+        }
+        const double diff = cv::norm(thumbnail, cached.thumbnail, cv::NORM_L1) / area;
+        if (diff < best_diff) {
+            best_diff = diff;
+            best = it;
+        }
+    }
+    if (best == entries_.end() || best_diff > diff_threshold_) {
+        return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, best);
+    return best->features;
+}
+
+void FeatureCache::insert(std::uint64_t hash, std::shared_ptr<const CachedFeatures> features) {
+    const std::size_t bytes = entry_bytes(*features);
+    if (bytes > budget_bytes_) {
+        return;
+    }
+    std::lock_guard lock(mutex_);
+    if (const auto it = index_.find(hash); it != index_.end()) {
+        // Another worker finished the same frame first; keep its entry.
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return;
+    }
+    while (!entries_.empty() && bytes_ + bytes > budget_bytes_) {
+        bytes_ -= entries_.back().bytes;
+        index_.erase(entries_.back().hash);
+        entries_.pop_back();
+    }
+    entries_.push_front(Entry{hash, std::move(features), bytes});
+    index_.emplace(hash, entries_.begin());
+    bytes_ += bytes;
+}
+
+cv::Mat FeatureCache::make_thumbnail(const cv::Mat& image) {
+    cv::Mat gray = image;
+    if (image.channels() == 3) {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    } else if (image.channels() == 4) {
+        cv::cvtColor(image, gray, cv::COLOR_BGRA2GRAY);
+    }
+    cv::Mat thumbnail;
+    cv::resize(gray, thumbnail, cv::Size(kThumbnailSide, kThumbnailSide), 0, 0, cv::INTER_AREA);
+    if (thumbnail.depth() != CV_8U) {
+        thumbnail.convertTo(thumbnail, CV_8U, thumbnail.depth() == CV_16U ? 1.0 / 256.0 : 1.0);
+    }
+    return thumbnail;
+}
+
+}  // namespace dist::feature_extractor
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace dist::feature_extractor {
+
+// Detection results for one frame, in source coordinates and the stored descriptor
+// format (before descriptor compression).
+struct CachedFeatures {
+    std::vector<cv::KeyPoint> keypoints;
+    cv::Mat descriptors;
+    cv::Size frame_size;
+    cv::Mat thumbnail;  // Only kept when near-duplicate matching is enabled
+};
+
+// LRU of recent detection results shared by every extraction worker, so looped replays
+// and static scenes skip detection. Keyed by content_hash() of the received payload;
+// with a diff threshold a frame whose thumbnail is within `diff_threshold` (mean
+// absolute difference, 0-255) of a cached one also counts as a hit.
+class FeatureCache {
+  public:
+    FeatureCache(std::size_t budget_bytes, double diff_threshold);
+
+    [[nodiscard]] std::shared_ptr<const CachedFeatures> find(std::uint64_t hash);
+    // Nearest cached frame of the same size; nullptr when none is within the threshold.
+    [[nodiscard]] std::shared_ptr<const CachedFeatures> find_similar(const cv::Mat& thumbnail,
+                                                                     cv::Size frame_size);
+    void insert(std::uint64_t hash, std::shared_ptr<const CachedFeatures> features);
+
+    [[nodiscard]] bool near_duplicates() const { return diff_threshold_ > 0.0; }
+
+    // Small grayscale copy of `image` used for near-duplicate matching.
+    [[nodiscard]] static cv::Mat make_thumbnail(const cv::Mat& image);
+
+  private:
+    struct Entry {
+        std::uint64_t hash = 0;
+        std::shared_ptr<const CachedFeatures> features;
+        std::size_t bytes = 0;
+    };
+
+    const std::size_t budget_bytes_;
+    const double diff_threshold_;
+    std::mutex mutex_;
+    std::list<Entry> entries_;  // Most recently used first
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index_;
+    std::size_t bytes_ = 0;
+};
+
+}  // namespace dist::feature_extractor
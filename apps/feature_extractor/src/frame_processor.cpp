@@ -0,0 +1,349 @@
+#include "frame_processor.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "dist/common/buffer_pool.hpp"
+#include "dist/common/compression.hpp"
+#include "dist/common/image_encoding.hpp"
+#include "dist/common/metrics.hpp"
+#include "dist/common/trace.hpp"
+#include "dist/common/utils.hpp"
+#include "dist/common/wire_format.hpp"
+#include "dist/common/zmq_message.hpp"
+#include "dist/features/frame_decode.hpp"
+#include "dist/features/keypoints.hpp"
+
+namespace dist::feature_extractor {
+
+namespace {
+
+namespace wire = dist::common::wire;
+
+constexpr std::size_t kMaxPayloadBytes = 50 * 1024 * 1024;  // 50 MB safety cap
+
+struct ProcessorMetrics {
+    dist::common::Histogram& decode_seconds;
+    dist::common::Histogram& detect_seconds;
+    dist::common::Counter& reused;
+    dist::common::Histogram& keypoints_bytes;
+    dist::common::Histogram& descriptors_bytes;
+    dist::common::Histogram& image_bytes;
+    dist::common::Histogram& annotated_bytes;
+};
+
+// Shared by every worker; the metrics themselves are atomics.
+ProcessorMetrics& processor_metrics() {
+    auto& registry = dist::common::metrics();
+    constexpr const char* kPartBytes = "dist_extractor_part_bytes";
+    constexpr const char* kPartHelp = "Size of each outgoing message part";
+    static ProcessorMetrics metrics{
+        registry.histogram("dist_extractor_decode_seconds",
+                           "Payload decode time",
+                           dist::common::latency_buckets()),
+        registry.histogram("dist_extractor_detect_seconds",
+                           "Preprocess + detect + descriptor conversion time (cache misses)",
+                           dist::common::latency_buckets()),
+        registry.counter("dist_extractor_frames_reused_total",
+                         "Frames answered from the feature reuse cache"),
+        registry.histogram(
+            kPartBytes, kPartHelp, dist::common::byte_buckets(), "part=\"keypoints\""),
+        registry.histogram(
+            kPartBytes, kPartHelp, dist::common::byte_buckets(), "part=\"descriptors\""),
+        registry.histogram(kPartBytes, kPartHelp, dist::common::byte_buckets(), "part=\"image\""),
+        registry.histogram(
+            kPartBytes, kPartHelp, dist::common::byte_buckets(), "part=\"annotated\""),
+    };
+    return metrics;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void release_mat(void* /*data*/, void* hint) {
+    delete static_cast<cv::Mat*>(hint);
+}
+
+// Expose a matrix's pixels as a ZeroMQ message; the heap-held header keeps the
+// refcounted buffer alive until libzmq is done with it.
+zmq::message_t mat_message(const cv::Mat& mat) {
+    if (mat.empty()) {
+        return zmq::message_t{};
+    }
+    auto* owned = new cv::Mat(mat.isContinuous() ? mat : mat.clone());
+    return zmq::message_t(owned->data, owned->total() * owned->elemSize(), &release_mat, owned);
+}
+
+wire::FrameHeader make_binary_header(const nlohmann::json& source,
+                                     const cv::Mat& descriptors,
+                                     std::size_t descriptors_bytes,
+                                     dist::common::Compression descriptor_compression,
+                                     dist::features::DetectorBackend detector) {
+    wire::FrameHeader header;
+    header.frame_id = source.value<std::int64_t>("frame_id", -1);
+    header.loop_iteration = source.value<std::int64_t>("loop_iteration", 0);
+    header.width = source.value("width", 0);
+    header.height = source.value("height", 0);
+    header.channels = source.value("channels", 0);
+    header.cv_type = source.value("cv_type", -1);
+    header.step = source.value<std::uint64_t>("step", 0);
+    header.raw_bytes = source.value<std::uint64_t>("raw_bytes", 0);
+    header.descriptor_rows = descriptors.rows;
+    header.descriptor_cols = descriptors.cols;
+    header.descriptor_elem_size = static_cast<std::int32_t>(descriptors.elemSize());
+    header.descriptor_type = descriptors.type();
+    header.descriptors_bytes = descriptors_bytes;
+    header.descriptors_raw_bytes = descriptors.total() * descriptors.elemSize();
+    wire::set_field(header.source_timestamp, source.value("timestamp", std::string{}));
+    wire::set_field(header.processed_timestamp, dist::common::now_iso8601());
+    wire::set_field(header.encoding, source.value("encoding", std::string("png")));
+    wire::set_field(header.compression, source.value("compression", std::string("none")));
+    wire::set_field(header.descriptor_compression, dist::common::to_string(descriptor_compression));
+    wire::set_field(header.detector, dist::features::to_string(detector));
+    wire::set_field(header.filename, source.value("filename", std::string{}));
+    return header;
+}
+
+}  // namespace
+
+FrameProcessor::FrameProcessor(const dist::common::FeatureExtractorConfig& config,
+                               AnnotationSettings annotation,
+                               std::shared_ptr<FeatureCache> cache)
+    : detector_(dist::features::make_detector(
+          dist::features::parse_detector_backend(config.detector)
+              .value_or(dist::features::DetectorBackend::sift),
+          config)),
+      preprocessor_(config),
+      annotation_(annotation),
+      binary_header_(config.header_format != "json"),
+      // main() validates these and logs each fallback once.
+      descriptor_format_(dist::features::parse_descriptor_format(config.descriptor_format)
+                             .value_or(dist::features::DescriptorFormat::f32)),
+      descriptor_compression_(dist::common::parse_compression(config.descriptor_compression)
+                                  .value_or(dist::common::Compression::none)),
+      cache_(std::move(cache)) {
+    if (!dist::common::compression_available(descriptor_compression_)) {
+        descriptor_compression_ = dist::common::Compression::none;
+    }
+}
+
+void FrameProcessor::detect(const cv::Mat& image,
+                            std::vector<cv::KeyPoint>& keypoints,
+                            cv::Mat& descriptors) {
+    {
+        // The working image may alias `image`; it only lives for detection. Annotation
+        // and the forwarded payload use the full frame, hence the keypoint restore.
+        const auto prepared = preprocessor_.prepare(image);
+        detector_->detect_and_compute(prepared.image, prepared.mask, keypoints, descriptors);
+        dist::features::Preprocessor::restore_keypoints(prepared, keypoints);
+    }
+    // Narrow to the storage format before it is cached or sent.
+    descriptors = dist::features::convert_descriptors(descriptors, descriptor_format_);
+}
+
+std::optional<ProcessedFrame> FrameProcessor::process(zmq::message_t header_msg,
+                                                      zmq::message_t image_msg,
+                                                      std::int64_t received_ns) {
+    nlohmann::json source_header;
+    try {
+        source_header = nlohmann::json::parse(header_msg.to_string());
+    } catch (const std::exception& ex) {
+        spdlog::warn("Failed to parse header JSON: {}", ex.what());
+        return std::nullopt;
+    }
+    // Generator stamps arrive in the header; this stage adds receive through serialize.
+    auto trace = dist::common::trace_from_json(source_header.value("trace", nlohmann::json{}));
+    trace.set(dist::common::TraceStage::receive,
+              received_ns != 0 ? received_ns : dist::common::trace_clock_ns());
+
+    // Any container cv::imdecode understands is accepted, plus raw pixel buffers.
+    const std::string encoding = source_header.value("encoding", "png");
+    const bool is_raw = encoding == "raw";
+    if (!is_raw && !dist::common::is_image_codec(encoding)) {
+        spdlog::warn("Unsupported encoding '{}' on frame {}",
+                     encoding,
+                     source_header.value("frame_id", -1));
+        return std::nullopt;
+    }
+
+    spdlog::debug("Received frame {} ({} bytes)",
+                 source_header.value("frame_id", -1),
+                 image_msg.size());
+
+    // Overlays are sampled and never drawn here when the logger owns annotation.
+    const bool annotate = annotation_.sampler.should_annotate(source_header);
+    const bool draw_here =
+        annotate && annotation_.stage == dist::features::AnnotationStage::extractor;
+
+    // Identical payloads (looped replays) are recognised before decoding; the image is
+    // then only decoded if an overlay has to be drawn from it.
+    std::uint64_t content_hash = 0;
+    std::shared_ptr<const CachedFeatures> cached;
+    if (cache_) {
+        content_hash = dist::common::content_hash(image_msg.data(), image_msg.size());
+        cached = cache_->find(content_hash);
+    }
+
+    // Decode straight out of the received message; it is forwarded untouched later.
+    auto& metrics = processor_metrics();
+    cv::Mat image;
+    if (!cached || draw_here) {
+        const auto decode_start = std::chrono::steady_clock::now();
+        image = dist::features::decode_frame(source_header, image_msg);
+        if (image.empty()) {
+            spdlog::warn("Failed to decode incoming frame {}", source_header.value("frame_id", -1));
+            return std::nullopt;
+        }
+        metrics.decode_seconds.observe(seconds_since(decode_start));
+    }
+
+    trace.mark(dist::common::TraceStage::decode);
+
+    cv::Mat thumbnail;
+    if (!cached && cache_ && cache_->near_duplicates()) {
+        thumbnail = FeatureCache::make_thumbnail(image);
+        cached = cache_->find_similar(thumbnail, image.size());
+    }
+
+    const bool reused = cached != nullptr;
+    std::vector<cv::KeyPoint> keypoints;
+    cv::Mat descriptors;
+    if (reused) {
+        // Copies of the cached vectors; the descriptor matrix is shared read-only.
+        keypoints = cached->keypoints;
+        descriptors = cached->descriptors;
+        metrics.reused.inc();
+    } else {
+        const auto detect_start = std::chrono::steady_clock::now();
+        detect(image, keypoints, descriptors);
+        metrics.detect_seconds.observe(seconds_since(detect_start));
+        if (cache_) {
+            auto entry = std::make_shared<CachedFeatures>();
+            entry->keypoints = keypoints;
+            entry->descriptors = descriptors;
+            entry->frame_size = image.size();
+            entry->thumbnail = std::move(thumbnail);
+            cache_->insert(content_hash, std::move(entry));
+        }
+    }
+
+    trace.mark(dist::common::TraceStage::detect);
+
+    // Uncompressed, the descriptor matrix itself backs the message.
+    auto descriptor_compression = descriptor_compression_;
+    zmq::message_t descriptors_msg;
+    if (descriptor_compression != dist::common::Compression::none && !descriptors.empty()) {
+        const cv::Mat contiguous = descriptors.isContinuous() ? descriptors : descriptors.clone();
+        auto packed = dist::common::buffer_pool().acquire(contiguous.total() * contiguous.elemSize());
+        if (dist::common::compress(descriptor_compression,
+                                   contiguous.data,
+                                   contiguous.total() * contiguous.elemSize(),
+                                   packed)) {
+            descriptors_msg = dist::common::make_pooled_message(std::move(packed));
+        } else {
+            spdlog::warn("Descriptor compression failed on frame {}; sending them uncompressed",
+                         source_header.value("frame_id", -1));
+            descriptor_compression = dist::common::Compression::none;
+        }
+    }
+    if (descriptor_compression == dist::common::Compression::none) {
+        descriptors_msg = mat_message(descriptors);
+    }
+
+    std::vector<std::uint8_t> annotated_bytes;
+    if (draw_here) {
+        annotated_bytes = dist::common::buffer_pool().acquire();
+        dist::features::render_annotation(image, keypoints, annotated_bytes);
+    }
+
+    const auto frame_id = source_header.value("frame_id", -1);
+    spdlog::debug("Processed frame {} ({} keypoints{})",
+                 frame_id,
+                 keypoints.size(),
+                 reused ? ", reused" : "");
+
+    const std::size_t payload_bytes =
+        descriptors_msg.size() + image_msg.size() + annotated_bytes.size();
+    if (payload_bytes > kMaxPayloadBytes) {
+        spdlog::warn("Processed payload too large ({} bytes > {}), dropping frame {}",
+                     payload_bytes,
+                     kMaxPayloadBytes,
+                     frame_id);
+        return std::nullopt;
+    }
+
+    // Bundle descriptors, raw payload, and (optional) annotated overlay. The received
+    // image message is re-published as-is; `image` may alias it, so release that first.
+    image.release();
+    trace.mark(dist::common::TraceStage::serialize);
+    const bool request_annotation =
+        annotate && annotation_.stage == dist::features::AnnotationStage::logger;
+    ProcessedFrame processed;
+    processed.parts.reserve(5);
+    if (binary_header_) {
+        // Keypoints travel packed in their own part so the logger never parses them.
+        wire::FrameHeader header = make_binary_header(source_header,
+                                                      descriptors,
+                                                      descriptors_msg.size(),
+                                                      descriptor_compression,
+                                                      detector_->backend());
+        header.keypoint_count = keypoints.size();
+        header.image_bytes = image_msg.size();
+        header.annotated_bytes = annotated_bytes.size();
+        std::copy(trace.ns.begin(), trace.ns.end(), header.trace_ns);
+        header.flags = static_cast<std::uint16_t>((request_annotation ? wire::kFlagAnnotate : 0U) |
+                                                  (reused ? wire::kFlagReused : 0U));
+        zmq::message_t keypoints_msg(keypoints.size() * sizeof(wire::PackedKeypoint));
+        dist::features::pack_keypoints(keypoints, keypoints_msg.data());
+        metrics.keypoints_bytes.observe(static_cast<double>(keypoints_msg.size()));
+        processed.parts.emplace_back(&header, sizeof(header));
+        processed.parts.push_back(std::move(keypoints_msg));
+    } else {
+        // Debug format: one self-describing JSON document with inline keypoints.
+        nlohmann::json header = {
+            {"source", source_header},
+            {"processed_timestamp", dist::common::now_iso8601()},
+            {"keypoint_count", keypoints.size()},
+            {"descriptor_rows", descriptors.rows},
+            {"descriptor_cols", descriptors.cols},
+            {"descriptor_elem_size", descriptors.elemSize()},
+            {"descriptor_type", descriptors.type()},
+            {"descriptors_bytes", descriptors_msg.size()},
+            {"descriptors_raw_bytes", descriptors.total() * descriptors.elemSize()},
+            {"descriptor_compression", dist::common::to_string(descriptor_compression)},
+            {"detector", dist::features::to_string(detector_->backend())},
+            {"annotated_bytes", annotated_bytes.size()},
+            {"keypoints", dist::features::keypoints_to_json(keypoints)},
+            {"trace", dist::common::trace_to_json(trace)},
+        };
+        if (request_annotation) {
+            header["annotate"] = true;  // Logger renders the overlay from the forwarded image.
+        }
+        if (reused) {
+            header["reused"] = true;
+        }
+        processed.parts.emplace_back(header.dump());
+    }
+    metrics.descriptors_bytes.observe(static_cast<double>(descriptors_msg.size()));
+    metrics.image_bytes.observe(static_cast<double>(image_msg.size()));
+    processed.parts.push_back(std::move(descriptors_msg));
+    processed.parts.push_back(std::move(image_msg));
+    if (!annotated_bytes.empty()) {
+        metrics.annotated_bytes.observe(static_cast<double>(annotated_bytes.size()));
+        processed.parts.push_back(dist::common::make_pooled_message(std::move(annotated_bytes)));
+        processed.annotated = true;
+    }
+
+    processed.frame_id = frame_id;
+    processed.trace = trace;
+    return processed;
+}
+
+}  // namespace dist::feature_extractor
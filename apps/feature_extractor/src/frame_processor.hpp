@@ -0,0 +1,69 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <zmq.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "dist/common/compression.hpp"
+#include "dist/common/config.hpp"
+#include "dist/common/trace.hpp"
+#include "dist/features/annotation.hpp"
+#include "dist/features/descriptors.hpp"
+#include "dist/features/detector.hpp"
+#include "dist/features/preprocess.hpp"
+#include "feature_cache.hpp"
+
+namespace dist::feature_extractor {
+
+// Staged ZeroMQ parts ready to flush when the logger is available:
+// [binary header][packed keypoints][descriptors][raw image][optional annotated image],
+// or [JSON header][descriptors][raw image][optional annotated image] in debug mode.
+struct ProcessedFrame {
+    int frame_id = -1;
+    std::string stream;  // Source stream; parts[0] is its topic once the pool returns it
+    bool annotated = false;  // Carries an overlay part
+    std::vector<zmq::message_t> parts;
+    dist::common::FrameTrace trace;  // As sent in the header (through serialize)
+};
+
+// Which frames get keypoint overlays and which stage draws them.
+struct AnnotationSettings {
+    dist::features::AnnotationSampler sampler;
+    dist::features::AnnotationStage stage = dist::features::AnnotationStage::extractor;
+};
+
+// Decode -> detect -> serialize for one frame. Each instance owns its detector
+// (FEATURE_EXTRACTOR_DETECTOR), so a worker thread can run it without sharing state;
+// only the optional reuse cache is shared (and internally locked).
+class FrameProcessor {
+  public:
+    FrameProcessor(const dist::common::FeatureExtractorConfig& config,
+                   AnnotationSettings annotation,
+                   std::shared_ptr<FeatureCache> cache = nullptr);
+
+    // Consumes both messages; nullopt when the frame is malformed or oversized.
+    // `received_ns` is the TraceStage::receive stamp (0 stamps it on entry).
+    [[nodiscard]] std::optional<ProcessedFrame> process(zmq::message_t header_msg,
+                                                        zmq::message_t image_msg,
+                                                        std::int64_t received_ns = 0);
+
+  private:
+    // Detect on the preprocessed frame; results are in source coordinates and the
+    // stored descriptor format.
+    void detect(const cv::Mat& image, std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors);
+
+    std::unique_ptr<dist::features::FeatureDetector> detector_;
+    dist::features::Preprocessor preprocessor_;
+    AnnotationSettings annotation_;
+    bool binary_header_;
+    dist::features::DescriptorFormat descriptor_format_;
+    dist::common::Compression descriptor_compression_;
+    std::shared_ptr<FeatureCache> cache_;
+};
+
+}  // namespace dist::feature_extractor
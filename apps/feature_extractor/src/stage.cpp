@@ -0,0 +1,689 @@
+#include "dist/feature_extractor/stage.hpp"
+
+#include <CLI/CLI.hpp>
+#include <opencv2/core/utility.hpp>
+#include <spdlog/spdlog.h>
+#include <zmq.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "dist/common/bench_report.hpp"
+#include "dist/common/buffer_pool.hpp"
+#include "dist/common/compression.hpp"
+#include "dist/common/config.hpp"
+#include "dist/common/distribution.hpp"
+#include "dist/common/env_loader.hpp"
+#include "dist/common/fair_queue.hpp"
+#include "dist/common/pending_queue.hpp"
+#include "dist/common/metrics.hpp"
+#include "dist/common/reactor.hpp"
+#include "dist/common/shm_transport.hpp"
+#include "dist/common/stream.hpp"
+#include "dist/common/subscriber_monitor.hpp"
+#include "dist/common/trace.hpp"
+#include "dist/common/utils.hpp"
+#include "dist/common/version.hpp"
+#include "dist/common/zmq_message.hpp"
+#include "dist/features/descriptors.hpp"
+#include "dist/features/detector.hpp"
+#include "dist/features/preprocess.hpp"
+#include "frame_processor.hpp"
+#include "worker_pool.hpp"
+
+namespace fs = std::filesystem;
+using dist::common::SubscriberMonitor;
+using dist::feature_extractor::AnnotationSettings;
+using dist::feature_extractor::ProcessedFrame;
+using dist::feature_extractor::WorkerPool;
+
+namespace {
+
+std::atomic_bool g_keep_running{true};
+constexpr std::size_t kDefaultQueueDepth = 100;             // Pending frames when logger is absent
+constexpr std::size_t kDefaultStreamQueueDepth = 16;        // Received frames per stream
+constexpr auto kWaitLogInterval = std::chrono::seconds(5);
+constexpr auto kBenchIdleExit = std::chrono::seconds(3);  // --bench ends after this much silence
+constexpr int kPullHighWaterMark = 2;  // Leave queued frames with the generator for idle peers
+constexpr int kZmqRetryAttempts = 3;
+constexpr auto kZmqRetryBackoff = std::chrono::seconds(1);
+
+// A received frame waiting for a worker in its stream's queue.
+struct InboundFrame {
+    zmq::message_t header;
+    zmq::message_t image;
+    std::int64_t received_ns = 0;
+};
+
+bool connect_with_retry(zmq::socket_t& socket,
+                        const std::string& endpoint,
+                        std::string_view socket_name,
+                        bool fatal_on_failure) {
+    int attempt = 1;
+    while (g_keep_running.load()) {
+        try {
+            socket.connect(endpoint);
+            return true;
+        } catch (const zmq::error_t& ex) {
+            spdlog::warn(
+                "Failed to connect {} to {} (attempt {}): {}. Waiting for upstream component...",
+                socket_name,
+                endpoint,
+                attempt,
+                ex.what());
+            if (fatal_on_failure && attempt >= kZmqRetryAttempts) {
+                return false;
+            }
+            ++attempt;
+            std::this_thread::sleep_for(kZmqRetryBackoff);
+        }
+    }
+    return false;
+}
+
+bool bind_with_retry(zmq::socket_t& socket, const std::string& endpoint, std::string_view role) {
+    for (int attempt = 1; attempt <= kZmqRetryAttempts; ++attempt) {
+        try {
+            socket.bind(endpoint);
+            return true;
+        } catch (const zmq::error_t& ex) {
+            spdlog::error("Failed to bind {} on {} (attempt {}/{}): {}. Another process might be "
+                          "using this endpoint.",
+                          role,
+                          endpoint,
+                          attempt,
+                          kZmqRetryAttempts,
+                          ex.what());
+            if (attempt == kZmqRetryAttempts) {
+                break;
+            }
+            std::this_thread::sleep_for(kZmqRetryBackoff);
+        }
+    }
+    return false;
+}
+
+// Drop the rest of a multipart message once its first parts were rejected.
+void discard_remaining(zmq::socket_t& socket, bool more) {
+    while (more) {
+        zmq::message_t part;
+        if (!socket.recv(part, zmq::recv_flags::none)) {
+            return;
+        }
+        more = part.more();
+    }
+}
+
+fs::path resolve_env_path(const std::string& cli_env_path,
+                          const char* env_override,
+                          const fs::path& root) {
+    if (!cli_env_path.empty()) {
+        return cli_env_path;
+    }
+    if (env_override != nullptr) {
+        return env_override;
+    }
+    return root / ".env";
+}
+
+void configure_logging(std::string_view level) {
+    spdlog::set_level(dist::common::level_from_string(level));
+    spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] %v");
+}
+
+}  // namespace
+
+namespace dist::feature_extractor {
+
+int run(int argc, char** argv, const dist::common::StageRuntime& runtime) {
+    CLI::App app{"Feature Extractor - consumes frames, detects features, republishes"};
+    std::string cli_env_path;
+    std::string cli_log_level;
+    bool send_annotated = false;
+    app.add_option("--env", cli_env_path, "Path to the .env file (overrides DIST_ENV_PATH)");
+    app.add_option("--log-level", cli_log_level, "Override log level (trace|debug|info|warn|error|critical)");
+    app.add_flag("--annotated", send_annotated, "Enable sending annotated keypoint overlays");
+    bool bench_mode = false;
+    app.add_flag("--bench",
+                 bench_mode,
+                 "Exit once input goes quiet and report fps, per-stage latency and drops");
+
+    CLI11_PARSE(app, argc, argv);
+
+    // Centralized configuration loading for a single source of truth.
+    dist::common::EnvLoader loader;
+    const auto root = fs::current_path();
+    const char* env_override = std::getenv("DIST_ENV_PATH");
+    fs::path env_path = resolve_env_path(cli_env_path, env_override, root);
+    if (!loader.load_from_file(env_path)) {
+        spdlog::warn("Failed to read environment file at {}. Falling back to process environment "
+                     "variables.",
+                     env_path.string());
+        if (!loader.load_from_env()) {
+            spdlog::error("No configuration could be loaded. Provide a .env file or pass variables "
+                          "via docker --env-file.");
+            return 1;
+        }
+    }
+
+    for (const auto& [key, value] : runtime.env_overrides) {
+        loader.set(key, value);
+    }
+    const auto config = dist::common::load_app_config(loader, root);
+    const auto resolved_level =
+        cli_log_level.empty() ? config.global.log_level : cli_log_level;
+    if (runtime.configure_process) {
+        configure_logging(resolved_level);
+    }
+
+    std::size_t max_queue_depth = kDefaultQueueDepth;
+    if (config.extractor.queue_depth > 0) {
+        max_queue_depth = static_cast<std::size_t>(config.extractor.queue_depth);
+    } else {
+        spdlog::warn("FEATURE_EXTRACTOR_QUEUE_DEPTH={} is invalid; using default {}",
+                     config.extractor.queue_depth,
+                     kDefaultQueueDepth);
+    }
+
+    auto drop_policy = dist::common::parse_drop_policy(config.extractor.drop_policy);
+    if (!drop_policy) {
+        spdlog::warn("FEATURE_EXTRACTOR_DROP_POLICY={} is invalid; using oldest",
+                     config.extractor.drop_policy);
+        drop_policy = dist::common::DropPolicy::oldest;
+    }
+    const dist::common::PendingLimits pending_limits{
+        max_queue_depth,
+        static_cast<std::size_t>(std::max(config.extractor.queue_mb, 0)) * 1024 * 1024,
+        *drop_policy};
+    std::optional<dist::common::SpillStore> spill;
+    if (!config.extractor.spill_dir.empty()) {
+        try {
+            spill.emplace(config.extractor.spill_dir,
+                          static_cast<std::size_t>(std::max(config.extractor.spill_mb, 0)) *
+                              1024 * 1024);
+        } catch (const std::exception& ex) {
+            spdlog::error("{}", ex.what());
+            return 1;
+        }
+    }
+    if (runtime.configure_process) {
+        dist::common::buffer_pool().set_max_bytes(
+            static_cast<std::size_t>(std::max(config.extractor.buffer_pool_mb, 0)) * 1024 * 1024);
+    }
+    std::optional<dist::common::ShmWriter> shm;
+    if (dist::common::is_shm_endpoint(config.extractor.pub_endpoint)) {
+        try {
+            shm.emplace(config.extractor.pub_endpoint,
+                        static_cast<std::size_t>(std::max(config.extractor.shm_mb, 0)) * 1024 *
+                            1024);
+        } catch (const std::exception& ex) {
+            spdlog::error("{}", ex.what());
+            return 1;
+        }
+    }
+    const bool shm_input = dist::common::is_shm_endpoint(config.extractor.sub_endpoint);
+
+    std::size_t stream_queue_depth = kDefaultStreamQueueDepth;
+    if (config.extractor.stream_queue_depth > 0) {
+        stream_queue_depth = static_cast<std::size_t>(config.extractor.stream_queue_depth);
+    } else {
+        spdlog::warn("FEATURE_EXTRACTOR_STREAM_QUEUE_DEPTH={} is invalid; using default {}",
+                     config.extractor.stream_queue_depth,
+                     kDefaultStreamQueueDepth);
+    }
+
+    auto distribution = dist::common::parse_distribution(config.extractor.distribution);
+    if (!distribution) {
+        spdlog::warn("FEATURE_EXTRACTOR_DISTRIBUTION={} is invalid; using pubsub",
+                     config.extractor.distribution);
+        distribution = dist::common::Distribution::pubsub;
+    }
+    const bool push_pull = *distribution == dist::common::Distribution::pushpull;
+    const auto stream_filter =
+        dist::common::parse_stream_list(config.extractor.streams, "FEATURE_EXTRACTOR_STREAMS");
+    if (push_pull && !stream_filter.empty()) {
+        spdlog::warn("FEATURE_EXTRACTOR_STREAMS is ignored with pushpull distribution; PULL "
+                     "sockets cannot filter by topic");
+    }
+    if (config.extractor.header_format != "binary" && config.extractor.header_format != "json") {
+        spdlog::warn("FEATURE_EXTRACTOR_HEADER_FORMAT={} is invalid; using binary",
+                     config.extractor.header_format);
+    }
+
+    if (runtime.handle_signals) {
+        dist::common::install_signal_handlers(g_keep_running);
+    }
+
+    // SUB (every frame) or PULL (this instance's share) socket ingests frames from the generator.
+    // Shared with the other stages when fused: inproc:// only connects within one context.
+    std::optional<zmq::context_t> own_context;
+    zmq::context_t& context =
+        runtime.context != nullptr ? *runtime.context : own_context.emplace(1);
+    zmq::socket_t subscriber{context, dist::common::receiver_socket_type(*distribution)};
+    subscriber.set(zmq::sockopt::linger, 0);
+    if (push_pull) {
+        // A short inbound queue stops a busy extractor from hoarding frames.
+        subscriber.set(zmq::sockopt::rcvhwm, kPullHighWaterMark);
+    } else {
+        dist::common::subscribe_streams(subscriber, stream_filter);
+    }
+    if (!connect_with_retry(subscriber,
+                            dist::common::zmq_endpoint(config.extractor.sub_endpoint),
+                            "input socket",
+                            false)) {
+        return 1;
+    }
+
+    // PUB socket emits enriched frames for the logger; PUSH connects to a logger that fans in.
+    zmq::socket_t publisher{context, dist::common::sender_socket_type(*distribution)};
+    publisher.set(zmq::sockopt::sndhwm, 100);
+    publisher.set(zmq::sockopt::linger, 0);
+    struct MonitorGuard {
+        SubscriberMonitor* monitor = nullptr;
+        ~MonitorGuard() {
+            if (monitor != nullptr) {
+                monitor->stop();
+            }
+        }
+    };
+    // Declared before the monitor, whose thread wakes it, so it is destroyed after it.
+    dist::common::Reactor reactor;
+    auto subscriber_monitor = std::make_unique<SubscriberMonitor>("inproc://pub2_monitor");
+    subscriber_monitor->on_change([&reactor] { reactor.wake(); });
+    MonitorGuard monitor_guard{subscriber_monitor.get()};
+
+    // Fan-in: many extractors connect to the one logger that binds the endpoint.
+    const auto output_endpoint = dist::common::zmq_endpoint(config.extractor.pub_endpoint);
+    const bool output_ready =
+        push_pull ? connect_with_retry(publisher, output_endpoint, "PUSH socket", false)
+                  : bind_with_retry(publisher, output_endpoint, "PUB socket");
+    if (!output_ready) {
+        return 1;
+    }
+    subscriber_monitor->start(publisher);
+    monitor_guard.monitor = subscriber_monitor.get();
+
+    std::size_t worker_count = 1;
+    if (config.extractor.workers > 0) {
+        worker_count = static_cast<std::size_t>(config.extractor.workers);
+    } else {
+        spdlog::warn("FEATURE_EXTRACTOR_WORKERS={} is invalid; using a single worker",
+                     config.extractor.workers);
+    }
+    if (worker_count > 1 && runtime.configure_process) {
+        // Parallelism comes from the pool; stop OpenCV from oversubscribing every worker.
+        cv::setNumThreads(1);
+    }
+    auto annotation_stage = dist::features::parse_annotation_stage(config.extractor.annotation_stage);
+    if (!annotation_stage) {
+        spdlog::warn("FEATURE_EXTRACTOR_ANNOTATION_STAGE={} is invalid; using extractor",
+                     config.extractor.annotation_stage);
+        annotation_stage = dist::features::AnnotationStage::extractor;
+    }
+    // --annotated enables sampling; per-frame "annotate" requests are honoured either way.
+    const AnnotationSettings annotation{
+        dist::features::AnnotationSampler{send_annotated, config.extractor.annotate_every_n},
+        *annotation_stage};
+
+    auto detector = dist::features::parse_detector_backend(config.extractor.detector);
+    if (!detector || !dist::features::detector_available(*detector)) {
+        spdlog::warn("FEATURE_EXTRACTOR_DETECTOR={} is invalid or unavailable in this build; using "
+                     "sift",
+                     config.extractor.detector);
+        detector = dist::features::DetectorBackend::sift;
+    }
+
+    // Workers fall back the same way; validate here so the warning is logged once.
+    if (!config.extractor.roi.empty() && !dist::features::parse_roi(config.extractor.roi)) {
+        spdlog::warn("FEATURE_EXTRACTOR_ROI={} is not x,y,w,h; detecting on the full frame",
+                     config.extractor.roi);
+    }
+    if (!dist::features::parse_roi_mode(config.extractor.roi_mode)) {
+        spdlog::warn("FEATURE_EXTRACTOR_ROI_MODE={} is invalid; using crop", config.extractor.roi_mode);
+    }
+    if (!config.extractor.mask_path.empty() && !fs::exists(config.extractor.mask_path)) {
+        spdlog::warn("FEATURE_EXTRACTOR_MASK_PATH {} does not exist; no mask applied",
+                     config.extractor.mask_path.string());
+    }
+    auto descriptor_format = dist::features::parse_descriptor_format(config.extractor.descriptor_format);
+    if (!descriptor_format) {
+        spdlog::warn("FEATURE_EXTRACTOR_DESCRIPTOR_FORMAT={} is invalid; using f32",
+                     config.extractor.descriptor_format);
+        descriptor_format = dist::features::DescriptorFormat::f32;
+    }
+    auto descriptor_compression =
+        dist::common::parse_compression(config.extractor.descriptor_compression);
+    if (!descriptor_compression || !dist::common::compression_available(*descriptor_compression)) {
+        spdlog::warn("FEATURE_EXTRACTOR_DESCRIPTOR_COMPRESSION={} is invalid or not built in; "
+                     "using none",
+                     config.extractor.descriptor_compression);
+        descriptor_compression = dist::common::Compression::none;
+    }
+
+    // Each worker configures its own detector instance from the .env parameters.
+    WorkerPool pool{config.extractor, annotation, worker_count, config.extractor.ordered_output};
+
+    spdlog::info("[feature_extractor] Dist Imaging Services v{}", dist::common::version());
+    spdlog::info("Listening on {}", config.extractor.sub_endpoint);
+    spdlog::info("Publishing to {}", config.extractor.pub_endpoint);
+    if (shm) {
+        spdlog::info("Payloads go through shared-memory segment {} ({} MB)",
+                     shm->segment(),
+                     config.extractor.shm_mb);
+    }
+    spdlog::info("Distribution: {}", dist::common::to_string(*distribution));
+    spdlog::info("Streams: {} ({} queued frames per stream)",
+                 stream_filter.empty() || push_pull ? "all" : config.extractor.streams,
+                 stream_queue_depth);
+    spdlog::info("Header format: {}",
+                 config.extractor.header_format == "json" ? "json" : "binary");
+    spdlog::info("Detector: {}", dist::features::to_string(*detector));
+    if (config.extractor.tile_size > 0) {
+        spdlog::info("Tiling: {}px tiles with {}px overlap",
+                     config.extractor.tile_size,
+                     config.extractor.tile_overlap);
+    }
+    if (config.extractor.reuse_cache_mb > 0) {
+        spdlog::info("Feature reuse: {} MB cache, diff threshold {}",
+                     config.extractor.reuse_cache_mb,
+                     config.extractor.reuse_diff_threshold);
+    }
+    spdlog::info("Preprocessing: max dimension {}, grayscale {}, roi '{}' ({}), mask '{}'",
+                 config.extractor.max_dimension,
+                 config.extractor.grayscale,
+                 config.extractor.roi,
+                 config.extractor.roi_mode,
+                 config.extractor.mask_path.string());
+    spdlog::info("Descriptors: {} ({} compression)",
+                 dist::features::to_string(*descriptor_format),
+                 dist::common::to_string(*descriptor_compression));
+    spdlog::info("Queue depth: {} frames, {} MB (drop {})",
+                 max_queue_depth,
+                 std::max(config.extractor.queue_mb, 0),
+                 dist::common::to_string(*drop_policy));
+    if (spill) {
+        spdlog::info("Queue spill: {} ({} MB)",
+                     config.extractor.spill_dir.string(),
+                     config.extractor.spill_mb);
+    }
+    spdlog::info("Workers: {} ({} output)",
+                 worker_count,
+                 config.extractor.ordered_output ? "ordered" : "unordered");
+    if (annotation.sampler.sampling()) {
+        spdlog::info("Annotating 1 in {} frames ({} stage)",
+                     config.extractor.annotate_every_n,
+                     dist::features::to_string(annotation.stage));
+    }
+
+    dist::common::PendingQueue<ProcessedFrame> pending{pending_limits,
+                                                       spill ? &*spill : nullptr};
+    dist::common::FairQueue<InboundFrame> inbound{stream_queue_depth};
+    auto last_input = std::chrono::steady_clock::now();
+
+    auto& registry = dist::common::metrics();
+    auto& received = registry.counter("dist_extractor_frames_received_total",
+                                      "Frames taken off the input socket");
+    auto& published = registry.counter("dist_extractor_frames_published_total",
+                                       "Processed frames handed to the output socket");
+    auto& dropped = registry.counter("dist_extractor_frames_dropped_total",
+                                     "Processed frames dropped because the pending queue was full");
+    auto& pending_depth = registry.gauge("dist_extractor_pending_frames",
+                                         "Processed frames waiting for the logger");
+    auto& pending_bytes = registry.gauge(
+        "dist_extractor_pending_bytes",
+        "Processed frame memory held by the pending queue (spilled frames excluded)");
+    registry.gauge_callback("dist_extractor_spill_lost_frames",
+                            "Spilled frames that could not be read back",
+                            [&pending] { return static_cast<double>(pending.lost()); });
+    registry.gauge_callback("dist_extractor_inbound_frames",
+                            "Received frames queued per stream for the worker pool",
+                            [&inbound] { return static_cast<double>(inbound.size()); });
+    // A stream that outruns the workers sheds its own oldest frames, not other streams'.
+    std::map<std::string, dist::common::Counter*> stream_shed;
+    std::uint64_t shed_total = 0;
+    const auto count_shed = [&](const std::string& stream) {
+        auto& counter = stream_shed[stream];
+        if (counter == nullptr) {
+            counter = &registry.counter("dist_extractor_stream_shed_frames_total",
+                                        "Received frames dropped from a full per-stream queue",
+                                        dist::common::stream_label(stream));
+        }
+        counter->inc();
+        ++shed_total;
+    };
+    registry.gauge_callback("dist_extractor_in_flight_frames",
+                            "Frames submitted to the worker pool and not yet published",
+                            [&pool] { return static_cast<double>(pool.in_flight()); });
+    const dist::common::CallbackFreeze freeze_callbacks{"dist_extractor_"};
+    // Only a broadcast stream in arrival order is contiguous; ids missing from it were
+    // dropped upstream (SUB high-water mark), shed here or failed (frames_failed_total).
+    // Frame ids count per stream, so each stream is tracked on its own.
+    const bool track_gaps = !push_pull && config.extractor.ordered_output;
+    dist::common::StreamGaps gaps{registry,
+                                  "dist_extractor_input_gap_frames_total",
+                                  "Frame ids missing from the ordered input stream"};
+    auto& failed = registry.counter("dist_extractor_frames_failed_total",
+                                    "Frames dropped as malformed, oversized or on error");
+    dist::common::BenchReport bench;
+    dist::common::MetricsServer metrics_server{
+        context, config.extractor.metrics_endpoint, registry};
+    metrics_server.start();
+
+    // Attempt to publish a processed frame without blocking; false if downstream has no
+    // room. Parts stay in `frame` so a retry from `pending` shares the same buffers.
+    const auto send_frame = [&](ProcessedFrame& frame) -> bool {
+        try {
+            const bool sent =
+                shm ? shm->send(publisher, frame.parts, zmq::send_flags::dontwait)
+                    : dist::common::send_parts(publisher, frame.parts, zmq::send_flags::dontwait);
+            if (!sent) {
+                return false;
+            }
+            published.inc();
+            if (bench_mode) {
+                bench.record(frame.trace);
+            }
+            return true;
+        } catch (const zmq::error_t& ex) {
+            spdlog::error("Failed to publish processed frame: {}", ex.what());
+            return false;
+        }
+    };
+
+    const auto flush_pending = [&] {
+        while (!pending.empty() && subscriber_monitor->has_subscriber()) {
+            auto* queued = pending.front();
+            if (queued == nullptr || !send_frame(*queued)) {
+                break;
+            }
+            pending.pop_front();
+        }
+    };
+
+    // Output stage: publish a finished frame unless older ones are still parked.
+    const auto publish = [&](ProcessedFrame&& processed) {
+        if (track_gaps) {
+            gaps.observe(processed.stream, processed.frame_id);
+        }
+        if (pending.empty() && subscriber_monitor->has_subscriber() && send_frame(processed)) {
+            return;
+        }
+        spdlog::debug("Queueing processed {} frame {} until the logger has room",
+                      processed.stream,
+                      processed.frame_id);
+        std::size_t bytes = 0;
+        for (const auto& part : processed.parts) {
+            bytes += part.size();
+        }
+        // Overlays are the first thing to give up under the priority policy.
+        const int priority = processed.annotated ? 0 : 1;
+        if (const auto lost = pending.push(std::move(processed), bytes, priority)) {
+            spdlog::warn("Extractor queue full ({} frames, {} MB held); dropped {} frame(s) ({})",
+                         pending.size(),
+                         pending.memory_bytes() / (1024 * 1024),
+                         lost,
+                         dist::common::to_string(*drop_policy));
+            dropped.inc(lost);
+        }
+    };
+
+    // Hand queued frames to the pool, one stream at a time, while workers have room.
+    const auto feed_pool = [&] {
+        while (pool.has_capacity() && !inbound.empty()) {
+            auto [stream, frame] = std::move(*inbound.pop());
+            pool.submit(std::move(stream),
+                        std::move(frame.header),
+                        std::move(frame.image),
+                        frame.received_ns);
+        }
+    };
+
+    // Input stage: take one [topic][header][image] frame off the socket and queue it
+    // under its stream.
+    const auto receive_frame = [&] {
+        zmq::message_t topic_msg;
+        zmq::message_t header_msg;
+        zmq::message_t image_msg;
+        try {
+            if (!subscriber.recv(topic_msg, zmq::recv_flags::dontwait)) {
+                return;
+            }
+            // Multipart messages arrive whole, so the remaining parts are already here.
+            const auto stream = dist::common::stream_from_topic(topic_msg.to_string_view());
+            if (!stream) {
+                spdlog::warn("Discarding message without a stream topic");
+                discard_remaining(subscriber, topic_msg.more());
+                return;
+            }
+            if (!topic_msg.more() || !subscriber.recv(header_msg, zmq::recv_flags::none) ||
+                !header_msg.more()) {
+                spdlog::warn("Discarding message without payload part");
+                return;
+            }
+            if (!subscriber.recv(image_msg, zmq::recv_flags::none)) {
+                spdlog::warn("Incomplete multipart message (missing payload)");
+                return;
+            }
+            if (shm_input) {
+                auto mapped = dist::common::shm_reader().resolve(std::move(image_msg));
+                if (!mapped) {
+                    spdlog::warn("Shared-memory payload was reused before it was read; dropping frame");
+                    failed.inc();
+                    return;
+                }
+                image_msg = std::move(*mapped);
+            }
+            last_input = std::chrono::steady_clock::now();
+            received.inc();
+            InboundFrame frame{
+                std::move(header_msg), std::move(image_msg), dist::common::trace_clock_ns()};
+            if (inbound.push(*stream, std::move(frame))) {
+                count_shed(*stream);
+            }
+        } catch (const zmq::error_t& ex) {
+            if (g_keep_running.load()) {
+                spdlog::error("ZeroMQ receive error: {}", ex.what());
+            }
+            reactor.stop();
+            return;
+        }
+        feed_pool();
+    };
+
+    // Everything runs off one reactor: input is read only while the output backlog has
+    // room (a stalled logger pushes back on the generator), parked frames go out when the
+    // output socket turns writable, and workers and the subscriber monitor wake the loop
+    // instead of it polling on a short timeout. A SUB keeps reading while the pool is busy
+    // so the per-stream queues, not the socket's shared high-water mark, decide what is
+    // dropped; a PULL reads only when a worker is free so peers keep their share.
+    const auto input_id = reactor.add_socket(subscriber, ZMQ_POLLIN, receive_frame);
+    const auto output_id = reactor.add_socket(publisher, 0, flush_pending);
+    pool.on_result([&reactor] { reactor.wake(); });
+    reactor.on_wake([&] {
+        flush_pending();
+        while (auto processed = pool.try_pop()) {
+            publish(std::move(*processed));
+        }
+    });
+    bool reported_blocked = false;
+    reactor.on_prepare([&] {
+        const bool has_subscriber = subscriber_monitor->has_subscriber();
+        if (!pending.empty() && !reported_blocked) {
+            spdlog::warn("Downstream {} on {}; holding processed frames",
+                         has_subscriber ? "not keeping up" : "absent",
+                         config.extractor.pub_endpoint);
+        }
+        reported_blocked = !pending.empty();
+        pending_depth.set(static_cast<double>(pending.size()));
+        pending_bytes.set(static_cast<double>(pending.memory_bytes()));
+        feed_pool();
+        const bool accept_input = (push_pull ? pool.has_capacity() && inbound.empty() : true) &&
+                                  !pending.full();
+        reactor.set_events(input_id, accept_input ? ZMQ_POLLIN : 0);
+        reactor.set_events(output_id, has_subscriber && !pending.empty() ? ZMQ_POLLOUT : 0);
+    });
+    // Periodically log if upstream is silent to aid debugging.
+    reactor.add_timer(kWaitLogInterval, [&] {
+        if (pool.in_flight() == 0 && pending.empty() && inbound.empty() &&
+            std::chrono::steady_clock::now() - last_input >= kWaitLogInterval) {
+            spdlog::info("Waiting for frames on {}", config.extractor.sub_endpoint);
+        }
+    });
+
+    if (bench_mode) {
+        // The run is over once frames stopped arriving and everything received went out.
+        reactor.add_timer(std::chrono::milliseconds(500), [&] {
+            if (received.value() > 0 && pool.in_flight() == 0 && pending.empty() &&
+                inbound.empty() &&
+                std::chrono::steady_clock::now() - last_input >= kBenchIdleExit) {
+                reactor.stop();
+            }
+        });
+    }
+
+    try {
+        reactor.run(g_keep_running);
+    } catch (const zmq::error_t& ex) {
+        if (g_keep_running.load()) {
+            spdlog::error("ZeroMQ poll error: {}", ex.what());
+        }
+    }
+
+    pool.stop();
+    metrics_server.stop();
+    if (bench_mode) {
+        // Shed frames already show up as gaps when gaps are tracked.
+        bench.log_summary("extractor",
+                          dropped.value() + failed.value() +
+                              (track_gaps ? gaps.total() : shed_total));
+    }
+
+    // Tear down sockets in the opposite order of creation.
+    spdlog::info("Feature extractor shutting down");
+    subscriber_monitor->stop();
+    monitor_guard.monitor = nullptr;
+    subscriber_monitor.reset();  // Destroy monitor before tearing down ZeroMQ to avoid shutdown hang.
+    publisher.close();
+    subscriber.close();
+    if (own_context) {
+        own_context->close();
+    }
+    spdlog::info("Feature extractor cleanup complete.");
+    return 0;
+}
+
+void request_stop() {
+    g_keep_running.store(false);
+}
+
+}  // namespace dist::feature_extractor
@@ -0,0 +1,119 @@
+#include "worker_pool.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include "dist/common/metrics.hpp"
+#include "dist/common/stream.hpp"
+
+#include <exception>
+#include <utility>
+
+namespace dist::feature_extractor {
+
+WorkerPool::WorkerPool(const dist::common::FeatureExtractorConfig& config,
+                       AnnotationSettings annotation,
+                       std::size_t workers,
+                       bool ordered)
+    : config_(config),
+      annotation_(annotation),
+      ordered_(ordered),
+      capacity_(workers * 2),
+      input_(capacity_) {
+    if (config_.reuse_cache_mb > 0) {
+        cache_ = std::make_shared<FeatureCache>(
+            static_cast<std::size_t>(config_.reuse_cache_mb) * 1024 * 1024,
+            config_.reuse_diff_threshold);
+    }
+    threads_.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        threads_.emplace_back([this, i]() { run(i); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    stop();
+}
+
+bool WorkerPool::submit(std::string stream,
+                        zmq::message_t header_msg,
+                        zmq::message_t image_msg,
+                        std::int64_t received_ns) {
+    Job job;
+    job.seq = next_submit_seq_++;
+    job.stream = std::move(stream);
+    job.header = std::move(header_msg);
+    job.image = std::move(image_msg);
+    job.received_ns = received_ns;
+    in_flight_.fetch_add(1);
+    if (!input_.push(std::move(job))) {
+        in_flight_.fetch_sub(1);
+        return false;
+    }
+    return true;
+}
+
+std::optional<ProcessedFrame> WorkerPool::try_pop() {
+    std::lock_guard lock(results_mutex_);
+    while (!results_.empty()) {
+        // Ordered mode waits for the oldest outstanding frame; unordered takes any.
+        auto it = ordered_ ? results_.find(next_emit_seq_) : results_.begin();
+        if (it == results_.end()) {
+            return std::nullopt;
+        }
+        std::optional<ProcessedFrame> result = std::move(it->second);
+        next_emit_seq_ = it->first + 1;
+        results_.erase(it);
+        in_flight_.fetch_sub(1);
+        if (result) {
+            return result;
+        }
+    }
+    return std::nullopt;
+}
+
+void WorkerPool::stop() {
+    input_.close();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void WorkerPool::run(std::size_t index) {
+    // Every worker builds its own detector; OpenCV detector instances are not shared.
+    FrameProcessor processor{config_, annotation_, cache_};
+    auto& registry = dist::common::metrics();
+    auto& processed = registry.counter("dist_extractor_frames_processed_total",
+                                       "Frames decoded, detected and serialized");
+    auto& failed = registry.counter("dist_extractor_frames_failed_total",
+                                    "Frames dropped as malformed, oversized or on error");
+    spdlog::debug("Extractor worker {} started", index);
+
+    while (auto job = input_.pop()) {
+        std::optional<ProcessedFrame> result;
+        try {
+            result = processor.process(
+                std::move(job->header), std::move(job->image), job->received_ns);
+        } catch (const std::exception& ex) {
+            spdlog::warn("Worker {} failed to process frame: {}", index, ex.what());
+        }
+        (result ? processed : failed).inc();
+        if (result) {
+            // Results keep their stream's topic so the logger can subscribe per stream.
+            result->stream = std::move(job->stream);
+            result->parts.insert(result->parts.begin(),
+                                 zmq::message_t(dist::common::stream_topic(result->stream)));
+        }
+        {
+            std::lock_guard lock(results_mutex_);
+            results_.emplace(job->seq, std::move(result));
+        }
+        if (on_result_) {
+            on_result_();
+        }
+    }
+    spdlog::debug("Extractor worker {} stopped", index);
+}
+
+}  // namespace dist::feature_extractor
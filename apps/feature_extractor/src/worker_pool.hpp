@@ -0,0 +1,89 @@
+#pragma once
+
+#include <zmq.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "dist/common/bounded_queue.hpp"
+#include "dist/common/config.hpp"
+#include "feature_cache.hpp"
+#include "frame_processor.hpp"
+
+namespace dist::feature_extractor {
+
+// Fans received frames out to N threads, each with its own FrameProcessor (sharing one
+// FeatureCache when FEATURE_EXTRACTOR_REUSE_CACHE_MB is set), and hands results back to
+// the socket-owning thread in arrival order (ordered mode) or completion order.
+class WorkerPool {
+  public:
+    WorkerPool(const dist::common::FeatureExtractorConfig& config,
+               AnnotationSettings annotation,
+               std::size_t workers,
+               bool ordered);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Called from a worker thread after each frame finishes (e.g. Reactor::wake).
+    // Set before the first submit().
+    void on_result(std::function<void()> callback) { on_result_ = std::move(callback); }
+
+    // Queue a frame of `stream`; blocks while every worker is busy and the input queue is
+    // full. `received_ns` is when it came off the socket (TraceStage::receive).
+    bool submit(std::string stream,
+                zmq::message_t header_msg,
+                zmq::message_t image_msg,
+                std::int64_t received_ns);
+
+    // True while submit() would not block (in-flight work below the input capacity).
+    [[nodiscard]] bool has_capacity() const { return in_flight_.load() < capacity_; }
+
+    // Next finished frame, if any. Dropped frames are skipped transparently.
+    [[nodiscard]] std::optional<ProcessedFrame> try_pop();
+
+    // Frames submitted but not yet returned through try_pop().
+    [[nodiscard]] std::size_t in_flight() const { return in_flight_.load(); }
+
+    void stop();
+
+  private:
+    struct Job {
+        std::uint64_t seq = 0;
+        std::string stream;
+        zmq::message_t header;
+        zmq::message_t image;
+        std::int64_t received_ns = 0;  // TraceStage::receive, taken on the socket thread
+    };
+
+    void run(std::size_t index);
+
+    const dist::common::FeatureExtractorConfig config_;
+    const AnnotationSettings annotation_;
+    const bool ordered_;
+    const std::size_t capacity_;
+    std::shared_ptr<FeatureCache> cache_;
+    dist::common::BoundedQueue<Job> input_;
+    std::vector<std::thread> threads_;
+
+    std::mutex results_mutex_;
+    // Completed work keyed by sequence; nullopt marks a frame the worker dropped.
+    std::map<std::uint64_t, std::optional<ProcessedFrame>> results_;
+    std::uint64_t next_submit_seq_ = 0;
+    std::uint64_t next_emit_seq_ = 0;
+    std::atomic<std::size_t> in_flight_{0};
+    std::function<void()> on_result_;
+};
+
+}  // namespace dist::feature_extractor
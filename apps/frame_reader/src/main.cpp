@@ -0,0 +1,194 @@
+#include <CLI/CLI.hpp>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include "dist/common/config.hpp"
+#include "dist/common/env_loader.hpp"
+#include "dist/common/image_encoding.hpp"
+#include "dist/common/segment_store.hpp"
+#include "dist/common/stream.hpp"
+#include "dist/common/utils.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct StoredFrame {
+    std::string encoding;
+    std::string image_path;
+    std::optional<dist::common::SegmentLocation> location;
+};
+
+// Shared logic to honor CLI flags, env overrides, and repo defaults.
+fs::path resolve_env_path(const std::string& cli_env_path,
+                          const char* env_override,
+                          const fs::path& root) {
+    if (!cli_env_path.empty()) {
+        return cli_env_path;
+    }
+    if (env_override != nullptr) {
+        return env_override;
+    }
+    return root / ".env";
+}
+
+std::string column_text(sqlite3_stmt* stmt, int column) {
+    const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+    return text != nullptr ? text : "";
+}
+
+// Latest row for frame_id within `stream` (frame ids count per stream and repeat across
+// generator restarts). Rows from before schema v6 have no stream_id and belong to the
+// default stream; `IS ?` keeps both lookups on idx_frames_stream_frame.
+std::optional<StoredFrame> find_frame(sqlite3* db,
+                                      const std::string& stream,
+                                      std::int64_t frame_id,
+                                      bool annotated) {
+    const std::string sql =
+        annotated ? "SELECT encoding, '', annotated_segment, annotated_offset, annotated_length "
+                    "FROM frames WHERE stream_id IS ? AND frame_id = ? ORDER BY id DESC LIMIT 1;"
+                  : "SELECT encoding, image_path, image_segment, image_offset, image_length "
+                    "FROM frames WHERE stream_id IS ? AND frame_id = ? ORDER BY id DESC LIMIT 1;";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        spdlog::error("Failed to query frames: {}", sqlite3_errmsg(db));
+        return std::nullopt;
+    }
+    sqlite3_bind_text(stmt, 1, stream.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 2, frame_id);
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_DONE && stream == dist::common::kDefaultStream) {
+        sqlite3_reset(stmt);
+        sqlite3_bind_null(stmt, 1);
+        rc = sqlite3_step(stmt);
+    }
+
+    std::optional<StoredFrame> found;
+    if (rc == SQLITE_ROW) {
+        StoredFrame frame;
+        frame.encoding = column_text(stmt, 0);
+        frame.image_path = column_text(stmt, 1);
+        if (sqlite3_column_type(stmt, 2) != SQLITE_NULL) {
+            dist::common::SegmentLocation location;
+            location.segment_id = static_cast<std::uint32_t>(sqlite3_column_int64(stmt, 2));
+            location.offset = static_cast<std::uint64_t>(sqlite3_column_int64(stmt, 3));
+            location.length = static_cast<std::uint64_t>(sqlite3_column_int64(stmt, 4));
+            frame.location = location;
+        }
+        found = std::move(frame);
+    }
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    CLI::App app{"Frame Reader - extracts logged frames from segment storage"};
+    std::string cli_env_path;
+    std::string cli_log_level;
+    std::int64_t frame_id = -1;
+    std::string stream{dist::common::kDefaultStream};
+    bool annotated = false;
+    std::string out_path;
+    app.add_option("--env", cli_env_path, "Path to the .env file (overrides DIST_ENV_PATH)");
+    app.add_option("--log-level", cli_log_level,
+                   "Override log level (trace|debug|info|warn|error|critical)");
+    app.add_option("--frame-id", frame_id, "Frame to extract")->required();
+    app.add_option("--stream", stream, "Stream the frame belongs to (default: default)");
+    app.add_flag("--annotated", annotated, "Extract the annotated overlay instead of the raw frame");
+    app.add_option("--out", out_path,
+                   "Output file ('-' for stdout; default frame_<id>[_annotated].<ext>)");
+
+    CLI11_PARSE(app, argc, argv);
+
+    // Logs go to stderr so `--out -` output can be piped.
+    spdlog::set_default_logger(spdlog::stderr_color_mt("frame_reader"));
+
+    dist::common::EnvLoader loader;
+    const auto root = fs::current_path();
+    const fs::path env_path = resolve_env_path(cli_env_path, std::getenv("DIST_ENV_PATH"), root);
+    if (!loader.load_from_file(env_path) && !loader.load_from_env()) {
+        spdlog::error("No configuration could be loaded. Provide a .env file or pass --env.");
+        return 1;
+    }
+    const auto config = dist::common::load_app_config(loader, root);
+    spdlog::set_level(dist::common::level_from_string(
+        cli_log_level.empty() ? config.global.log_level : cli_log_level));
+
+    if (!dist::common::valid_stream_id(stream)) {
+        spdlog::error("Invalid stream id '{}'", stream);
+        return 1;
+    }
+
+    sqlite3* db = nullptr;
+    if (sqlite3_open_v2(config.logger.db_path.string().c_str(), &db, SQLITE_OPEN_READONLY, nullptr) !=
+        SQLITE_OK) {
+        spdlog::error("Unable to open database at {}: {}",
+                      config.logger.db_path.string(),
+                      db != nullptr ? sqlite3_errmsg(db) : "out of memory");
+        sqlite3_close(db);
+        return 1;
+    }
+    const auto frame = find_frame(db, stream, frame_id, annotated);
+    sqlite3_close(db);
+
+    if (!frame) {
+        spdlog::error("Frame {} of stream {} is not in {}",
+                      frame_id,
+                      stream,
+                      config.logger.db_path.string());
+        return 1;
+    }
+    if (!frame->location) {
+        if (!frame->image_path.empty()) {
+            spdlog::error("Frame {} was logged as a file: {}", frame_id, frame->image_path);
+        } else {
+            spdlog::error("Frame {} has no {} payload in segment storage",
+                          frame_id,
+                          annotated ? "annotated" : "raw");
+        }
+        return 1;
+    }
+
+    // The span points straight into the mapped segment; it is written out without a copy.
+    dist::common::SegmentReader reader{config.logger.segment_dir};
+    const auto payload = reader.read(*frame->location);
+    if (!payload) {
+        spdlog::error("Segment {} does not hold frame {} at offset {}",
+                      frame->location->segment_id,
+                      frame_id,
+                      frame->location->offset);
+        return 1;
+    }
+
+    if (out_path == "-") {
+        std::cout.write(reinterpret_cast<const char*>(payload->data()),
+                        static_cast<std::streamsize>(payload->size()));
+        return std::cout ? 0 : 1;
+    }
+    if (out_path.empty()) {
+        out_path = "frame_" + std::to_string(frame_id) + (annotated ? "_annotated.png" : "");
+        if (!annotated) {
+            out_path += dist::common::extension_for_encoding(frame->encoding);
+        }
+    }
+    std::ofstream out(out_path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(payload->data()),
+              static_cast<std::streamsize>(payload->size()));
+    if (!out) {
+        spdlog::error("Failed to write {}", out_path);
+        return 1;
+    }
+    spdlog::info("Wrote frame {} ({} bytes) to {}", frame_id, payload->size(), out_path);
+    return 0;
+}
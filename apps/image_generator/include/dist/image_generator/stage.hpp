@@ -0,0 +1,15 @@
+#pragma once
+
+#include "dist/common/stage.hpp"
+
+namespace dist::image_generator {
+
+// Image generator: publishes the dataset (or --bench frames) until it is done or
+// request_stop(), taking the same command line as the `image_generator` binary. Runs once per
+// process; returns the exit status.
+int run(int argc, char** argv, const dist::common::StageRuntime& runtime = {});
+
+// Stop publishing (thread-safe).
+void request_stop();
+
+}  // namespace dist::image_generator
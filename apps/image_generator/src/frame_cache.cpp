@@ -0,0 +1,158 @@
+#include "frame_cache.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace dist::image_generator {
+
+namespace {
+constexpr std::size_t kSpillChunkBytes = 256 * 1024 * 1024;  // One mapping per 256 MB of spill
+}  // namespace
+
+FrameCache::FrameCache(Mode mode, std::size_t memory_budget_bytes, fs::path spill_dir)
+    : mode_(mode), memory_budget_bytes_(memory_budget_bytes), spill_dir_(std::move(spill_dir)) {
+#if defined(_WIN32)
+    if (mode_ == Mode::disk) {
+        spdlog::warn("Disk-backed frame cache is not supported on this platform; using memory mode");
+        mode_ = Mode::memory;
+    }
+#endif
+}
+
+FrameCache::~FrameCache() {
+#if !defined(_WIN32)
+    for (const auto& chunk : chunks_) {
+        ::munmap(chunk.base, chunk.capacity);
+    }
+#endif
+}
+
+std::optional<FrameCache::Mode> FrameCache::parse_mode(std::string_view value) {
+    if (value == "off" || value == "none") {
+        return Mode::off;
+    }
+    if (value == "memory") {
+        return Mode::memory;
+    }
+    if (value == "disk" || value == "mmap") {
+        return Mode::disk;
+    }
+    return std::nullopt;
+}
+
+const CachedFrame* FrameCache::find(const fs::path& path) const {
+    if (mode_ == Mode::off) {
+        return nullptr;
+    }
+    std::lock_guard lock(mutex_);
+    if (auto it = entries_.find(path.string()); it != entries_.end()) {
+        return &it->second.frame;
+    }
+    return nullptr;
+}
+
+const CachedFrame* FrameCache::insert(const fs::path& path,
+                                      const CachedFrame& info,
+                                      std::vector<std::uint8_t>& encoded) {
+    if (mode_ == Mode::off) {
+        return nullptr;
+    }
+
+    std::lock_guard lock(mutex_);
+    Entry entry;
+    entry.frame = info;
+    entry.frame.size = encoded.size();
+
+    if (memory_bytes_ + encoded.size() <= memory_budget_bytes_) {
+        memory_bytes_ += encoded.size();
+        // An exact-size copy keeps the budget honest; the caller recycles the (pooled,
+        // often oversized) encode buffer. Vector storage survives the move into the map
+        // node, so the view stays valid.
+        entry.heap.assign(encoded.begin(), encoded.end());
+        entry.frame.data = entry.heap.data();
+    } else if (mode_ == Mode::disk) {
+        entry.frame.data = spill(encoded);
+        if (entry.frame.data == nullptr) {
+            return nullptr;
+        }
+        disk_bytes_ += encoded.size();
+    } else {
+        return nullptr;
+    }
+
+    auto [it, inserted] = entries_.insert_or_assign(path.string(), std::move(entry));
+    (void)inserted;
+    return &it->second.frame;
+}
+
+std::uint8_t* FrameCache::spill(const std::vector<std::uint8_t>& encoded) {
+    if (spill_failed_) {
+        return nullptr;
+    }
+    if (chunks_.empty() || chunks_.back().capacity - chunks_.back().used < encoded.size()) {
+        if (!open_chunk(encoded.size())) {
+            spill_failed_ = true;
+            return nullptr;
+        }
+    }
+    auto& chunk = chunks_.back();
+    std::uint8_t* dst = chunk.base + chunk.used;
+    std::memcpy(dst, encoded.data(), encoded.size());
+    chunk.used += encoded.size();
+    return dst;
+}
+
+bool FrameCache::open_chunk(std::size_t min_bytes) {
+#if defined(_WIN32)
+    (void)min_bytes;
+    return false;
+#else
+    std::error_code ec;
+    fs::create_directories(spill_dir_, ec);
+    if (ec) {
+        spdlog::warn("Unable to create frame cache directory {}: {}", spill_dir_.string(), ec.message());
+        return false;
+    }
+
+    const std::size_t capacity = std::max(kSpillChunkBytes, min_bytes);
+    const fs::path chunk_path = spill_dir_ / ("frame_cache_" + std::to_string(::getpid()) + "_" +
+                                              std::to_string(chunks_.size()) + ".bin");
+    const int fd = ::open(chunk_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        spdlog::warn("Unable to create frame cache spill file {}: {}",
+                     chunk_path.string(),
+                     std::strerror(errno));
+        return false;
+    }
+    // Unlink right away: the mapping keeps the data alive and nothing is left behind on exit.
+    ::unlink(chunk_path.c_str());
+    if (::ftruncate(fd, static_cast<off_t>(capacity)) != 0) {
+        spdlog::warn("Unable to size frame cache spill file: {}", std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    void* base = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        spdlog::warn("Unable to map frame cache spill file: {}", std::strerror(errno));
+        return false;
+    }
+    chunks_.push_back({static_cast<std::uint8_t*>(base), capacity, 0});
+    return true;
+#endif
+}
+
+}  // namespace dist::image_generator
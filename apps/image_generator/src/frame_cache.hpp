@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dist::image_generator {
+
+// Encoded payload plus the header fields that never change between loops.
+struct CachedFrame {
+    std::string filename;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::string encoding;
+    // Pixel layout, only meaningful for encoding == "raw".
+    int cv_type = -1;
+    std::size_t step = 0;
+    std::string compression = "none";
+    std::size_t raw_bytes = 0;  // Uncompressed buffer size
+    const std::uint8_t* data = nullptr;  // Stable for the lifetime of the owning cache.
+    std::size_t size = 0;
+};
+
+// Holds encoded frames so later loops skip imread + imencode entirely.
+// Frames are kept on the heap up to the memory budget; in disk mode the
+// overflow is appended to mmap'd spill chunks that the kernel can page out.
+// find() may be called from prefetch threads while the publisher inserts.
+class FrameCache {
+  public:
+    enum class Mode { off, memory, disk };
+
+    FrameCache(Mode mode, std::size_t memory_budget_bytes, std::filesystem::path spill_dir);
+    ~FrameCache();
+
+    FrameCache(const FrameCache&) = delete;
+    FrameCache& operator=(const FrameCache&) = delete;
+
+    // Map the IMAGE_GENERATOR_CACHE_MODE string onto a mode (nullopt if unknown).
+    [[nodiscard]] static std::optional<Mode> parse_mode(std::string_view value);
+
+    [[nodiscard]] const CachedFrame* find(const std::filesystem::path& path) const;
+
+    // Retain a copy of a freshly encoded frame; `encoded` is left to the caller to
+    // recycle. nullptr means the frame was not cached (budget exhausted).
+    const CachedFrame* insert(const std::filesystem::path& path,
+                              const CachedFrame& info,
+                              std::vector<std::uint8_t>& encoded);
+
+    [[nodiscard]] std::size_t size() const { return entries_.size(); }
+    [[nodiscard]] std::size_t memory_bytes() const { return memory_bytes_; }
+    [[nodiscard]] std::size_t disk_bytes() const { return disk_bytes_; }
+
+  private:
+    struct Entry {
+        CachedFrame frame;
+        std::vector<std::uint8_t> heap;  // Empty when the payload lives in a spill chunk.
+    };
+
+    struct SpillChunk {
+        std::uint8_t* base = nullptr;
+        std::size_t capacity = 0;
+        std::size_t used = 0;
+    };
+
+    std::uint8_t* spill(const std::vector<std::uint8_t>& encoded);
+    bool open_chunk(std::size_t min_bytes);
+
+    mutable std::mutex mutex_;
+    Mode mode_;
+    std::size_t memory_budget_bytes_;
+    std::filesystem::path spill_dir_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::vector<SpillChunk> chunks_;
+    std::size_t memory_bytes_ = 0;
+    std::size_t disk_bytes_ = 0;
+    bool spill_failed_ = false;
+};
+
+}  // namespace dist::image_generator
@@ -0,0 +1,133 @@
+#include "image_probe.hpp"
+
+#include <cstdlib>
+
+namespace dist::image_generator {
+
+namespace {
+
+std::uint32_t read_be32(const std::uint8_t* p) {
+    return (static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16) |
+           (static_cast<std::uint32_t>(p[2]) << 8) | static_cast<std::uint32_t>(p[3]);
+}
+
+std::uint16_t read_be16(const std::uint8_t* p) {
+    return static_cast<std::uint16_t>((p[0] << 8) | p[1]);
+}
+
+std::uint32_t read_le32(const std::uint8_t* p) {
+    return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+           (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+std::uint16_t read_le16(const std::uint8_t* p) {
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+std::optional<ImageProbe> probe_png(const std::uint8_t* data, std::size_t size) {
+    // Signature (8) + IHDR length (4) + "IHDR" (4) + width/height (8) + depth/color (2).
+    if (size < 26 || data[12] != 'I' || data[13] != 'H' || data[14] != 'D' || data[15] != 'R') {
+        return std::nullopt;
+    }
+    ImageProbe probe;
+    probe.encoding = "png";
+    probe.width = static_cast<int>(read_be32(data + 16));
+    probe.height = static_cast<int>(read_be32(data + 20));
+    switch (data[25]) {
+        case 0:
+            probe.channels = 1;  // grayscale
+            break;
+        case 4:
+            probe.channels = 2;  // grayscale + alpha
+            break;
+        case 6:
+            probe.channels = 4;  // RGBA
+            break;
+        default:
+            probe.channels = 3;  // RGB or palette
+            break;
+    }
+    return probe;
+}
+
+std::optional<ImageProbe> probe_jpeg(const std::uint8_t* data, std::size_t size) {
+    // Walk marker segments until the first start-of-frame header.
+    std::size_t pos = 2;
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xFF) {
+            return std::nullopt;
+        }
+        const std::uint8_t marker = data[pos + 1];
+        if (marker == 0xFF) {
+            ++pos;  // fill byte
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            pos += 2;  // standalone markers carry no length
+            continue;
+        }
+        const std::size_t length = read_be16(data + pos + 2);
+        const bool is_sof = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 &&
+                            marker != 0xC8 && marker != 0xCC;
+        if (is_sof) {
+            if (pos + 10 > size) {
+                return std::nullopt;
+            }
+            ImageProbe probe;
+            probe.encoding = "jpeg";
+            probe.height = read_be16(data + pos + 5);
+            probe.width = read_be16(data + pos + 7);
+            probe.channels = data[pos + 9];
+            return probe;
+        }
+        if (marker == 0xDA || length < 2) {
+            return std::nullopt;  // reached scan data without a frame header
+        }
+        pos += 2 + length;
+    }
+    return std::nullopt;
+}
+
+std::optional<ImageProbe> probe_bmp(const std::uint8_t* data, std::size_t size) {
+    if (size < 26) {
+        return std::nullopt;
+    }
+    const std::uint32_t dib_size = read_le32(data + 14);
+    ImageProbe probe;
+    probe.encoding = "bmp";
+    std::uint16_t bit_count = 0;
+    if (dib_size == 12) {
+        // BITMAPCOREHEADER uses 16-bit dimensions.
+        probe.width = read_le16(data + 18);
+        probe.height = read_le16(data + 20);
+        bit_count = read_le16(data + 24);
+    } else if (dib_size >= 40 && size >= 30) {
+        probe.width = static_cast<int>(read_le32(data + 18));
+        probe.height = std::abs(static_cast<int>(read_le32(data + 22)));  // negative = top-down
+        bit_count = read_le16(data + 28);
+    } else {
+        return std::nullopt;
+    }
+    probe.channels = bit_count == 32 ? 4 : 3;  // palette and 16-bit images decode to BGR
+    return probe;
+}
+
+}  // namespace
+
+std::optional<ImageProbe> probe_image(const std::uint8_t* data, std::size_t size) {
+    if (data == nullptr || size < 4) {
+        return std::nullopt;
+    }
+    if (size >= 8 && data[0] == 0x89 && data[1] == 'P' && data[2] == 'N' && data[3] == 'G') {
+        return probe_png(data, size);
+    }
+    if (data[0] == 0xFF && data[1] == 0xD8) {
+        return probe_jpeg(data, size);
+    }
+    if (data[0] == 'B' && data[1] == 'M') {
+        return probe_bmp(data, size);
+    }
+    return std::nullopt;
+}
+
+}  // namespace dist::image_generator
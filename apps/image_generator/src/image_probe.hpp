@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace dist::image_generator {
+
+// Dimensions recovered from a container header without decoding pixels.
+struct ImageProbe {
+    std::string encoding;  // "png", "jpeg" or "bmp"
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+};
+
+// Parse PNG IHDR, JPEG SOFn or BMP DIB headers. Returns nullopt for other
+// formats (e.g. TIFF) or truncated/corrupt headers.
+[[nodiscard]] std::optional<ImageProbe> probe_image(const std::uint8_t* data, std::size_t size);
+
+}  // namespace dist::image_generator
@@ -0,0 +1,354 @@
+#include "image_source.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <system_error>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace dist::image_generator {
+
+namespace {
+
+struct SnapshotSource final : ImageSource {
+    SnapshotSource(std::vector<fs::path> paths, std::size_t passes)
+        : paths_(std::move(paths)), passes_(passes) {}
+
+    std::optional<SourceImage> next(std::chrono::milliseconds) override {
+        if (exhausted()) {
+            return std::nullopt;
+        }
+        SourceImage image{paths_[index_], pass_};
+        if (++index_ == paths_.size()) {
+            index_ = 0;
+            ++pass_;
+        }
+        return image;
+    }
+
+    [[nodiscard]] bool exhausted() const override { return passes_ != 0 && pass_ >= passes_; }
+    [[nodiscard]] std::size_t pass_size() const override { return paths_.size(); }
+
+    std::vector<fs::path> paths_;
+    std::size_t passes_;
+    std::size_t index_ = 0;
+    std::size_t pass_ = 0;
+};
+
+// Keeps only the open directory handle, so a multi-million-file directory costs nothing
+// up front; the price is directory (not name) order.
+struct LazySource final : ImageSource {
+    LazySource(fs::path dir, std::size_t passes) : dir_(std::move(dir)), passes_(passes) {
+        rewind();
+    }
+
+    std::optional<SourceImage> next(std::chrono::milliseconds) override {
+        while (!exhausted()) {
+            if (it_ == fs::directory_iterator()) {
+                if (emitted_ == 0) {
+                    spdlog::warn("No readable images found under {}", dir_.string());
+                    exhausted_ = true;  // A pass with no images would just spin
+                    break;
+                }
+                ++pass_;
+                rewind();
+                continue;
+            }
+            const fs::directory_entry entry = *it_;
+            std::error_code ec;
+            it_.increment(ec);
+            if (ec) {
+                spdlog::warn("Stopped listing {}: {}", dir_.string(), ec.message());
+                it_ = fs::directory_iterator();
+            }
+            if (entry.is_regular_file(ec) && is_image_file(entry.path())) {
+                ++emitted_;
+                return SourceImage{entry.path(), pass_};
+            }
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] bool exhausted() const override {
+        return exhausted_ || (passes_ != 0 && pass_ >= passes_);
+    }
+
+    void rewind() {
+        std::error_code ec;
+        it_ = fs::directory_iterator(dir_, ec);
+        emitted_ = 0;
+    }
+
+    fs::path dir_;
+    std::size_t passes_;
+    fs::directory_iterator it_;
+    std::size_t emitted_ = 0;
+    std::size_t pass_ = 0;
+    bool exhausted_ = false;
+};
+
+#if defined(__linux__)
+// Existing files first (lazily, as above), then whatever inotify reports. IN_CLOSE_WRITE
+// catches writers that create the file in place; IN_MOVED_TO catches the usual
+// write-to-temp-then-rename. The watch is registered before the listing starts, so a
+// file landing mid-listing may be reported twice; those are filtered out.
+struct WatchSource final : ImageSource {
+    WatchSource(fs::path dir, int fd, bool follow)
+        : dir_(std::move(dir)), fd_(fd), follow_(follow) {
+        std::error_code ec;
+        backlog_ = fs::directory_iterator(dir_, ec);
+        watch_start_ = fs::file_time_type::clock::now();
+    }
+
+    ~WatchSource() override { ::close(fd_); }
+
+    std::optional<SourceImage> next(std::chrono::milliseconds timeout) override {
+        while (backlog_ != fs::directory_iterator()) {
+            const fs::directory_entry entry = *backlog_;
+            std::error_code ec;
+            backlog_.increment(ec);
+            if (ec) {
+                backlog_ = fs::directory_iterator();
+            }
+            if (!entry.is_regular_file(ec) || !is_image_file(entry.path())) {
+                continue;
+            }
+            // Only files touched since the watch began can also have an event queued.
+            if (entry.last_write_time(ec) >= watch_start_) {
+                listed_.insert(entry.path().filename().string());
+            }
+            return SourceImage{entry.path(), 0};
+        }
+
+        if (!follow_) {
+            exhausted_ = true;  // --once: the files already there, then stop
+        }
+        if (ready_.empty() && !exhausted_) {
+            read_events(timeout);
+        }
+        if (ready_.empty()) {
+            return std::nullopt;
+        }
+        SourceImage image{std::move(ready_.front()), 0};
+        ready_.pop_front();
+        return image;
+    }
+
+    [[nodiscard]] bool exhausted() const override { return exhausted_ && ready_.empty(); }
+
+    void read_events(std::chrono::milliseconds timeout) {
+        pollfd item{fd_, POLLIN, 0};
+        const int rc = ::poll(&item, 1, static_cast<int>(timeout.count()));
+        if (rc <= 0) {
+            // Events raised during the listing were queued before it ended, so once the
+            // queue has drained the duplicates are gone.
+            listed_.clear();
+            return;
+        }
+
+        alignas(inotify_event) std::array<char, 64 * 1024> buffer{};
+        const auto bytes = ::read(fd_, buffer.data(), buffer.size());
+        if (bytes <= 0) {
+            return;
+        }
+        for (std::size_t offset = 0; offset < static_cast<std::size_t>(bytes);) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if ((event->mask & IN_Q_OVERFLOW) != 0) {
+                spdlog::warn("inotify queue overflowed on {}; some new images were missed",
+                             dir_.string());
+                continue;
+            }
+            if ((event->mask & (IN_IGNORED | IN_DELETE_SELF)) != 0) {
+                spdlog::warn("Watched directory {} went away", dir_.string());
+                exhausted_ = true;
+                continue;
+            }
+            if (event->len == 0 || (event->mask & IN_ISDIR) != 0) {
+                continue;
+            }
+            const std::string name(event->name);
+            if (listed_.erase(name) > 0) {
+                continue;
+            }
+            fs::path path = dir_ / name;
+            if (is_image_file(path)) {
+                ready_.push_back(std::move(path));
+            }
+        }
+    }
+
+    fs::path dir_;
+    int fd_;
+    bool follow_;
+    fs::directory_iterator backlog_;
+    fs::file_time_type watch_start_;
+    std::unordered_set<std::string> listed_;
+    std::deque<fs::path> ready_;
+    bool exhausted_ = false;
+};
+#endif
+
+struct RoundRobinSource final : ImageSource {
+    explicit RoundRobinSource(std::vector<std::unique_ptr<ImageSource>> sources)
+        : sources_(std::move(sources)) {}
+
+    std::optional<SourceImage> next(std::chrono::milliseconds timeout) override {
+        // One non-blocking sweep first; only an idle round waits, split across sources.
+        const auto idle_wait =
+            timeout / static_cast<std::chrono::milliseconds::rep>(sources_.size());
+        for (const auto wait : {std::chrono::milliseconds(0), idle_wait}) {
+            for (std::size_t i = 0; i < sources_.size(); ++i) {
+                const std::size_t index = (turn_ + i) % sources_.size();
+                if (sources_[index]->exhausted()) {
+                    continue;
+                }
+                if (auto image = sources_[index]->next(wait)) {
+                    image->stream = index;
+                    turn_ = index + 1;
+                    return image;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] bool exhausted() const override {
+        return std::all_of(sources_.begin(), sources_.end(), [](const auto& source) {
+            return source->exhausted();
+        });
+    }
+
+    [[nodiscard]] std::size_t pass_size() const override {
+        std::size_t total = 0;
+        for (const auto& source : sources_) {
+            if (source->pass_size() == 0) {
+                return 0;
+            }
+            total += source->pass_size();
+        }
+        return total;
+    }
+
+    std::vector<std::unique_ptr<ImageSource>> sources_;
+    std::size_t turn_ = 0;
+};
+
+std::vector<fs::path> collect_images(const fs::path& dir) {
+    std::vector<fs::path> images;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        if (entry.is_regular_file(ec) && is_image_file(entry.path())) {
+            images.push_back(entry.path());
+        }
+    }
+    std::sort(images.begin(), images.end());
+    return images;
+}
+
+}  // namespace
+
+std::optional<SourceMode> parse_source_mode(std::string_view value) {
+    if (value == "snapshot") {
+        return SourceMode::snapshot;
+    }
+    if (value == "lazy") {
+        return SourceMode::lazy;
+    }
+    if (value == "watch" || value == "inotify") {
+        return SourceMode::watch;
+    }
+    return std::nullopt;
+}
+
+std::string_view to_string(SourceMode mode) {
+    switch (mode) {
+        case SourceMode::snapshot:
+            return "snapshot";
+        case SourceMode::lazy:
+            return "lazy";
+        case SourceMode::watch:
+            return "watch";
+    }
+    return "snapshot";
+}
+
+bool is_image_file(const fs::path& path) {
+    static constexpr std::array<std::string_view, 6> kExtensions{
+        ".png", ".jpg", ".jpeg", ".bmp", ".tif", ".tiff"};
+    const auto ext = path.extension().string();
+    return std::any_of(kExtensions.begin(), kExtensions.end(), [&](std::string_view e) {
+        return ext.size() == e.size() &&
+               std::equal(ext.begin(), ext.end(), e.begin(), [](char a, char b) {
+                   return std::tolower(static_cast<unsigned char>(a)) == b;
+               });
+    });
+}
+
+std::unique_ptr<ImageSource> make_image_source(SourceMode mode,
+                                               const fs::path& dir,
+                                               std::size_t passes) {
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) {
+        return nullptr;
+    }
+
+    if (mode == SourceMode::watch) {
+#if defined(__linux__)
+        const int fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd >= 0 &&
+            ::inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE_SELF) >=
+                0) {
+            return std::make_unique<WatchSource>(dir, fd, passes == 0);
+        }
+        spdlog::warn("Unable to watch {}: {}; using a snapshot", dir.string(), std::strerror(errno));
+        if (fd >= 0) {
+            ::close(fd);
+        }
+#else
+        spdlog::warn("Directory watching needs inotify (Linux); using a snapshot");
+#endif
+        mode = SourceMode::snapshot;
+    }
+
+    if (mode == SourceMode::lazy) {
+        auto source = std::make_unique<LazySource>(dir, passes);
+        if (source->it_ == fs::directory_iterator()) {
+            return nullptr;
+        }
+        return source;
+    }
+
+    auto images = collect_images(dir);
+    if (images.empty()) {
+        return nullptr;
+    }
+    return std::make_unique<SnapshotSource>(std::move(images), passes);
+}
+
+std::unique_ptr<ImageSource> make_round_robin_source(
+    std::vector<std::unique_ptr<ImageSource>> sources) {
+    if (sources.size() == 1) {
+        return std::move(sources.front());
+    }
+    return std::make_unique<RoundRobinSource>(std::move(sources));
+}
+
+}  // namespace dist::image_generator
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace dist::image_generator {
+
+// Where the generator's images come from (IMAGE_GENERATOR_SOURCE_MODE):
+//   snapshot - sorted listing taken once at startup, replayed every loop;
+//   lazy     - the directory is re-walked each loop in directory order, never held in memory;
+//   watch    - existing files once, then new files as inotify reports them (live ingest).
+enum class SourceMode { snapshot, lazy, watch };
+
+[[nodiscard]] std::optional<SourceMode> parse_source_mode(std::string_view value);
+[[nodiscard]] std::string_view to_string(SourceMode mode);
+
+// True for the extensions the generator publishes (.png, .jpg, ...), case-insensitive.
+[[nodiscard]] bool is_image_file(const std::filesystem::path& path);
+
+struct SourceImage {
+    std::filesystem::path path;
+    std::size_t pass = 0;    // Loop iteration the image belongs to
+    std::size_t stream = 0;  // Index of the source in a round-robin merge
+};
+
+// Pull-based stream of image paths. Not thread-safe; the prefetcher serializes calls.
+class ImageSource {
+  public:
+    virtual ~ImageSource() = default;
+
+    // The next image, waiting up to `timeout` for one to appear. nullopt on timeout or
+    // once exhausted().
+    virtual std::optional<SourceImage> next(std::chrono::milliseconds timeout) = 0;
+
+    // No further images will ever be returned.
+    [[nodiscard]] virtual bool exhausted() const = 0;
+
+    // Images per pass when known up front (snapshot), else 0.
+    [[nodiscard]] virtual std::size_t pass_size() const { return 0; }
+};
+
+// `passes` = 0 loops forever; watch never loops, and with `passes` != 0 stops after the
+// files already present. Returns nullptr when
+// the directory has no images to start from and the mode cannot wait for more.
+[[nodiscard]] std::unique_ptr<ImageSource> make_image_source(SourceMode mode,
+                                                             const std::filesystem::path& dir,
+                                                             std::size_t passes);
+
+// Interleaves several sources one image at a time (tagging each with its index), so a
+// camera with a deep backlog cannot hold back the others. Exhausted once all are.
+[[nodiscard]] std::unique_ptr<ImageSource> make_round_robin_source(
+    std::vector<std::unique_ptr<ImageSource>> sources);
+
+}  // namespace dist::image_generator
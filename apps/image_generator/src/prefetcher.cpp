@@ -0,0 +1,156 @@
+#include "prefetcher.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "dist/common/buffer_pool.hpp"
+
+namespace dist::image_generator {
+
+namespace {
+constexpr auto kSourcePoll = std::chrono::milliseconds(250);  // Re-check for stop while idle
+}  // namespace
+
+Prefetcher::Prefetcher(ImageSource& source,
+                       std::size_t threads,
+                       std::size_t depth,
+                       Loader loader,
+                       Skip skip)
+    : source_(source),
+      threads_(threads),
+      // A ring longer than one pass would load loop n + 1 before loop n fills the cache.
+      depth_(std::clamp<std::size_t>(
+          depth,
+          1,
+          source.pass_size() > 0 ? source.pass_size() : std::max<std::size_t>(depth, 1))),
+      loader_(std::move(loader)),
+      skip_(std::move(skip)),
+      ring_(depth_) {}
+
+Prefetcher::~Prefetcher() {
+    stop();
+}
+
+void Prefetcher::start() {
+    for (std::size_t i = 0; i < threads_; ++i) {
+        workers_.emplace_back([this]() { worker_loop(); });
+    }
+}
+
+void Prefetcher::stop() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    slot_free_.notify_all();
+    slot_ready_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+}
+
+std::optional<PrefetchedFrame> Prefetcher::next(std::chrono::milliseconds timeout) {
+    if (threads_ == 0) {
+        std::lock_guard source_lock(source_mutex_);
+        if (auto image = source_.next(timeout)) {
+            std::lock_guard lock(mutex_);
+            ++next_take_;
+            return load(std::move(*image));
+        }
+        if (source_.exhausted()) {
+            std::lock_guard lock(mutex_);
+            end_ = next_take_;
+        }
+        return std::nullopt;
+    }
+
+    std::unique_lock lock(mutex_);
+    auto& slot = ring_[next_take_ % depth_];
+    const bool ready = slot_ready_.wait_for(lock, timeout, [&] {
+        return stopping_ || next_take_ >= end_ || slot.frame.has_value();
+    });
+    if (!ready || stopping_ || !slot.frame) {
+        return std::nullopt;
+    }
+    auto frame = std::move(slot.frame);
+    slot.frame.reset();
+    ++next_take_;
+    lock.unlock();
+    slot_free_.notify_all();
+    return frame;
+}
+
+bool Prefetcher::done() {
+    std::lock_guard lock(mutex_);
+    return next_take_ >= end_;
+}
+
+void Prefetcher::worker_loop() {
+    while (true) {
+        std::size_t sequence = 0;
+        std::optional<SourceImage> image;
+        {
+            // Holding the source lock across the pull keeps paths and sequence numbers in
+            // the same order; the other workers have nothing to claim meanwhile anyway.
+            std::lock_guard source_lock(source_mutex_);
+            {
+                // Never claim more than `depth` ahead of the publisher, which bounds memory
+                // and guarantees the claimed slot is free.
+                std::unique_lock lock(mutex_);
+                slot_free_.wait(lock, [&] {
+                    return stopping_ || next_claim_ >= end_ || next_claim_ < next_take_ + depth_;
+                });
+                if (stopping_ || next_claim_ >= end_) {
+                    return;
+                }
+            }
+
+            image = source_.next(kSourcePoll);
+            std::lock_guard lock(mutex_);
+            if (!image) {
+                if (source_.exhausted()) {
+                    end_ = next_claim_;
+                    slot_ready_.notify_all();
+                    slot_free_.notify_all();
+                }
+                continue;
+            }
+            sequence = next_claim_++;
+        }
+
+        auto frame = load(std::move(*image));
+
+        {
+            std::lock_guard lock(mutex_);
+            ring_[sequence % depth_].frame = std::move(frame);
+        }
+        slot_ready_.notify_all();
+    }
+}
+
+PrefetchedFrame Prefetcher::load(SourceImage image) const {
+    PrefetchedFrame frame;
+    frame.path = std::move(image.path);
+    frame.pass = image.pass;
+    frame.stream = image.stream;
+    if (skip_ && skip_(frame.path)) {
+        return frame;
+    }
+    frame.encoded = dist::common::buffer_pool().acquire();
+    const auto start = std::chrono::steady_clock::now();
+    frame.frame = loader_(frame.path, frame.encoded, frame.trace);
+    frame.load_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (frame.frame) {
+        // The loader filled `encoded` in place; keep the view on the vector that travels.
+        frame.frame->data = frame.encoded.data();
+        frame.frame->size = frame.encoded.size();
+        frame.trace.mark(dist::common::TraceStage::encode);
+    }
+    return frame;
+}
+
+}  // namespace dist::image_generator
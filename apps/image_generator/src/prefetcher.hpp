@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "dist/common/trace.hpp"
+#include "frame_cache.hpp"
+#include "image_source.hpp"
+
+namespace dist::image_generator {
+
+// One image as handed to the publisher, in source order.
+struct PrefetchedFrame {
+    std::filesystem::path path;
+    std::size_t pass = 0;
+    std::size_t stream = 0;
+    // Empty when the load failed or was skipped (already cached); `data` points into `encoded`.
+    std::optional<CachedFrame> frame;
+    std::vector<std::uint8_t> encoded;
+    dist::common::FrameTrace trace;
+    double load_seconds = 0.0;
+};
+
+// Reads and encodes upcoming images on worker threads so disk and codec latency overlap
+// with sending. Workers pull paths from the source and claim sequence numbers under one
+// lock, then fill a ring of `depth` slots; next() hands frames back strictly in
+// sequence, so frame ids keep source order however the loads finish.
+class Prefetcher {
+  public:
+    using Loader = std::function<std::optional<CachedFrame>(
+        const std::filesystem::path&, std::vector<std::uint8_t>&, dist::common::FrameTrace&)>;
+    // True for paths that need no load (e.g. already in the frame cache). Called from
+    // the worker threads.
+    using Skip = std::function<bool(const std::filesystem::path&)>;
+
+    // `threads` = 0 loads inline in next(), which is the old serial behaviour.
+    Prefetcher(ImageSource& source,
+               std::size_t threads,
+               std::size_t depth,
+               Loader loader,
+               Skip skip);
+    ~Prefetcher();
+
+    Prefetcher(const Prefetcher&) = delete;
+    Prefetcher& operator=(const Prefetcher&) = delete;
+
+    void start();
+    void stop();
+
+    // The next frame in sequence, waiting up to `timeout`; nullopt on timeout, once
+    // stopped, or when the source is done (see done()).
+    std::optional<PrefetchedFrame> next(std::chrono::milliseconds timeout);
+
+    // Every frame the source will produce has been returned.
+    [[nodiscard]] bool done();
+
+  private:
+    struct Slot {
+        std::optional<PrefetchedFrame> frame;  // Set while ready and not yet taken
+    };
+
+    void worker_loop();
+    PrefetchedFrame load(SourceImage image) const;
+
+    ImageSource& source_;
+    const std::size_t threads_;
+    const std::size_t depth_;
+    Loader loader_;
+    Skip skip_;
+
+    std::mutex source_mutex_;  // Serializes source_.next() with the sequence it is given
+    std::mutex mutex_;
+    std::condition_variable slot_free_;
+    std::condition_variable slot_ready_;
+    std::vector<Slot> ring_;
+    std::size_t next_claim_ = 0;
+    std::size_t next_take_ = 0;
+    std::size_t end_ = std::numeric_limits<std::size_t>::max();  // Set once the source runs dry
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+}  // namespace dist::image_generator
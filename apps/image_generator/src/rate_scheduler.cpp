@@ -0,0 +1,48 @@
+#include "rate_scheduler.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace dist::image_generator {
+
+RateScheduler::RateScheduler(double fps, int burst) : fps_(std::max(fps, 0.0)) {
+    window_start_ = Clock::now();
+    if (fps_ <= 0.0) {
+        return;
+    }
+    interval_ = std::max(
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps_)),
+        Clock::duration(1));
+    burst_allowance_ = interval_ * (std::max(burst, 1) - 1);
+}
+
+void RateScheduler::wait() {
+    ++window_frames_;
+    if (!enabled()) {
+        return;
+    }
+    auto now = Clock::now();
+    if (!started_) {
+        theoretical_arrival_ = now;
+        started_ = true;
+    }
+    // Conforming once the schedule is at most `burst - 1` intervals ahead of now.
+    const auto earliest = theoretical_arrival_ - burst_allowance_;
+    if (now < earliest) {
+        std::this_thread::sleep_until(earliest);
+        now = earliest;  // Wake-up latency is not lateness; the schedule stays exact
+    }
+    // Idle time earns at most `burst` frames of credit; a longer stall is not replayed.
+    theoretical_arrival_ = std::max(theoretical_arrival_, now) + interval_;
+}
+
+double RateScheduler::take_actual_fps() {
+    const auto now = Clock::now();
+    const double seconds = std::chrono::duration<double>(now - window_start_).count();
+    const double fps = seconds > 0.0 ? static_cast<double>(window_frames_) / seconds : 0.0;
+    window_frames_ = 0;
+    window_start_ = now;
+    return fps;
+}
+
+}  // namespace dist::image_generator
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace dist::image_generator {
+
+// Paces sends to an absolute rate with a token bucket, implemented as a virtual
+// schedule (GCRA): frame n is due at start + n / fps, and up to `burst` frames may go
+// early to catch up after a stall. Deadlines advance from the schedule rather than from
+// when the last send finished, so encode time and sleep overshoot do not drift the rate.
+class RateScheduler {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // `fps` <= 0 disables pacing (wait() returns immediately); `burst` is at least 1.
+    RateScheduler(double fps, int burst);
+
+    [[nodiscard]] bool enabled() const { return interval_.count() > 0; }
+    [[nodiscard]] double target_fps() const { return fps_; }
+
+    // Sleep until the next frame may be sent, then claim its slot.
+    void wait();
+
+    // Frames per second sent since the previous call (or construction).
+    [[nodiscard]] double take_actual_fps();
+
+  private:
+    double fps_ = 0.0;
+    Clock::duration interval_{};
+    Clock::duration burst_allowance_{};  // (burst - 1) intervals of credit
+    Clock::time_point theoretical_arrival_{};
+    bool started_ = false;
+    std::uint64_t window_frames_ = 0;
+    Clock::time_point window_start_;
+};
+
+}  // namespace dist::image_generator
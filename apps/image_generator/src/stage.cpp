@@ -0,0 +1,990 @@
+#include "dist/image_generator/stage.hpp"
+
+#include <CLI/CLI.hpp>
+#include <nlohmann/json.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+#include <zmq.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "dist/common/buffer_pool.hpp"
+#include "dist/common/compression.hpp"
+#include "dist/common/config.hpp"
+#include "dist/common/distribution.hpp"
+#include "dist/common/env_loader.hpp"
+#include "dist/common/image_encoding.hpp"
+#include "dist/common/metrics.hpp"
+#include "dist/common/pending_queue.hpp"
+#include "dist/common/shm_transport.hpp"
+#include "dist/common/stream.hpp"
+#include "dist/common/subscriber_monitor.hpp"
+#include "dist/common/trace.hpp"
+#include "dist/common/utils.hpp"
+#include "dist/common/version.hpp"
+#include "dist/common/zmq_message.hpp"
+#include "dist/features/synthetic.hpp"
+#include "frame_cache.hpp"
+#include "image_probe.hpp"
+#include "image_source.hpp"
+#include "prefetcher.hpp"
+#include "rate_scheduler.hpp"
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+using dist::common::SubscriberMonitor;
+using dist::image_generator::CachedFrame;
+using dist::image_generator::FrameCache;
+using dist::image_generator::Prefetcher;
+using dist::image_generator::RateScheduler;
+
+namespace {
+
+std::atomic_bool g_keep_running{true};
+constexpr std::size_t kMaxPayloadBytes = 50 * 1024 * 1024;  // 50 MB safety cap
+constexpr auto kSendWait = 500ms;  // Longest wait for downstream before a frame is queued
+constexpr auto kSourceIdleWait = 250ms;  // Wait for a new image before tending the backlog
+constexpr std::size_t kDefaultQueueDepth = 100;
+constexpr int kPushHighWaterMark = 2;  // Keep per-extractor backlog short so idle peers win
+constexpr int kZmqRetryAttempts = 3;
+constexpr auto kZmqRetryBackoff = 1s;
+
+// Registered on first use; the references stay valid for the life of the process.
+struct GeneratorMetrics {
+    dist::common::Counter& sent;
+    dist::common::Counter& queued;
+    dist::common::Counter& dropped;
+    dist::common::Counter& bytes_sent;
+    dist::common::Gauge& pending;
+    dist::common::Gauge& pending_bytes;
+    dist::common::Histogram& load_seconds;
+    dist::common::Histogram& payload_bytes;
+};
+
+GeneratorMetrics& generator_metrics() {
+    auto& registry = dist::common::metrics();
+    static GeneratorMetrics metrics{
+        registry.counter("dist_generator_frames_sent_total", "Frames handed to the socket"),
+        registry.counter("dist_generator_frames_queued_total",
+                         "Frames queued because downstream had no room"),
+        registry.counter("dist_generator_frames_dropped_total",
+                         "Queued frames dropped because the pending queue was full"),
+        registry.counter("dist_generator_bytes_sent_total", "Payload bytes handed to the socket"),
+        registry.gauge("dist_generator_pending_frames", "Frames waiting in the pending queue"),
+        registry.gauge("dist_generator_pending_bytes",
+                       "Payload memory held by the pending queue (spilled frames excluded)"),
+        registry.histogram("dist_generator_load_seconds",
+                           "Read + encode time of frames not served from the cache",
+                           dist::common::latency_buckets()),
+        registry.histogram("dist_generator_payload_bytes",
+                           "Payload part size per published frame",
+                           dist::common::byte_buckets()),
+    };
+    return metrics;
+}
+
+enum class PublishMode { reencode, passthrough, raw };
+
+// --bench: synthetic frames built in memory, published as fast as downstream accepts
+// them (or at `fps`), `count` times, with no disk reads and no loop delay.
+struct BenchOptions {
+    bool enabled = false;
+    int width = 1920;
+    int height = 1080;
+    double fps = 0.0;  // 0 = unpaced
+    std::size_t count = 1000;
+};
+constexpr int kBenchVariants = 8;  // Distinct images cycled so detectors see varied content
+
+// A synthetic frame and the payload bytes it is published with.
+struct BenchFrame {
+    CachedFrame info;
+    std::vector<uchar> payload;
+};
+
+std::optional<PublishMode> parse_publish_mode(std::string_view value) {
+    if (value == "reencode") {
+        return PublishMode::reencode;
+    }
+    if (value == "passthrough") {
+        return PublishMode::passthrough;
+    }
+    if (value == "raw") {
+        return PublishMode::raw;
+    }
+    return std::nullopt;
+}
+
+bool bind_with_retry(zmq::socket_t& socket, const std::string& endpoint) {
+    for (int attempt = 1; attempt <= kZmqRetryAttempts; ++attempt) {
+        try {
+            socket.bind(endpoint);
+            return true;
+        } catch (const zmq::error_t& ex) {
+            spdlog::error(
+                "Unable to bind output socket to {} (attempt {}/{}): {}. Is another instance running "
+                "on this endpoint?",
+                endpoint,
+                attempt,
+                kZmqRetryAttempts,
+                ex.what());
+            if (attempt == kZmqRetryAttempts) {
+                break;
+            }
+            std::this_thread::sleep_for(kZmqRetryBackoff);
+        }
+    }
+    return false;
+}
+
+// A frame as it goes on the wire: [stream topic][header][payload].
+struct OutgoingFrame {
+    std::vector<zmq::message_t> parts;
+};
+
+OutgoingFrame make_outgoing(zmq::message_t topic, zmq::message_t header, zmq::message_t payload) {
+    OutgoingFrame frame;
+    frame.parts.reserve(3);
+    frame.parts.push_back(std::move(topic));
+    frame.parts.push_back(std::move(header));
+    frame.parts.push_back(std::move(payload));
+    return frame;
+}
+
+// Non-blocking multipart send; false when the socket has no room (or no peer) for it.
+// Once the first part is queued ZeroMQ delivers the rest atomically. With `shm` the
+// payload goes through its ring and the frame stays intact for another attempt.
+bool try_send(zmq::socket_t& socket, OutgoingFrame& frame, dist::common::ShmWriter* shm) {
+    auto& parts = frame.parts;
+    const auto payload_bytes = parts.back().size();
+    if (shm != nullptr) {
+        if (!shm->send(socket, parts, zmq::send_flags::dontwait)) {
+            return false;
+        }
+    } else {
+        if (!socket.send(parts.front(), zmq::send_flags::dontwait | zmq::send_flags::sndmore)) {
+            return false;
+        }
+        for (std::size_t i = 1; i < parts.size(); ++i) {
+            socket.send(parts[i], i + 1 == parts.size() ? zmq::send_flags::none
+                                                        : zmq::send_flags::sndmore);
+        }
+    }
+    auto& metrics = generator_metrics();
+    metrics.sent.inc();
+    metrics.bytes_sent.inc(payload_bytes);
+    return true;
+}
+
+// Block until `socket` can take a frame or `timeout` passes. A missing subscriber is
+// waited out on the monitor; PUSH then reports POLLOUT once an extractor has room, so
+// publishing resumes the moment downstream catches up.
+bool wait_writable(zmq::socket_t& socket,
+                   SubscriberMonitor& monitor,
+                   std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    if (!monitor.has_subscriber() && !monitor.wait_for_subscriber(timeout)) {
+        return false;
+    }
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    zmq::pollitem_t items[] = {{socket.handle(), 0, ZMQ_POLLOUT, 0}};
+    zmq::poll(items, 1, std::max(remaining, std::chrono::milliseconds(0)));
+    return (items[0].revents & ZMQ_POLLOUT) != 0;
+}
+
+// Whole file into `bytes`; false (logged) when it cannot be read.
+bool read_file(const fs::path& image_path, std::vector<uchar>& bytes) {
+    std::error_code ec;
+    const auto file_size = fs::file_size(image_path, ec);
+    std::ifstream in(image_path, std::ios::binary);
+    if (ec || !in.good()) {
+        spdlog::warn("Failed to read image {}", image_path.string());
+        return false;
+    }
+    bytes.resize(static_cast<std::size_t>(file_size));
+    if (!in.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(file_size))) {
+        spdlog::warn("Short read on image {}", image_path.string());
+        return false;
+    }
+    return true;
+}
+
+// Read the file, then decode it; `read` is stamped in between so the decode lands in
+// the "encode" span with the codec work that follows rather than before the first stamp.
+cv::Mat read_and_decode(const fs::path& image_path, dist::common::FrameTrace& trace) {
+    std::vector<uchar> source;
+    if (!read_file(image_path, source)) {
+        return {};
+    }
+    trace.mark(dist::common::TraceStage::read);
+    auto frame = cv::imdecode(source, cv::IMREAD_COLOR);
+    if (frame.empty()) {
+        spdlog::warn("Failed to decode image {}", image_path.string());
+    }
+    return frame;
+}
+
+// Decode + PNG-encode a frame from disk; the heavy step the cache lets later loops skip.
+std::optional<CachedFrame> encode_frame(const fs::path& image_path,
+                                        std::vector<uchar>& encoded,
+                                        dist::common::FrameTrace& trace) {
+    const auto frame = read_and_decode(image_path, trace);
+    if (frame.empty()) {
+        return std::nullopt;
+    }
+    if (!cv::imencode(".png", frame, encoded)) {
+        spdlog::warn("Failed to encode image {}", image_path.string());
+        return std::nullopt;
+    }
+
+    CachedFrame info;
+    info.filename = image_path.filename().string();
+    info.width = frame.cols;
+    info.height = frame.rows;
+    info.channels = frame.channels();
+    info.encoding = "png";
+    info.data = encoded.data();
+    info.size = encoded.size();
+    return info;
+}
+
+// Ship the decoded pixel buffer so neither side pays for a codec (LZ4 is optional).
+std::optional<CachedFrame> raw_frame(const fs::path& image_path,
+                                     dist::common::Compression compression,
+                                     std::vector<uchar>& encoded,
+                                     dist::common::FrameTrace& trace) {
+    auto frame = read_and_decode(image_path, trace);
+    if (frame.empty()) {
+        return std::nullopt;
+    }
+    if (!frame.isContinuous()) {
+        frame = frame.clone();
+    }
+    const std::size_t raw_bytes = frame.total() * frame.elemSize();
+    if (!dist::common::compress(compression, frame.data, raw_bytes, encoded)) {
+        spdlog::warn("Failed to {}-compress image {}",
+                     dist::common::to_string(compression),
+                     image_path.string());
+        return std::nullopt;
+    }
+
+    CachedFrame info;
+    info.filename = image_path.filename().string();
+    info.width = frame.cols;
+    info.height = frame.rows;
+    info.channels = frame.channels();
+    info.encoding = "raw";
+    info.cv_type = frame.type();
+    info.step = frame.step[0];
+    info.compression = std::string(dist::common::to_string(compression));
+    info.raw_bytes = raw_bytes;
+    info.data = encoded.data();
+    info.size = encoded.size();
+    return info;
+}
+
+// Publish the file's own bytes; dimensions come from the container header.
+std::optional<CachedFrame> read_source_frame(const fs::path& image_path,
+                                             std::vector<uchar>& encoded) {
+    if (!read_file(image_path, encoded)) {
+        return std::nullopt;
+    }
+
+    CachedFrame info;
+    info.filename = image_path.filename().string();
+    info.data = encoded.data();
+    info.size = encoded.size();
+    if (auto probe = dist::image_generator::probe_image(encoded.data(), encoded.size())) {
+        info.width = probe->width;
+        info.height = probe->height;
+        info.channels = probe->channels;
+        info.encoding = std::move(probe->encoding);
+        return info;
+    }
+
+    // Containers without a cheap header parser (TIFF) are decoded once for their dimensions.
+    const auto frame = cv::imdecode(encoded, cv::IMREAD_UNCHANGED);
+    const auto encoding =
+        dist::common::encoding_for_extension(image_path.extension().string());
+    if (frame.empty() || encoding.empty()) {
+        spdlog::warn("Failed to identify image {}", image_path.string());
+        return std::nullopt;
+    }
+    info.width = frame.cols;
+    info.height = frame.rows;
+    info.channels = frame.channels();
+    info.encoding = std::string(encoding);
+    return info;
+}
+
+std::vector<BenchFrame> make_bench_frames(const BenchOptions& options,
+                                          PublishMode mode,
+                                          dist::common::Compression compression) {
+    std::vector<BenchFrame> frames;
+    for (int i = 0; i < kBenchVariants; ++i) {
+        auto image = dist::features::synthetic_frame(
+            options.width, options.height, static_cast<std::uint64_t>(i) + 1);
+        BenchFrame frame;
+        frame.info.filename = "bench_" + std::to_string(i) + ".png";
+        frame.info.width = image.cols;
+        frame.info.height = image.rows;
+        frame.info.channels = image.channels();
+        if (mode == PublishMode::raw) {
+            const std::size_t raw_bytes = image.total() * image.elemSize();
+            if (!dist::common::compress(compression, image.data, raw_bytes, frame.payload)) {
+                return {};
+            }
+            frame.info.encoding = "raw";
+            frame.info.cv_type = image.type();
+            frame.info.step = image.step[0];
+            frame.info.compression = std::string(dist::common::to_string(compression));
+            frame.info.raw_bytes = raw_bytes;
+        } else if (cv::imencode(".png", image, frame.payload)) {
+            frame.info.encoding = "png";  // There is no source file to pass through
+        } else {
+            return {};
+        }
+        frame.info.data = frame.payload.data();
+        frame.info.size = frame.payload.size();
+        frames.push_back(std::move(frame));
+    }
+    return frames;
+}
+
+// Publish `options.count` synthetic frames, blocking on downstream instead of queueing
+// so the reported rate is what the pipeline sustains. Returns the number sent.
+std::size_t run_bench(zmq::socket_t& publisher,
+                      SubscriberMonitor& monitor,
+                      const std::vector<BenchFrame>& frames,
+                      const BenchOptions& options,
+                      RateScheduler& scheduler,
+                      dist::common::ShmWriter* shm) {
+    const auto start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration blocked{};
+    std::size_t sent = 0;
+    for (; sent < options.count && g_keep_running.load(); ++sent) {
+        const auto& frame = frames[sent % frames.size()].info;
+        scheduler.wait();
+        dist::common::FrameTrace trace;
+        trace.mark(dist::common::TraceStage::read);
+        trace.mark(dist::common::TraceStage::encode);
+        nlohmann::json header{
+            {"frame_id", sent},
+            {"loop_iteration", 0},
+            {"timestamp", dist::common::now_iso8601()},
+            {"filename", frame.filename},
+            {"width", frame.width},
+            {"height", frame.height},
+            {"channels", frame.channels},
+            {"encoding", frame.encoding},
+            {"bytes", frame.size},
+        };
+        if (frame.encoding == "raw") {
+            header["cv_type"] = frame.cv_type;
+            header["step"] = frame.step;
+            header["compression"] = frame.compression;
+            header["raw_bytes"] = frame.raw_bytes;
+        }
+        trace.mark(dist::common::TraceStage::send);
+        header["trace"] = dist::common::trace_to_json(trace);
+
+        auto outgoing =
+            make_outgoing(zmq::message_t(dist::common::stream_topic(dist::common::kDefaultStream)),
+                          zmq::message_t(header.dump()),
+                          dist::common::borrow_message(frame.data, frame.size));
+        const auto wait_start = std::chrono::steady_clock::now();
+        bool delivered = false;
+        while (!delivered && g_keep_running.load()) {
+            delivered = wait_writable(publisher, monitor, kSendWait) &&
+                        try_send(publisher, outgoing, shm);
+        }
+        blocked += std::chrono::steady_clock::now() - wait_start;
+        if (!delivered) {
+            break;
+        }
+    }
+
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    spdlog::info("[bench] generator: {} frames of {}x{} in {:.2f} s ({:.1f} fps), {:.2f} s "
+                 "blocked on downstream",
+                 sent,
+                 options.width,
+                 options.height,
+                 seconds,
+                 seconds > 0.0 ? static_cast<double>(sent) / seconds : 0.0,
+                 std::chrono::duration<double>(blocked).count());
+    return sent;
+}
+
+fs::path resolve_env_path(const std::string& cli_env_path,
+                          const char* env_override,
+                          const fs::path& root) {
+    if (!cli_env_path.empty()) {
+        return cli_env_path;
+    }
+    if (env_override != nullptr) {
+        return env_override;
+    }
+    return root / ".env";
+}
+
+void configure_logging(std::string_view level) {
+    spdlog::set_level(dist::common::level_from_string(level));
+    spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] %v");
+}
+
+}  // namespace
+
+namespace dist::image_generator {
+
+int run(int argc, char** argv, const dist::common::StageRuntime& runtime) {
+    CLI::App app{"Image Generator - publishes frames via ZeroMQ"};
+    std::string cli_env_path;
+    std::string cli_log_level;
+    bool run_once = false;
+    app.add_option("--env", cli_env_path, "Path to the .env file (overrides DIST_ENV_PATH)");
+    app.add_option("--log-level", cli_log_level, "Override log level (trace|debug|info|warn|error|critical)");
+    app.add_flag("--once", run_once, "Publish the dataset a single time instead of looping");
+    BenchOptions bench;
+    app.add_flag("--bench", bench.enabled, "Publish synthetic frames and report throughput");
+    app.add_option("--bench-width", bench.width, "Synthetic frame width (--bench)");
+    app.add_option("--bench-height", bench.height, "Synthetic frame height (--bench)");
+    app.add_option("--bench-fps", bench.fps, "Publish rate, 0 = as fast as accepted (--bench)");
+    app.add_option("--bench-frames", bench.count, "Frames to publish (--bench)");
+
+    CLI11_PARSE(app, argc, argv);
+
+    // Centralized configuration loading for a single source of truth.
+    dist::common::EnvLoader loader;
+    const auto root = fs::current_path();
+    const char* env_override = std::getenv("DIST_ENV_PATH");
+    fs::path env_path = resolve_env_path(cli_env_path, env_override, root);
+
+    if (!loader.load_from_file(env_path)) {
+        spdlog::warn("Failed to read environment file at {}. Falling back to process environment "
+                     "variables.",
+                     env_path.string());
+        if (!loader.load_from_env()) {
+            spdlog::error("No configuration could be loaded. Provide a .env file or pass variables "
+                          "via docker --env-file.");
+            return 1;
+        }
+    }
+
+    for (const auto& [key, value] : runtime.env_overrides) {
+        loader.set(key, value);
+    }
+    const auto config = dist::common::load_app_config(loader, root);
+    const auto resolved_level =
+        cli_log_level.empty() ? config.global.log_level : cli_log_level;
+
+    if (runtime.configure_process) {
+        configure_logging(resolved_level);
+    }
+
+    spdlog::info("[image_generator] Dist Imaging Services v{}", dist::common::version());
+    // Without IMAGE_GENERATOR_STREAMS the input directory is the one default stream.
+    auto streams = config.generator.streams;
+    if (streams.empty()) {
+        streams.push_back({std::string(dist::common::kDefaultStream), config.generator.input_dir});
+    }
+    for (std::size_t i = 0; i < streams.size(); ++i) {
+        const auto& id = streams[i].id;
+        if (!dist::common::valid_stream_id(id)) {
+            spdlog::error("IMAGE_GENERATOR_STREAMS: invalid stream id '{}'", id);
+            return 1;
+        }
+        for (std::size_t j = 0; j < i; ++j) {
+            if (streams[j].id == id) {
+                spdlog::error("IMAGE_GENERATOR_STREAMS: duplicate stream id '{}'", id);
+                return 1;
+            }
+        }
+        spdlog::info("Stream {}: {}", id, streams[i].input_dir.string());
+    }
+    spdlog::info("Publish endpoint: {}", config.generator.pub_endpoint);
+    if (config.generator.target_fps > 0.0) {
+        spdlog::info("Target rate: {} fps (burst {})",
+                     config.generator.target_fps,
+                     std::max(config.generator.burst, 1));
+    } else {
+        spdlog::info("Loop delay: {} ms", config.generator.loop_delay_ms);
+    }
+
+    std::size_t max_queue_depth = kDefaultQueueDepth;
+    if (config.generator.queue_depth > 0) {
+        max_queue_depth = static_cast<std::size_t>(config.generator.queue_depth);
+    } else {
+        spdlog::warn("IMAGE_GENERATOR_QUEUE_DEPTH={} is invalid; using default {}",
+                     config.generator.queue_depth,
+                     kDefaultQueueDepth);
+    }
+    auto drop_policy = dist::common::parse_drop_policy(config.generator.drop_policy);
+    if (!drop_policy) {
+        spdlog::warn("IMAGE_GENERATOR_DROP_POLICY={} is invalid; using oldest",
+                     config.generator.drop_policy);
+        drop_policy = dist::common::DropPolicy::oldest;
+    }
+    const dist::common::PendingLimits pending_limits{
+        max_queue_depth,
+        static_cast<std::size_t>(std::max(config.generator.queue_mb, 0)) * 1024 * 1024,
+        *drop_policy};
+    spdlog::info("Queue depth: {} frames, {} MB (drop {})",
+                 max_queue_depth,
+                 std::max(config.generator.queue_mb, 0),
+                 dist::common::to_string(*drop_policy));
+    std::optional<dist::common::SpillStore> spill;
+    if (!config.generator.spill_dir.empty()) {
+        try {
+            spill.emplace(config.generator.spill_dir,
+                          static_cast<std::size_t>(std::max(config.generator.spill_mb, 0)) *
+                              1024 * 1024);
+        } catch (const std::exception& ex) {
+            spdlog::error("{}", ex.what());
+            return 1;
+        }
+        spdlog::info("Queue spill: {} ({} MB)",
+                     config.generator.spill_dir.string(),
+                     config.generator.spill_mb);
+    }
+    if (runtime.configure_process) {
+        dist::common::buffer_pool().set_max_bytes(
+            static_cast<std::size_t>(std::max(config.generator.buffer_pool_mb, 0)) * 1024 * 1024);
+    }
+    std::optional<dist::common::ShmWriter> shm;
+    if (dist::common::is_shm_endpoint(config.generator.pub_endpoint)) {
+        try {
+            shm.emplace(config.generator.pub_endpoint,
+                        static_cast<std::size_t>(std::max(config.generator.shm_mb, 0)) * 1024 *
+                            1024);
+        } catch (const std::exception& ex) {
+            spdlog::error("{}", ex.what());
+            return 1;
+        }
+        spdlog::info("Payloads go through shared-memory segment {} ({} MB)",
+                     shm->segment(),
+                     config.generator.shm_mb);
+    }
+    dist::common::ShmWriter* shm_writer = shm ? &*shm : nullptr;
+
+    auto distribution = dist::common::parse_distribution(config.generator.distribution);
+    if (!distribution) {
+        spdlog::warn("IMAGE_GENERATOR_DISTRIBUTION={} is invalid; using pubsub",
+                     config.generator.distribution);
+        distribution = dist::common::Distribution::pubsub;
+    }
+    spdlog::info("Distribution: {}", dist::common::to_string(*distribution));
+
+    auto publish_mode = parse_publish_mode(config.generator.publish_mode);
+    if (!publish_mode) {
+        spdlog::warn("IMAGE_GENERATOR_PUBLISH_MODE={} is invalid; using reencode",
+                     config.generator.publish_mode);
+        publish_mode = PublishMode::reencode;
+    }
+    spdlog::info("Publish mode: {}", config.generator.publish_mode);
+
+    auto raw_compression = dist::common::parse_compression(config.generator.raw_compression);
+    if (!raw_compression || !dist::common::compression_available(*raw_compression)) {
+        spdlog::warn("IMAGE_GENERATOR_RAW_COMPRESSION={} is unavailable; sending raw frames "
+                     "uncompressed",
+                     config.generator.raw_compression);
+        raw_compression = dist::common::Compression::none;
+    }
+    if (*publish_mode == PublishMode::raw) {
+        spdlog::info("Raw compression: {}", dist::common::to_string(*raw_compression));
+    }
+
+    auto source_mode = dist::image_generator::parse_source_mode(config.generator.source_mode);
+    if (!source_mode) {
+        spdlog::warn("IMAGE_GENERATOR_SOURCE_MODE={} is invalid; using snapshot",
+                     config.generator.source_mode);
+        source_mode = dist::image_generator::SourceMode::snapshot;
+    }
+    spdlog::info("Image source: {}", dist::image_generator::to_string(*source_mode));
+
+    auto cache_mode = FrameCache::parse_mode(config.generator.cache_mode);
+    if (!cache_mode) {
+        spdlog::warn("IMAGE_GENERATOR_CACHE_MODE={} is invalid; using memory",
+                     config.generator.cache_mode);
+        cache_mode = FrameCache::Mode::memory;
+    }
+    if (*source_mode == dist::image_generator::SourceMode::watch &&
+        *cache_mode != FrameCache::Mode::off) {
+        spdlog::info("Frame cache disabled in watch mode: every frame is new");
+        cache_mode = FrameCache::Mode::off;
+    }
+    const auto cache_budget_bytes =
+        static_cast<std::size_t>(std::max(config.generator.cache_budget_mb, 0)) * 1024 * 1024;
+    FrameCache cache{*cache_mode, cache_budget_bytes, config.generator.cache_dir};
+    spdlog::info("Frame cache: {} ({} MB budget)",
+                 config.generator.cache_mode,
+                 config.generator.cache_budget_mb);
+    spdlog::info("Prefetch: {} threads, {} frames ahead",
+                 std::max(config.generator.prefetch_threads, 0),
+                 std::max(config.generator.prefetch_depth, 1));
+
+    struct MonitorGuard {
+        SubscriberMonitor* monitor = nullptr;
+        ~MonitorGuard() {
+            if (monitor != nullptr) {
+                monitor->stop();
+            }
+        }
+    };
+
+    // Track downstream subscribers so we can buffer intelligently.
+    auto monitor = std::make_unique<SubscriberMonitor>("inproc://pub_monitor");
+    MonitorGuard monitor_guard{monitor.get()};
+    // Open the image source up front so a missing directory fails early. Bench frames are
+    // declared here so payloads borrowed by queued messages outlive the socket.
+    std::unique_ptr<dist::image_generator::ImageSource> source;
+    std::vector<BenchFrame> bench_frames;
+    if (bench.enabled) {
+        bench_frames = make_bench_frames(bench, *publish_mode, *raw_compression);
+        if (bench_frames.empty()) {
+            spdlog::error("Failed to build synthetic {}x{} frames", bench.width, bench.height);
+            return 1;
+        }
+        spdlog::info("Bench mode: {} synthetic {}x{} frames ({} bytes each), {}",
+                     bench.count,
+                     bench.width,
+                     bench.height,
+                     bench_frames.front().info.size,
+                     bench.fps > 0.0 ? fmt::format("{} fps", bench.fps) : "unpaced");
+    } else {
+        // One source per camera, interleaved so every stream gets a fair share of the rate.
+        std::vector<std::unique_ptr<dist::image_generator::ImageSource>> stream_sources;
+        for (const auto& stream : streams) {
+            auto stream_source = dist::image_generator::make_image_source(
+                *source_mode, stream.input_dir, run_once ? 1 : 0);
+            if (!stream_source) {
+                spdlog::error("No readable images found under {}", stream.input_dir.string());
+                return 1;
+            }
+            stream_sources.push_back(std::move(stream_source));
+        }
+        source = dist::image_generator::make_round_robin_source(std::move(stream_sources));
+    }
+
+    if (runtime.handle_signals) {
+        dist::common::install_signal_handlers(g_keep_running);
+    }
+
+    // PUB (broadcast) or PUSH (load-balanced) socket drives the entire pipeline.
+    // A fused pipeline shares one context so inproc:// endpoints reach the other stages.
+    std::optional<zmq::context_t> own_context;
+    zmq::context_t& context =
+        runtime.context != nullptr ? *runtime.context : own_context.emplace(1);
+    zmq::socket_t publisher{context, dist::common::sender_socket_type(*distribution)};
+    // PUSH skips peers whose pipe is full, so a small HWM routes frames to spare capacity.
+    publisher.set(zmq::sockopt::sndhwm,
+                  *distribution == dist::common::Distribution::pushpull ? kPushHighWaterMark : 10);
+    if (!bind_with_retry(publisher, dist::common::zmq_endpoint(config.generator.pub_endpoint))) {
+        return 1;
+    }
+    monitor->start(publisher);
+    monitor_guard.monitor = monitor.get();
+
+    auto& metrics = generator_metrics();
+    dist::common::MetricsServer metrics_server{
+        context, config.generator.metrics_endpoint, dist::common::metrics()};
+    metrics_server.start();
+
+    if (config.generator.start_delay_ms > 0) {
+        spdlog::info("Waiting {} ms for subscribers to connect...",
+                     config.generator.start_delay_ms);
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.generator.start_delay_ms));
+    }
+    if (config.generator.subscriber_wait_ms > 0) {
+        spdlog::info("Waiting up to {} ms for at least one subscriber...",
+                     config.generator.subscriber_wait_ms);
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(config.generator.subscriber_wait_ms);
+        while (!monitor->has_subscriber() && std::chrono::steady_clock::now() < deadline &&
+               g_keep_running.load()) {
+            monitor->wait_for_subscriber(50ms);
+        }
+        if (!monitor->has_subscriber()) {
+            spdlog::warn("No subscribers detected before timeout; initial frames may be dropped");
+        } else {
+            spdlog::info("Subscriber detected, starting publish loop");
+        }
+    }
+
+    // Frame ids count per stream so each one is contiguous for gap tracking downstream.
+    std::vector<std::size_t> next_frame_id(streams.size(), 0);
+    std::vector<std::string> topics;
+    for (const auto& stream : streams) {
+        topics.emplace_back(dist::common::stream_topic(stream.id));
+    }
+    std::size_t frames_sent = 0;
+    std::size_t loop_iteration = 0;
+    const auto delay = std::chrono::milliseconds(config.generator.loop_delay_ms);
+    const auto heartbeat_interval = std::chrono::milliseconds(config.generator.heartbeat_ms);
+    auto last_heartbeat = std::chrono::steady_clock::now();
+    dist::common::PendingQueue<OutgoingFrame> pending_frames{pending_limits,
+                                                             spill ? &*spill : nullptr};
+    dist::common::metrics().gauge_callback(
+        "dist_generator_spill_lost_frames",
+        "Spilled frames that could not be read back",
+        [&pending_frames] { return static_cast<double>(pending_frames.lost()); });
+    const dist::common::CallbackFreeze freeze_callbacks{"dist_generator_"};
+
+    // --bench paces at --bench-fps alone so a configured target rate cannot skew a run.
+    RateScheduler scheduler(bench.enabled ? bench.fps : config.generator.target_fps,
+                            config.generator.burst);
+    if (bench.enabled) {
+        frames_sent = run_bench(publisher, *monitor, bench_frames, bench, scheduler, shm_writer);
+    }
+
+    // Cache misses are read and encoded ahead of the publisher on worker threads.
+    std::optional<Prefetcher> prefetcher;
+    if (!bench.enabled) {
+        prefetcher.emplace(
+            *source,
+            static_cast<std::size_t>(std::max(config.generator.prefetch_threads, 0)),
+            static_cast<std::size_t>(std::max(config.generator.prefetch_depth, 1)),
+            [&](const fs::path& path,
+                std::vector<uchar>& encoded,
+                dist::common::FrameTrace& trace) -> std::optional<CachedFrame> {
+                switch (*publish_mode) {
+                    case PublishMode::passthrough: {
+                        auto frame = read_source_frame(path, encoded);
+                        trace.mark(dist::common::TraceStage::read);
+                        return frame;
+                    }
+                    case PublishMode::raw:
+                        return raw_frame(path, *raw_compression, encoded, trace);
+                    case PublishMode::reencode:
+                        break;
+                }
+                return encode_frame(path, encoded, trace);
+            },
+            [&cache](const fs::path& path) { return cache.find(path) != nullptr; });
+        prefetcher->start();
+    }
+
+    // Lightweight observability for long-running sessions.
+    const auto maybe_heartbeat = [&]() {
+        const auto now = std::chrono::steady_clock::now();
+        if (heartbeat_interval.count() <= 0 || now - last_heartbeat < heartbeat_interval) {
+            return;
+        }
+        const double actual_fps = scheduler.take_actual_fps();
+        spdlog::info("Heartbeat: frames sent={}, loop_iteration={}, rate={}, cached={} "
+                     "({} MB memory, {} MB disk)",
+                     frames_sent,
+                     loop_iteration,
+                     scheduler.enabled()
+                         ? fmt::format("{:.1f}/{} fps", actual_fps, scheduler.target_fps())
+                         : fmt::format("{:.1f} fps", actual_fps),
+                     cache.size(),
+                     cache.memory_bytes() / (1024 * 1024),
+                     cache.disk_bytes() / (1024 * 1024));
+        last_heartbeat = now;
+    };
+
+    // Publish whatever the source yields: the dataset in a loop (or once with --once), or
+    // new files as they land in watch mode.
+    while (!bench.enabled && g_keep_running.load()) {
+        auto prefetched = prefetcher->next(kSourceIdleWait);
+        if (!prefetched) {
+            if (prefetcher->done()) {
+                break;
+            }
+            // Nothing new to send (watch mode): flush the backlog to late subscribers.
+            if (monitor->has_subscriber() && !pending_frames.empty()) {
+                spdlog::info("Flushing {} queued frames to new subscriber", pending_frames.size());
+                while (monitor->has_subscriber()) {
+                    auto* queued = pending_frames.front();
+                    if (queued == nullptr) {
+                        break;
+                    }
+                    try {
+                        // PUSH has no room while every extractor is saturated; keep it queued.
+                        if (!try_send(publisher, *queued, shm_writer)) {
+                            break;
+                        }
+                    } catch (const zmq::error_t& ex) {
+                        spdlog::warn("Failed to flush queued frame: {}", ex.what());
+                        pending_frames.pop_front();
+                        break;
+                    }
+                    pending_frames.pop_front();
+                }
+                metrics.pending.set(static_cast<double>(pending_frames.size()));
+                metrics.pending_bytes.set(static_cast<double>(pending_frames.memory_bytes()));
+            }
+            maybe_heartbeat();
+            continue;
+        }
+        const auto& image_path = prefetched->path;
+        const auto stream = prefetched->stream;
+        loop_iteration = prefetched->pass;
+
+        // Paced once the frame is in hand so the header timestamp reflects the send slot.
+        scheduler.wait();
+
+        // Later loops publish straight from the cache; only misses hit the codec.
+        // A cache hit is read and encoded in one step; passthrough has no encode step.
+        dist::common::FrameTrace trace;
+        const CachedFrame* frame = cache.find(image_path);
+        std::vector<uchar> encoded;
+        std::optional<CachedFrame> uncached;
+        if (frame == nullptr) {
+            if (!prefetched->frame) {
+                continue;
+            }
+            // Moving the vector keeps its buffer, so the frame's view stays valid.
+            uncached = std::move(prefetched->frame);
+            encoded = std::move(prefetched->encoded);
+            trace = prefetched->trace;
+            metrics.load_seconds.observe(prefetched->load_seconds);
+            if (encoded.size() > kMaxPayloadBytes) {
+                spdlog::warn("Encoded image {} is too large ({} bytes > {}), skipping",
+                             image_path.string(),
+                             encoded.size(),
+                             kMaxPayloadBytes);
+                continue;
+            }
+            frame = cache.insert(image_path, *uncached, encoded);
+            if (frame == nullptr) {
+                frame = &*uncached;  // Budget exhausted; publish from the local buffer.
+            }
+        } else {
+            trace.mark(dist::common::TraceStage::read);
+            trace.mark(dist::common::TraceStage::encode);
+        }
+
+        const std::size_t frame_id = next_frame_id[stream]++;
+        nlohmann::json header{
+            {"frame_id", frame_id},
+            {"loop_iteration", loop_iteration},
+            {"timestamp", dist::common::now_iso8601()},
+            {"filename", frame->filename},
+            {"width", frame->width},
+            {"height", frame->height},
+            {"channels", frame->channels},
+            {"encoding", frame->encoding},
+            {"bytes", frame->size},
+        };
+        if (frame->encoding == "raw") {
+            // Receivers wrap the buffer as cv::Mat(height, width, cv_type, data, step).
+            header["cv_type"] = frame->cv_type;
+            header["step"] = frame->step;
+            header["compression"] = frame->compression;
+            header["raw_bytes"] = frame->raw_bytes;
+        }
+        // Stamped as the frame is handed to the socket (or the queue, when blocked).
+        trace.mark(dist::common::TraceStage::send);
+        header["trace"] = dist::common::trace_to_json(trace);
+
+        spdlog::debug("Header: {}", header.dump());
+
+        // Cached payloads are borrowed (the cache outlives the socket); a frame the cache
+        // could not hold is moved into the message and its buffer returns to the pool once
+        // ZeroMQ has sent it. Either way the encode buffer is recycled.
+        const bool owns_payload = uncached && frame == &*uncached;
+        auto outgoing = make_outgoing(
+            zmq::message_t(topics[stream]),
+            zmq::message_t(header.dump()),
+            owns_payload ? dist::common::make_pooled_message(std::move(encoded))
+                         : dist::common::borrow_message(frame->data, frame->size));
+        dist::common::buffer_pool().release(std::move(encoded));
+
+        bool sent = false;
+        try {
+            // Older queued frames go first; otherwise wait (bounded) for downstream room.
+            while (!pending_frames.empty() && wait_writable(publisher, *monitor, kSendWait)) {
+                auto* queued = pending_frames.front();
+                if (queued == nullptr || !try_send(publisher, *queued, shm_writer)) {
+                    break;
+                }
+                pending_frames.pop_front();
+            }
+            if (pending_frames.empty() && wait_writable(publisher, *monitor, kSendWait)) {
+                sent = try_send(publisher, outgoing, shm_writer);
+            }
+        } catch (const zmq::error_t& ex) {
+            spdlog::error("ZeroMQ send failed: {}", ex.what());
+            return 1;
+        }
+
+        metrics.payload_bytes.observe(static_cast<double>(frame->size));
+        if (sent) {
+            spdlog::debug("Published {} frame {} ({} bytes)",
+                          streams[stream].id,
+                          frame_id,
+                          frame->size);
+        } else {
+            // Hold onto the frame until someone subscribes (bounded by frames and bytes).
+            // Only an owned payload costs memory; first-pass frames outrank replays.
+            const std::size_t held_bytes = owns_payload ? frame->size : 0;
+            const int priority = loop_iteration == 0 ? 1 : 0;
+            if (const auto dropped =
+                    pending_frames.push(std::move(outgoing), held_bytes, priority)) {
+                spdlog::warn("Queue full ({} frames, {} MB held); dropped {} frame(s) ({})",
+                             pending_frames.size(),
+                             pending_frames.memory_bytes() / (1024 * 1024),
+                             dropped,
+                             dist::common::to_string(*drop_policy));
+                metrics.dropped.inc(dropped);
+            }
+            metrics.queued.inc();
+            // wait_writable() already spent up to kSendWait, which paces this path.
+            if (monitor->has_subscriber()) {
+                spdlog::warn(
+                    "Extractors saturated; queueing {} frame {}", streams[stream].id, frame_id);
+            } else {
+                spdlog::warn(
+                    "No subscriber present; queueing {} frame {}", streams[stream].id, frame_id);
+            }
+        }
+
+        metrics.pending.set(static_cast<double>(pending_frames.size()));
+        metrics.pending_bytes.set(static_cast<double>(pending_frames.memory_bytes()));
+        ++frames_sent;
+
+        if (!scheduler.enabled() && delay.count() > 0) {
+            std::this_thread::sleep_for(delay);
+        }
+
+        maybe_heartbeat();
+    }
+
+    // Tidy up in reverse order to avoid dangling ZeroMQ resources.
+    spdlog::info("Generator shutting down (frames sent: {})", frames_sent);
+    if (prefetcher) {
+        prefetcher->stop();
+    }
+    metrics_server.stop();
+    monitor->stop();
+    monitor_guard.monitor = nullptr;
+    monitor.reset();  // Destroy monitor before tearing down ZeroMQ to avoid shutdown hang.
+    publisher.close();
+    if (own_context) {
+        own_context->close();
+    }
+    spdlog::info("Generator cleanup complete.");
+    return 0;
+}
+
+void request_stop() {
+    g_keep_running.store(false);
+}
+
+}  // namespace dist::image_generator
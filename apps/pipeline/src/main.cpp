@@ -0,0 +1,245 @@
+#include <CLI/CLI.hpp>
+#include <opencv2/core.hpp>
+#include <spdlog/spdlog.h>
+#include <zmq.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "dist/common/buffer_pool.hpp"
+#include "dist/common/config.hpp"
+#include "dist/common/env_loader.hpp"
+#include "dist/common/metrics.hpp"
+#include "dist/common/stage.hpp"
+#include "dist/common/utils.hpp"
+#include "dist/data_logger/stage.hpp"
+#include "dist/feature_extractor/stage.hpp"
+#include "dist/image_generator/stage.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::atomic_bool g_keep_running{true};
+constexpr auto kSupervisePeriod = std::chrono::milliseconds(100);
+// Links between the stages; pubsub and pushpull both work over inproc.
+constexpr std::string_view kFrameEndpoint = "inproc://dist-frames";
+constexpr std::string_view kFeatureEndpoint = "inproc://dist-features";
+
+using RunFn = int (*)(int, char**, const dist::common::StageRuntime&);
+using StopFn = void (*)();
+
+// One stage on its own thread, started with the command line its binary would get.
+struct StageThread {
+    std::string name;
+    RunFn run = nullptr;
+    StopFn stop = nullptr;
+    std::vector<std::string> args;
+    std::thread thread;
+    std::atomic_bool done{false};
+    int status = 0;
+
+    void start(const dist::common::StageRuntime& runtime) {
+        thread = std::thread([this, &runtime] {
+            std::vector<char*> argv;
+            argv.reserve(args.size() + 1);
+            for (auto& arg : args) {
+                argv.push_back(arg.data());
+            }
+            argv.push_back(nullptr);
+            status = run(static_cast<int>(args.size()), argv.data(), runtime);
+            done.store(true);
+        });
+    }
+};
+
+fs::path resolve_env_path(const std::string& cli_env_path,
+                          const char* env_override,
+                          const fs::path& root) {
+    if (!cli_env_path.empty()) {
+        return cli_env_path;
+    }
+    if (env_override != nullptr) {
+        return env_override;
+    }
+    return root / ".env";
+}
+
+// The configuration every stage is about to load, for the settings they share.
+std::optional<dist::common::AppConfig> load_config(const std::string& cli_env_path) {
+    dist::common::EnvLoader loader;
+    const auto root = fs::current_path();
+    const auto env_path = resolve_env_path(cli_env_path, std::getenv("DIST_ENV_PATH"), root);
+    if (!loader.load_from_file(env_path) && !loader.load_from_env()) {
+        spdlog::error("[pipeline] No configuration could be loaded from {} or the process "
+                      "environment",
+                      env_path.string());
+        return std::nullopt;
+    }
+    return dist::common::load_app_config(loader, root);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    CLI::App app{"Pipeline - runs generator, extractor and logger as threads of one process"};
+    std::string cli_env_path;
+    std::string cli_log_level;
+    bool run_once = false;
+    bool annotated = false;
+    bool bench = false;
+    std::vector<std::pair<std::string, std::string>> bench_options{
+        {"--bench-frames", ""}, {"--bench-width", ""}, {"--bench-height", ""}, {"--bench-fps", ""}};
+    app.add_option("--env", cli_env_path, "Path to the .env file (overrides DIST_ENV_PATH)");
+    app.add_option("--log-level", cli_log_level, "Override log level (trace|debug|info|warn|error|critical)");
+    app.add_flag("--once", run_once, "Publish the dataset a single time, then stop every stage");
+    app.add_flag("--annotated", annotated, "Emit annotated frames (feature_extractor --annotated)");
+    app.add_flag("--bench", bench, "Synthetic load run; every stage reports and exits on its own");
+    for (auto& [flag, value] : bench_options) {
+        app.add_option(flag, value, "Passed to image_generator (--bench)");
+    }
+
+    CLI11_PARSE(app, argc, argv);
+
+    // Logging, the payload buffer pool and OpenCV's thread count belong to the process, so
+    // they are set once here instead of by whichever stage thread starts last.
+    const auto config = load_config(cli_env_path);
+    if (!config) {
+        return 1;
+    }
+    spdlog::set_level(dist::common::level_from_string(
+        cli_log_level.empty() ? config->global.log_level : cli_log_level));
+    spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] %v");
+    // Generator and extractor both draw from the one pool, so it holds both budgets.
+    const int pool_mb = std::max(config->generator.buffer_pool_mb, 0) +
+                        std::max(config->extractor.buffer_pool_mb, 0);
+    dist::common::buffer_pool().set_max_bytes(static_cast<std::size_t>(pool_mb) * 1024 * 1024);
+    // An extractor worker pool already fills the cores; as in a standalone extractor,
+    // OpenCV then runs single-threaded, which now covers the generator's codecs too.
+    if (config->extractor.workers > 1) {
+        cv::setNumThreads(1);
+    }
+    spdlog::info("[pipeline] Buffer pool {} MB, OpenCV threads {}", pool_mb, cv::getNumThreads());
+
+    std::vector<std::string> shared_args;
+    if (!cli_env_path.empty()) {
+        shared_args.insert(shared_args.end(), {"--env", cli_env_path});
+    }
+    if (!cli_log_level.empty()) {
+        shared_args.insert(shared_args.end(), {"--log-level", cli_log_level});
+    }
+    if (bench) {
+        shared_args.emplace_back("--bench");
+    }
+    const auto stage_args = [&shared_args](std::string binary) {
+        std::vector<std::string> args{std::move(binary)};
+        args.insert(args.end(), shared_args.begin(), shared_args.end());
+        return args;
+    };
+
+    // Launch order matches run_all.sh: logger, extractor, then the generator feeding them.
+    StageThread stages[3];
+    auto& logger = stages[0];
+    auto& extractor = stages[1];
+    auto& generator = stages[2];
+    logger.name = "data_logger";
+    logger.run = &dist::data_logger::run;
+    logger.stop = &dist::data_logger::request_stop;
+    logger.args = stage_args("data_logger");
+    extractor.name = "feature_extractor";
+    extractor.run = &dist::feature_extractor::run;
+    extractor.stop = &dist::feature_extractor::request_stop;
+    extractor.args = stage_args("feature_extractor");
+    if (annotated) {
+        extractor.args.emplace_back("--annotated");
+    }
+    generator.name = "image_generator";
+    generator.run = &dist::image_generator::run;
+    generator.stop = &dist::image_generator::request_stop;
+    generator.args = stage_args("image_generator");
+    if (run_once) {
+        generator.args.emplace_back("--once");
+    }
+    for (const auto& [flag, value] : bench_options) {
+        if (!value.empty()) {
+            generator.args.insert(generator.args.end(), {flag, value});
+        }
+    }
+
+    zmq::context_t context{1};
+    dist::common::StageRuntime runtime;
+    runtime.context = &context;
+    runtime.handle_signals = false;
+    runtime.configure_process = false;
+    runtime.env_overrides = {
+        {"IMAGE_GENERATOR_PUB_ENDPOINT", std::string(kFrameEndpoint)},
+        {"FEATURE_EXTRACTOR_SUB_ENDPOINT", std::string(kFrameEndpoint)},
+        {"FEATURE_EXTRACTOR_PUB_ENDPOINT", std::string(kFeatureEndpoint)},
+        {"DATA_LOGGER_SUB_ENDPOINT", std::string(kFeatureEndpoint)},
+        // Payloads never leave the process, so skip the PNG codec and the JSON header
+        // on the extractor -> logger hop. The generator's header is still JSON.
+        {"IMAGE_GENERATOR_PUBLISH_MODE", "raw"},
+        {"FEATURE_EXTRACTOR_HEADER_FORMAT", "binary"},
+        // The registry is process-wide, so one server covers every stage; three would
+        // each serve all of it and a scrape of each would count every series thrice.
+        {"IMAGE_GENERATOR_METRICS_ENDPOINT", ""},
+        {"FEATURE_EXTRACTOR_METRICS_ENDPOINT", ""},
+        {"DATA_LOGGER_METRICS_ENDPOINT", ""},
+    };
+    dist::common::install_signal_handlers(g_keep_running);
+    dist::common::MetricsServer metrics_server{
+        context, config->pipeline.metrics_endpoint, dist::common::metrics()};
+    metrics_server.start();
+
+    spdlog::info("[pipeline] Running all stages in-process ({} -> {})", kFrameEndpoint, kFeatureEndpoint);
+    for (auto& stage : stages) {
+        stage.start(runtime);
+    }
+
+    // A signal, a failed stage or the end of a --once pass stops every stage; in --bench
+    // each stage exits by itself as its input goes quiet.
+    bool stopping = false;
+    while (!std::all_of(std::begin(stages), std::end(stages), [](const auto& stage) {
+        return stage.done.load();
+    })) {
+        std::this_thread::sleep_for(kSupervisePeriod);
+        if (stopping) {
+            continue;
+        }
+        const bool failed = std::any_of(std::begin(stages), std::end(stages), [](const auto& stage) {
+            return stage.done.load() && stage.status != 0;
+        });
+        const bool generator_finished = generator.done.load() && !bench;
+        if (!g_keep_running.load() || failed || generator_finished) {
+            if (generator_finished && !failed && g_keep_running.load()) {
+                spdlog::info("[pipeline] Generator completed. Stopping remaining stages.");
+            }
+            for (auto& stage : stages) {
+                stage.stop();
+            }
+            stopping = true;
+        }
+    }
+
+    int status = 0;
+    for (auto& stage : stages) {
+        stage.thread.join();
+        if (stage.status != 0) {
+            spdlog::error("[pipeline] {} exited with status {}", stage.name, stage.status);
+            if (status == 0) {
+                status = stage.status;
+            }
+        }
+    }
+    metrics_server.stop();
+    return status;
+}
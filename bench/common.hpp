@@ -0,0 +1,35 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <opencv2/core.hpp>
+
+#include <cstddef>
+#include <vector>
+
+#include "dist/features/synthetic.hpp"
+
+namespace dist::bench {
+
+// Frame sizes every image benchmark runs at: VGA, 720p, 1080p.
+inline void frame_sizes(benchmark::internal::Benchmark* bench) {
+    bench->Args({640, 480})->Args({1280, 720})->Args({1920, 1080});
+}
+
+[[nodiscard]] inline cv::Mat frame_for(const benchmark::State& state) {
+    return dist::features::synthetic_frame(
+        static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), 1);
+}
+
+// A keypoint cloud shaped like SIFT output, for the serialization paths.
+[[nodiscard]] inline std::vector<cv::KeyPoint> synthetic_keypoints(std::size_t count) {
+    std::vector<cv::KeyPoint> keypoints;
+    keypoints.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto f = static_cast<float>(i);
+        keypoints.emplace_back(
+            f * 1.7F, f * 0.9F, 3.0F + f * 0.001F, f, 0.02F, static_cast<int>(i % 4));
+    }
+    return keypoints;
+}
+
+}  // namespace dist::bench
@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "dist/common/config.hpp"
+#include "dist/common/trace.hpp"
+#include "dist/common/utils.hpp"
+#include "dist/common/wire_format.hpp"
+#include "frame_database.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Row inserts through FrameDatabase against a scratch file, with the logger's default
+// WAL/NORMAL pragmas; the argument is DATA_LOGGER_BATCH_SIZE (rows per COMMIT).
+void BM_FrameInsert(benchmark::State& state) {
+    const auto path = fs::temp_directory_path() / "dist_bench_frames.sqlite";
+    for (const auto* suffix : {"", "-wal", "-shm"}) {
+        fs::remove(path.string() + suffix);
+    }
+
+    dist::common::DataLoggerConfig config;
+    config.db_path = path;
+    config.batch_size = static_cast<int>(state.range(0));
+    config.flush_interval_ms = 60'000;  // Commit on batch size only
+    std::vector<std::uint8_t> descriptors(1000 * 128);
+    std::vector<std::uint8_t> keypoints(1000 * sizeof(dist::common::wire::PackedKeypoint));
+    {
+        dist::data_logger::FrameDatabase database{config};
+        dist::data_logger::FrameRecord record;
+        record.source_timestamp = dist::common::now_iso8601();
+        record.processed_timestamp = record.source_timestamp;
+        record.keypoint_count = 1000;
+        record.trace.mark(dist::common::TraceStage::read);
+        dist::data_logger::FrameRow row;
+        row.record = &record;
+        row.image_path = "raw_frames/bench.png";
+        row.metadata_json = R"({"frame_id":0,"filename":"bench.png"})";
+        row.descriptors = descriptors.data();
+        row.descriptors_size = descriptors.size();
+        row.keypoints = keypoints.data();
+        row.keypoints_size = keypoints.size();
+        for (auto _ : state) {
+            ++record.frame_id;
+            benchmark::DoNotOptimize(database.insert(row));
+        }
+        database.flush();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    for (const auto* suffix : {"", "-wal", "-shm"}) {
+        fs::remove(path.string() + suffix);
+    }
+}
+BENCHMARK(BM_FrameInsert)->Arg(1)->Arg(64)->Arg(512);
+
+}  // namespace
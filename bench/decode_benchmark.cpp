@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+#include <opencv2/imgcodecs.hpp>
+#include <zmq.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "common.hpp"
+#include "dist/common/compression.hpp"
+#include "dist/features/frame_decode.hpp"
+
+namespace {
+
+// PNG payloads go through cv::imdecode, the extractor's dominant cost before detection.
+void BM_DecodePng(benchmark::State& state) {
+    const auto frame = dist::bench::frame_for(state);
+    std::vector<uchar> encoded;
+    cv::imencode(".png", frame, encoded);
+    dist::features::FrameLayout layout;
+    layout.encoding = "png";
+    for (auto _ : state) {
+        zmq::message_t payload(encoded.data(), encoded.size());
+        auto image = dist::features::decode_frame(layout, payload);
+        benchmark::DoNotOptimize(image.data);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+                            static_cast<std::int64_t>(encoded.size()));
+}
+BENCHMARK(BM_DecodePng)->Apply(dist::bench::frame_sizes)->Unit(benchmark::kMillisecond);
+
+// Raw payloads alias the message; this measures the wrapper plus the payload copy.
+void BM_DecodeRaw(benchmark::State& state) {
+    const auto frame = dist::bench::frame_for(state);
+    dist::features::FrameLayout layout;
+    layout.encoding = "raw";
+    layout.width = frame.cols;
+    layout.height = frame.rows;
+    layout.cv_type = frame.type();
+    layout.step = frame.step[0];
+    const std::size_t bytes = frame.total() * frame.elemSize();
+    for (auto _ : state) {
+        zmq::message_t payload(frame.data, bytes);
+        auto image = dist::features::decode_frame(layout, payload);
+        benchmark::DoNotOptimize(image.data);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+                            static_cast<std::int64_t>(bytes));
+}
+BENCHMARK(BM_DecodeRaw)->Apply(dist::bench::frame_sizes)->Unit(benchmark::kMillisecond);
+
+void BM_EncodePng(benchmark::State& state) {
+    const auto frame = dist::bench::frame_for(state);
+    std::vector<uchar> encoded;
+    for (auto _ : state) {
+        cv::imencode(".png", frame, encoded);
+        benchmark::DoNotOptimize(encoded.data());
+    }
+}
+BENCHMARK(BM_EncodePng)->Apply(dist::bench::frame_sizes)->Unit(benchmark::kMillisecond);
+
+}  // namespace
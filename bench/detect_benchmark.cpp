@@ -0,0 +1,55 @@
+#include <benchmark/benchmark.h>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <vector>
+
+#include "common.hpp"
+#include "dist/common/config.hpp"
+#include "dist/features/descriptors.hpp"
+#include "dist/features/detector.hpp"
+
+namespace {
+
+// Single-threaded, on grayscale input, as one extractor worker runs it.
+void run_detector(benchmark::State& state, dist::features::DetectorBackend backend) {
+    cv::setNumThreads(1);
+    const dist::common::FeatureExtractorConfig config;
+    auto detector = dist::features::make_detector(backend, config);
+    cv::Mat gray;
+    cv::cvtColor(dist::bench::frame_for(state), gray, cv::COLOR_BGR2GRAY);
+    std::vector<cv::KeyPoint> keypoints;
+    cv::Mat descriptors;
+    for (auto _ : state) {
+        keypoints.clear();
+        detector->detect_and_compute(gray, cv::Mat{}, keypoints, descriptors);
+        benchmark::DoNotOptimize(descriptors.data);
+    }
+    state.counters["keypoints"] = static_cast<double>(keypoints.size());
+}
+
+void BM_DetectSift(benchmark::State& state) {
+    run_detector(state, dist::features::DetectorBackend::sift);
+}
+BENCHMARK(BM_DetectSift)->Apply(dist::bench::frame_sizes)->Unit(benchmark::kMillisecond);
+
+void BM_DetectOrb(benchmark::State& state) {
+    run_detector(state, dist::features::DetectorBackend::orb);
+}
+BENCHMARK(BM_DetectOrb)->Apply(dist::bench::frame_sizes)->Unit(benchmark::kMillisecond);
+
+// Narrowing SIFT descriptors to the stored element type (1000 keypoints).
+void BM_ConvertDescriptors(benchmark::State& state) {
+    cv::Mat descriptors(1000, 128, CV_32F);
+    cv::randu(descriptors, 0.0, 255.0);
+    const auto format = static_cast<dist::features::DescriptorFormat>(state.range(0));
+    for (auto _ : state) {
+        auto converted = dist::features::convert_descriptors(descriptors, format);
+        benchmark::DoNotOptimize(converted.data);
+    }
+}
+BENCHMARK(BM_ConvertDescriptors)
+    ->Arg(static_cast<int>(dist::features::DescriptorFormat::f16))
+    ->Arg(static_cast<int>(dist::features::DescriptorFormat::u8));
+
+}  // namespace
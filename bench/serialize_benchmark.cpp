@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+#include "dist/common/wire_format.hpp"
+#include "dist/features/keypoints.hpp"
+#include "frame_record.hpp"
+
+namespace {
+
+namespace wire = dist::common::wire;
+
+// The extractor's JSON debug header: keypoints inline, then dumped.
+void BM_JsonHeaderBuild(benchmark::State& state) {
+    const auto keypoints =
+        dist::bench::synthetic_keypoints(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        nlohmann::json header = {
+            {"source", {{"frame_id", 1}, {"filename", "bench.png"}}},
+            {"keypoint_count", keypoints.size()},
+            {"keypoints", dist::features::keypoints_to_json(keypoints)},
+        };
+        auto text = header.dump();
+        benchmark::DoNotOptimize(text.data());
+    }
+}
+BENCHMARK(BM_JsonHeaderBuild)->Arg(500)->Arg(5000);
+
+// The binary path it replaces: fixed header plus packed keypoints.
+void BM_BinaryHeaderBuild(benchmark::State& state) {
+    const auto keypoints =
+        dist::bench::synthetic_keypoints(static_cast<std::size_t>(state.range(0)));
+    std::vector<std::uint8_t> packed(keypoints.size() * sizeof(wire::PackedKeypoint));
+    for (auto _ : state) {
+        wire::FrameHeader header;
+        header.frame_id = 1;
+        header.keypoint_count = keypoints.size();
+        wire::set_field(header.filename, "bench.png");
+        dist::features::pack_keypoints(keypoints, packed.data());
+        benchmark::DoNotOptimize(&header);
+        benchmark::DoNotOptimize(packed.data());
+    }
+}
+BENCHMARK(BM_BinaryHeaderBuild)->Arg(500)->Arg(5000);
+
+// Logger side of both formats.
+void BM_JsonRecordParse(benchmark::State& state) {
+    const auto keypoints =
+        dist::bench::synthetic_keypoints(static_cast<std::size_t>(state.range(0)));
+    const nlohmann::json header = {
+        {"source", {{"frame_id", 1}, {"filename", "bench.png"}, {"encoding", "png"}}},
+        {"keypoint_count", keypoints.size()},
+        {"keypoints", dist::features::keypoints_to_json(keypoints)},
+    };
+    const auto text = header.dump();
+    for (auto _ : state) {
+        auto record = dist::data_logger::record_from_json(text);
+        benchmark::DoNotOptimize(record);
+    }
+}
+BENCHMARK(BM_JsonRecordParse)->Arg(500)->Arg(5000);
+
+void BM_BinaryRecordParse(benchmark::State& state) {
+    wire::FrameHeader header;
+    header.frame_id = 1;
+    wire::set_field(header.filename, "bench.png");
+    wire::set_field(header.encoding, "png");
+    for (auto _ : state) {
+        auto record = dist::data_logger::record_from_binary(&header, sizeof(header));
+        benchmark::DoNotOptimize(record);
+    }
+}
+BENCHMARK(BM_BinaryRecordParse);
+
+}  // namespace
@@ -5,6 +5,8 @@ set(DIST_CLI11_TAG v2.4.2)
 set(DIST_SPDLOG_TAG v1.13.0)
 set(DIST_CPPZMQ_TAG v4.10.0)
 set(DIST_JSON_TAG v3.11.3)
+set(DIST_BENCHMARK_TAG v1.8.3)  # Only fetched with DIST_BUILD_BENCHMARKS and no system copy
+set(DIST_GOOGLETEST_TAG v1.14.0)  # Only fetched with DIST_BUILD_TESTS and no system copy
 
 find_package(OpenCV 4 REQUIRED COMPONENTS core imgproc imgcodecs features2d)
 find_package(ZeroMQ QUIET)
@@ -30,6 +32,15 @@ else()
     set(DIST_LIBZMQ_TARGET dist::libzmq)
 endif()
 
+# Optional codecs: raw-frame compression is compiled in only when these are present.
+find_package(PkgConfig QUIET)
+if(PkgConfig_FOUND)
+    pkg_check_modules(PC_LZ4 QUIET IMPORTED_TARGET liblz4)
+    pkg_check_modules(PC_ZSTD QUIET IMPORTED_TARGET libzstd)
+    # Batched async payload writes in the logger (Linux only).
+    pkg_check_modules(PC_LIBURING QUIET IMPORTED_TARGET liburing)
+endif()
+
 FetchContent_Declare(
     CLI11
     GIT_REPOSITORY https://github.com/CLIUtils/CLI11.git
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "dist/common/trace.hpp"
+
+namespace dist::common {
+
+// Collects the traces of frames that completed a stage during a --bench run and logs
+// sustained throughput plus p50/p99 of every span (kTraceSpans) the traces carry.
+class BenchReport {
+  public:
+    // Thread-safe; call once per completed frame.
+    void record(const FrameTrace& trace);
+
+    [[nodiscard]] std::uint64_t frames() const;
+
+    // `drops` is whatever the caller counts as lost (queue overflow, id gaps, failures).
+    void log_summary(std::string_view service, std::uint64_t drops) const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    mutable std::mutex mutex_;
+    std::array<std::vector<std::int64_t>, kTraceSpans.size()> samples_;
+    std::uint64_t frames_ = 0;
+    Clock::time_point first_{};
+    Clock::time_point last_{};
+};
+
+}  // namespace dist::common
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <zmq.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace dist::common {
+
+// Recycles large payload buffers, so a steady stream of similar frames reuses a few
+// allocations instead of faulting in a fresh vector per frame. Buffers smaller than
+// kMinPooledBytes are not worth keeping and are freed. Thread-safe: ZeroMQ hands
+// buffers back from its I/O thread.
+class BufferPool {
+  public:
+    static constexpr std::size_t kMinPooledBytes = 64 * 1024;
+
+    explicit BufferPool(std::size_t max_bytes = 0) : max_bytes_(max_bytes) {}
+
+    // Capacity kept for reuse (0 disables pooling); shrinking frees the excess.
+    void set_max_bytes(std::size_t max_bytes);
+
+    // An empty buffer with capacity for at least `size_hint` bytes, or the largest
+    // pooled one when no hint is given (a fresh vector when nothing fits).
+    [[nodiscard]] std::vector<std::uint8_t> acquire(std::size_t size_hint = 0);
+
+    // Keep `buffer`'s capacity for a later acquire(), budget permitting.
+    void release(std::vector<std::uint8_t>&& buffer);
+
+    [[nodiscard]] std::size_t pooled_bytes() const;
+
+  private:
+    void trim_locked();
+
+    mutable std::mutex mutex_;
+    std::size_t max_bytes_;
+    std::size_t pooled_bytes_ = 0;
+    std::multimap<std::size_t, std::vector<std::uint8_t>> buffers_;  // Keyed by capacity
+};
+
+// The pool every payload path of this process draws from (sized by *_BUFFER_POOL_MB).
+[[nodiscard]] BufferPool& buffer_pool();
+
+// Like make_message(), but the buffer goes back to buffer_pool() once ZeroMQ is done.
+[[nodiscard]] zmq::message_t make_pooled_message(std::vector<std::uint8_t>&& buffer);
+
+}  // namespace dist::common
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace dist::common {
+
+// Optional byte-level codecs for payloads that are not already compressed.
+enum class Compression { none, lz4, zstd };
+
+// Parse "none" / "lz4" / "zstd" (nullopt for anything else).
+[[nodiscard]] std::optional<Compression> parse_compression(std::string_view value);
+[[nodiscard]] std::string_view to_string(Compression compression);
+
+// False when the codec was not found at configure time.
+[[nodiscard]] bool compression_available(Compression compression);
+
+// Compress `size` bytes into `out` (resized to the compressed length).
+[[nodiscard]] bool compress(Compression compression,
+                            const std::uint8_t* data,
+                            std::size_t size,
+                            std::vector<std::uint8_t>& out);
+
+// Decompress into a caller-provided buffer that must be exactly `out_size` bytes.
+[[nodiscard]] bool decompress(Compression compression,
+                              const std::uint8_t* data,
+                              std::size_t size,
+                              std::uint8_t* out,
+                              std::size_t out_size);
+
+}  // namespace dist::common
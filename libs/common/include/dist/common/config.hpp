@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <string>
+#include <vector>
 
 #include "dist/common/env_loader.hpp"
 
@@ -12,25 +13,116 @@ struct GlobalConfig {
     std::string log_level = "info";
 };
 
+// One camera (image directory) published under its own stream id.
+struct StreamInput {
+    std::string id;
+    std::filesystem::path input_dir;
+};
+
 // Parameters consumed by the image generator binary.
 struct ImageGeneratorConfig {
     std::filesystem::path input_dir;
+    // IMAGE_GENERATOR_STREAMS ("cam0=./data/cam0,cam1=./data/cam1"); when unset, input_dir
+    // is published as the "default" stream.
+    std::vector<StreamInput> streams;
+    // "snapshot" replays a sorted listing; "lazy" re-walks the directory each loop without
+    // holding it; "watch" publishes existing files once, then new ones via inotify.
+    std::string source_mode = "snapshot";
     int loop_delay_ms = 100;
+    // Absolute publish rate; when > 0 it replaces loop_delay_ms. `burst` frames may go
+    // back-to-back to catch up after a stall.
+    double target_fps = 0.0;
+    int burst = 1;
     int start_delay_ms = 500;
     int subscriber_wait_ms = 1000;
+    // "shm://<name>" sends payloads through a shared-memory ring of shm_mb instead of
+    // the socket (receivers on the same host only).
     std::string pub_endpoint;
+    int shm_mb = 256;
     int heartbeat_ms = 2000;
     int queue_depth = 100;
+    // Queued frames are also bounded by the memory they hold (queue_mb); past either bound
+    // drop_policy ("oldest", "newest", "priority") picks what gives way. With spill_dir
+    // set, frames past queue_mb wait on disk (up to spill_mb) before anything is dropped.
+    int queue_mb = 256;
+    std::string drop_policy = "oldest";
+    std::filesystem::path spill_dir;
+    int spill_mb = 1024;
+    // Payload buffers kept for reuse instead of a fresh allocation per frame.
+    int buffer_pool_mb = 64;
+    // "reencode" decodes and re-encodes to PNG; "passthrough" publishes the file bytes as-is;
+    // "raw" ships the decoded cv::Mat pixel buffer (optionally compressed).
+    std::string publish_mode = "reencode";
+    std::string raw_compression = "none";
+    // Encoded frame cache: "memory", "disk" (mmap'd spill past the budget) or "off".
+    std::string cache_mode = "memory";
+    int cache_budget_mb = 512;
+    std::filesystem::path cache_dir;
+    // Cache misses are read + encoded this many frames ahead on worker threads (0 = inline).
+    int prefetch_threads = 2;
+    int prefetch_depth = 16;
+    // "pubsub" broadcasts to every extractor; "pushpull" load-balances across them.
+    std::string distribution = "pubsub";
+    // Prometheus scrape endpoint (e.g. "tcp://*:9101"); empty disables it.
+    std::string metrics_endpoint;
 };
 
 // Parameters consumed by the feature extractor binary.
 struct FeatureExtractorConfig {
     std::string sub_endpoint;
     std::string pub_endpoint;
+    int shm_mb = 256;  // Ring size when pub_endpoint is "shm://<name>"
+    // "sift" | "orb" | "akaze" | "cuda_orb"; the sift_* / orb_* / akaze_* knobs tune each.
+    std::string detector = "sift";
     int sift_n_features = 0;
     double sift_contrast_threshold = 0.04;
     double sift_edge_threshold = 10.0;
+    int orb_n_features = 5000;
+    double akaze_threshold = 0.001;
+    // Frames larger than tile_size (pixels, 0 = off) are detected as a grid of tiles in
+    // parallel; each tile reads tile_overlap extra pixels of context on every side.
+    int tile_size = 0;
+    int tile_overlap = 32;
+    // Detector input: longer side capped at max_dimension (0 = native), converted to
+    // grayscale once, and limited to roi "x,y,w,h" by cropping or masking ("crop" |
+    // "mask") and/or a mask image. Keypoints are reported in source coordinates.
+    int max_dimension = 0;
+    bool grayscale = true;
+    std::string roi;
+    std::string roi_mode = "crop";
+    std::filesystem::path mask_path;
+    // Reuse detection results for repeated frames: an LRU of reuse_cache_mb (0 = off)
+    // keyed by payload hash, optionally also matching frames whose thumbnail differs
+    // by at most reuse_diff_threshold (mean absolute difference, 0 = exact only).
+    int reuse_cache_mb = 0;
+    double reuse_diff_threshold = 0.0;
     int queue_depth = 100;
+    // Same memory bound, drop policy and spill as the generator's pending queue.
+    int queue_mb = 256;
+    std::string drop_policy = "oldest";
+    std::filesystem::path spill_dir;
+    int spill_mb = 1024;
+    int buffer_pool_mb = 64;
+    // Parallel decode/detect/serialize threads; ordered output preserves arrival order.
+    int workers = 1;
+    bool ordered_output = true;
+    // With --annotated, draw overlays for 1 in N frames (0 = only frames that request one),
+    // either inline ("extractor") or deferred to the logger ("logger").
+    int annotate_every_n = 1;
+    std::string annotation_stage = "extractor";
+    // "binary" sends a fixed-layout header plus packed keypoints; "json" is for debugging.
+    std::string header_format = "binary";
+    // Descriptor element type on the wire and in the database ("f32" | "f16" | "u8"),
+    // optionally compressed ("none" | "lz4" | "zstd").
+    std::string descriptor_format = "f32";
+    std::string descriptor_compression = "none";
+    // Must match the generator and logger; in "pushpull" both links are connected from here.
+    std::string distribution = "pubsub";
+    std::string metrics_endpoint;
+    // Comma-separated stream ids to subscribe to (empty = all; pubsub only). Received
+    // frames wait in per-stream queues of stream_queue_depth, served round-robin.
+    std::string streams;
+    int stream_queue_depth = 16;
 };
 
 // Parameters consumed by the data logger binary.
@@ -39,6 +131,37 @@ struct DataLoggerConfig {
     std::filesystem::path db_path;
     std::filesystem::path raw_image_dir;
     std::filesystem::path annotated_image_dir;
+    // Frames buffered between the receiver and the file/DB writer threads.
+    int queue_depth = 256;
+    int stats_interval_ms = 5000;
+    // Payload files: "auto" | "io_uring" | "posix", completed in batches of write_batch frames.
+    std::string payload_backend = "auto";
+    int write_batch = 32;
+    bool fdatasync = false;  // Sync each batch before its rows are committed
+    // "files" writes one file per payload; "segments" appends them to rolling segment
+    // files under segment_dir and records (segment, offset, length) in the database.
+    std::string storage = "files";
+    std::filesystem::path segment_dir;
+    int segment_max_mb = 1024;
+    // Render overlays for frames the extractor flagged with "annotate" but did not draw.
+    bool render_annotations = true;
+    // Inserts commit every batch_size rows or flush_interval_ms, whichever comes first.
+    int batch_size = 64;
+    int flush_interval_ms = 200;
+    std::string sqlite_journal_mode = "WAL";
+    std::string sqlite_synchronous = "NORMAL";
+    int sqlite_cache_size = -16384;  // Negative values are KiB (SQLite convention)
+    // In "pushpull" the logger binds sub_endpoint and fans in from every extractor.
+    std::string distribution = "pubsub";
+    std::string metrics_endpoint;
+    // Comma-separated stream ids to subscribe to (empty = all; pubsub only).
+    std::string streams;
+};
+
+// Parameters consumed by the fused pipeline binary, on top of the stages' own.
+struct PipelineConfig {
+    // The one scrape endpoint for every stage's series; the stages' own stay off.
+    std::string metrics_endpoint;
 };
 
 struct AppConfig {
@@ -46,6 +169,7 @@ struct AppConfig {
     ImageGeneratorConfig generator;
     FeatureExtractorConfig extractor;
     DataLoggerConfig logger;
+    PipelineConfig pipeline;
 };
 
 // Populate the strongly typed config structs from the dotenv loader.
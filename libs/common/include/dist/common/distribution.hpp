@@ -0,0 +1,22 @@
+#pragma once
+
+#include <zmq.hpp>
+
+#include <optional>
+#include <string_view>
+
+namespace dist::common {
+
+// How frames travel between stages. pubsub broadcasts every frame to every
+// consumer; pushpull load-balances frames across a fleet of consumers.
+enum class Distribution { pubsub, pushpull };
+
+// Parse "pubsub" / "pushpull" (nullopt for anything else).
+[[nodiscard]] std::optional<Distribution> parse_distribution(std::string_view value);
+[[nodiscard]] std::string_view to_string(Distribution distribution);
+
+// Socket types for the sending and receiving side of a link.
+[[nodiscard]] zmq::socket_type sender_socket_type(Distribution distribution);
+[[nodiscard]] zmq::socket_type receiver_socket_type(Distribution distribution);
+
+}  // namespace dist::common
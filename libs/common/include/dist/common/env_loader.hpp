@@ -24,6 +24,8 @@ class EnvLoader {
     [[nodiscard]] std::optional<std::string> get(std::string_view key) const;
     [[nodiscard]] std::string get_or(std::string_view key,
                                      std::string_view fallback) const;
+    // Override one key after loading (e.g. the inproc endpoints of a fused pipeline).
+    void set(std::string key, std::string value);
 
   private:
     static std::string trim(std::string_view in);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace dist::common {
+
+// Per-stream FIFOs served round-robin, so one busy stream cannot starve the others.
+// Each stream holds at most `depth` items; pushing past that evicts the stream's own
+// oldest item, which is returned so the caller can count the drop. Single-threaded.
+template <typename T>
+class FairQueue {
+  public:
+    explicit FairQueue(std::size_t depth) : depth_(depth == 0 ? 1 : depth) {}
+
+    std::optional<T> push(const std::string& stream, T item) {
+        auto& queue = queues_[stream];
+        std::optional<T> evicted;
+        if (queue.size() >= depth_) {
+            evicted = std::move(queue.front());
+            queue.pop_front();
+            --size_;
+        } else if (queue.empty()) {
+            turns_.push_back(stream);
+        }
+        queue.push_back(std::move(item));
+        ++size_;
+        return evicted;
+    }
+
+    // Oldest item of the stream whose turn it is, with that stream's id.
+    std::optional<std::pair<std::string, T>> pop() {
+        if (turns_.empty()) {
+            return std::nullopt;
+        }
+        std::string stream = std::move(turns_.front());
+        turns_.pop_front();
+        auto& queue = queues_[stream];
+        std::pair<std::string, T> item{stream, std::move(queue.front())};
+        queue.pop_front();
+        --size_;
+        if (!queue.empty()) {
+            turns_.push_back(std::move(stream));
+        }
+        return item;
+    }
+
+    [[nodiscard]] std::size_t size() const { return size_; }
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+
+  private:
+    const std::size_t depth_;
+    std::map<std::string, std::deque<T>> queues_;
+    std::deque<std::string> turns_;  // Streams with queued items, in service order
+    std::size_t size_ = 0;
+};
+
+}  // namespace dist::common
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string_view>
+
+namespace dist::common {
+
+// Canonical "encoding" header value for a file extension ("" when unsupported).
+[[nodiscard]] std::string_view encoding_for_extension(std::string_view extension);
+
+// File extension (with dot) used when persisting a payload of the given encoding.
+[[nodiscard]] std::string_view extension_for_encoding(std::string_view encoding);
+
+// True for container formats cv::imdecode understands (png, jpeg, bmp, tiff);
+// "raw" pixel buffers are deliberately excluded.
+[[nodiscard]] bool is_image_codec(std::string_view encoding);
+
+}  // namespace dist::common
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <zmq.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dist::common {
+
+// Monotonic count (frames, bytes, drops). Updates are a relaxed atomic add.
+class Counter {
+  public:
+    void inc(std::uint64_t amount = 1) { value_.fetch_add(amount, std::memory_order_relaxed); }
+    [[nodiscard]] std::uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+  private:
+    std::atomic<std::uint64_t> value_{0};
+};
+
+// Point-in-time value (queue depths, in-flight work).
+class Gauge {
+  public:
+    void set(double value) { value_.store(value, std::memory_order_relaxed); }
+    void add(double delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+    [[nodiscard]] double value() const { return value_.load(std::memory_order_relaxed); }
+
+  private:
+    std::atomic<double> value_{0.0};
+};
+
+// Fixed-bucket distribution (latencies in seconds, sizes in bytes); `bounds` are the
+// inclusive upper edges, ascending, with +Inf implied.
+class Histogram {
+  public:
+    explicit Histogram(std::vector<double> bounds);
+
+    void observe(double value);
+
+    [[nodiscard]] const std::vector<double>& bounds() const { return bounds_; }
+    // Non-cumulative count of bucket `index` (bounds().size() is the +Inf bucket).
+    [[nodiscard]] std::uint64_t bucket(std::size_t index) const;
+    [[nodiscard]] std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    [[nodiscard]] double sum() const { return sum_.load(std::memory_order_relaxed); }
+
+  private:
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> buckets_;
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<double> sum_{0.0};
+};
+
+// 100 us .. 10 s, for per-stage latencies.
+[[nodiscard]] std::vector<double> latency_buckets();
+// 1 KiB .. 64 MiB in powers of four, for payload sizes.
+[[nodiscard]] std::vector<double> byte_buckets();
+
+// Process-wide set of named metrics rendered in the Prometheus text format. Metrics are
+// registered once (at startup or lazily) and live as long as the registry, so the
+// returned references can be cached wherever the hot path needs them. `labels` is a
+// preformatted label set such as `part="image"`; metrics sharing a name form a family.
+class MetricsRegistry {
+  public:
+    Counter& counter(std::string_view name, std::string_view help, std::string_view labels = {});
+    Gauge& gauge(std::string_view name, std::string_view help, std::string_view labels = {});
+    Histogram& histogram(std::string_view name,
+                         std::string_view help,
+                         std::vector<double> bounds,
+                         std::string_view labels = {});
+    // Sampled at scrape time, for values another component already tracks.
+    void gauge_callback(std::string_view name,
+                        std::string_view help,
+                        std::function<double()> sample,
+                        std::string_view labels = {});
+    void counter_callback(std::string_view name,
+                          std::string_view help,
+                          std::function<double()> sample,
+                          std::string_view labels = {});
+    // Replace the callbacks under `prefix` by their current value, for a component that
+    // stops while the registry lives on (a stage of the fused pipeline).
+    void freeze_callbacks(std::string_view prefix);
+
+    [[nodiscard]] std::string render() const;
+
+  private:
+    enum class Kind { counter, gauge, histogram };
+    struct Entry {
+        std::string name;
+        std::string help;
+        std::string labels;
+        Kind kind = Kind::counter;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+        std::function<double()> sample;
+    };
+
+    Entry* find(std::string_view name, std::string_view labels);
+    Entry& add(std::string_view name, std::string_view help, std::string_view labels, Kind kind);
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Entry>> entries_;
+};
+
+// The registry every component of this process reports into.
+[[nodiscard]] MetricsRegistry& metrics();
+
+// Freezes the callbacks under a prefix on scope exit; declare it after whatever they
+// sample so it runs first.
+class CallbackFreeze {
+  public:
+    explicit CallbackFreeze(std::string prefix) : prefix_(std::move(prefix)) {}
+    ~CallbackFreeze() { metrics().freeze_callbacks(prefix_); }
+
+    CallbackFreeze(const CallbackFreeze&) = delete;
+    CallbackFreeze& operator=(const CallbackFreeze&) = delete;
+
+  private:
+    std::string prefix_;
+};
+
+// Counts frame ids missing from a stream that should be contiguous, which is how SUB
+// high-water-mark drops (otherwise silent) become visible. An id at or below the last
+// one (publisher restart, fan-in from several peers) only re-bases the count.
+class SequenceGaps {
+  public:
+    explicit SequenceGaps(Counter& missing) : missing_(missing) {}
+
+    void observe(std::int64_t id) {
+        if (last_ >= 0 && id > last_ + 1) {
+            missing_.inc(static_cast<std::uint64_t>(id - last_ - 1));
+        }
+        last_ = id;
+    }
+
+  private:
+    Counter& missing_;
+    std::int64_t last_ = -1;
+};
+
+// Serves `registry` on `GET /metrics` (and `GET /`; other requests get a 404) over a
+// ZMQ_STREAM socket, which speaks raw TCP, so Prometheus can scrape it without an HTTP
+// library. Runs on its own thread with its own socket; bind failures are logged and
+// leave the server stopped.
+class MetricsServer {
+  public:
+    MetricsServer(zmq::context_t& context, std::string endpoint, MetricsRegistry& registry);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    void start();
+    void stop();
+
+  private:
+    void run();
+
+    zmq::context_t& context_;
+    const std::string endpoint_;
+    MetricsRegistry& registry_;
+    std::atomic_bool stop_flag_{false};
+    std::thread thread_;
+};
+
+}  // namespace dist::common
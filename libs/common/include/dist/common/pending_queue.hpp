@@ -0,0 +1,212 @@
+#pragma once
+
+#include <zmq.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dist::common {
+
+// Which frame gives way when a pending queue is full: the oldest queued one, the one
+// arriving, or the lowest-priority one (oldest first among equals).
+enum class DropPolicy { oldest, newest, priority };
+
+// Parse "oldest" / "newest" / "priority" (nullopt for anything else).
+[[nodiscard]] std::optional<DropPolicy> parse_drop_policy(std::string_view value);
+[[nodiscard]] std::string_view to_string(DropPolicy policy);
+
+// Parks message parts in files under a directory so a backlog can outgrow memory. Each
+// frame is one file, removed once it is read back or discarded; leftovers from an earlier
+// run are removed on construction. Single-threaded.
+class SpillStore {
+  public:
+    SpillStore(std::filesystem::path dir, std::size_t max_bytes);
+    ~SpillStore();
+
+    SpillStore(const SpillStore&) = delete;
+    SpillStore& operator=(const SpillStore&) = delete;
+
+    // Id of the stored frame; nullopt when it would exceed the budget or the write failed.
+    [[nodiscard]] std::optional<std::uint64_t> write(const std::vector<zmq::message_t>& parts);
+    // Load and remove a stored frame; nullopt if its file cannot be read back.
+    [[nodiscard]] std::optional<std::vector<zmq::message_t>> read(std::uint64_t id);
+    void discard(std::uint64_t id);
+
+    [[nodiscard]] bool has_room() const { return bytes_ < max_bytes_; }
+    [[nodiscard]] std::size_t bytes() const { return bytes_; }
+
+  private:
+    [[nodiscard]] std::filesystem::path path_for(std::uint64_t id) const;
+
+    const std::filesystem::path dir_;
+    const std::size_t max_bytes_;
+    std::size_t bytes_ = 0;
+    std::uint64_t next_id_ = 0;
+    std::map<std::uint64_t, std::size_t> sizes_;
+};
+
+struct PendingLimits {
+    std::size_t max_frames = 100;
+    std::size_t max_bytes = 0;  // Memory held by queued frames; 0 = frame count only
+    DropPolicy policy = DropPolicy::oldest;
+};
+
+// FIFO of frames waiting for a slow or absent consumer, bounded by frame count and by
+// the bytes it holds in memory. `T` keeps its message parts in a `parts` member; the
+// `bytes` given to push() is what the frame pins (0 for parts borrowed from memory that
+// outlives the queue, which therefore never spill). A frame that does not fit in memory
+// goes to the spill store when there is one; once that is full as well, or the frame
+// count is reached, the drop policy picks the frames that give way. Single-threaded.
+template <typename T>
+class PendingQueue {
+  public:
+    explicit PendingQueue(PendingLimits limits, SpillStore* spill = nullptr)
+        : limits_(limits), spill_(spill) {
+        limits_.max_frames = std::max<std::size_t>(limits_.max_frames, 1);
+    }
+
+    // Enqueue `item`; returns how many frames (queued or `item` itself) were dropped.
+    std::size_t push(T item, std::size_t bytes, int priority = 0) {
+        std::size_t dropped = 0;
+        Entry incoming{std::move(item), bytes, priority, std::nullopt};
+        while (entries_.size() >= limits_.max_frames) {
+            if (!evict(incoming, false)) {
+                return dropped + 1;
+            }
+            ++dropped;
+        }
+        while (!fits_in_memory(bytes)) {
+            if (spill_ != nullptr && bytes > 0) {
+                if (auto id = spill_->write(incoming.item.parts)) {
+                    incoming.spill_id = id;
+                    incoming.item.parts.clear();
+                    break;
+                }
+            }
+            if (!evict(incoming, true)) {
+                return dropped + 1;
+            }
+            ++dropped;
+        }
+        if (!incoming.spill_id) {
+            memory_bytes_ += bytes;
+        }
+        entries_.push_back(std::move(incoming));
+        return dropped;
+    }
+
+    // Oldest frame, read back from disk first if it was spilled; nullptr when empty. A
+    // spilled frame that cannot be read back is skipped and counted in lost().
+    T* front() {
+        while (!entries_.empty()) {
+            auto& entry = entries_.front();
+            if (!entry.spill_id) {
+                return &entry.item;
+            }
+            if (auto parts = spill_->read(*entry.spill_id)) {
+                entry.item.parts = std::move(*parts);
+                entry.spill_id.reset();
+                memory_bytes_ += entry.bytes;
+                return &entry.item;
+            }
+            entries_.pop_front();
+            ++lost_;
+        }
+        return nullptr;
+    }
+
+    void pop_front() {
+        if (!entries_.empty()) {
+            erase(entries_.begin());
+        }
+    }
+
+    // True while a push() would have to drop a frame to make room.
+    [[nodiscard]] bool full() const {
+        return entries_.size() >= limits_.max_frames ||
+               (limits_.max_bytes > 0 && memory_bytes_ >= limits_.max_bytes &&
+                (spill_ == nullptr || !spill_->has_room()));
+    }
+
+    [[nodiscard]] std::size_t size() const { return entries_.size(); }
+    [[nodiscard]] bool empty() const { return entries_.empty(); }
+    [[nodiscard]] std::size_t memory_bytes() const { return memory_bytes_; }
+    [[nodiscard]] std::size_t lost() const { return lost_; }
+
+  private:
+    struct Entry {
+        T item;
+        std::size_t bytes = 0;
+        int priority = 0;
+        std::optional<std::uint64_t> spill_id;
+    };
+    using Iterator = typename std::deque<Entry>::iterator;
+
+    [[nodiscard]] bool fits_in_memory(std::size_t bytes) const {
+        // A frame larger than the whole budget still queues behind an empty memory.
+        return limits_.max_bytes == 0 || memory_bytes_ == 0 ||
+               memory_bytes_ + bytes <= limits_.max_bytes;
+    }
+
+    // Drop one queued frame per the policy; false when `incoming` is the one to go.
+    // `for_memory` only considers frames held in memory, since only they free any.
+    bool evict(const Entry& incoming, bool for_memory) {
+        const auto candidate = [for_memory](const Entry& entry) {
+            return !for_memory || (!entry.spill_id && entry.bytes > 0);
+        };
+        auto victim = entries_.end();
+        switch (limits_.policy) {
+            case DropPolicy::newest:
+                return false;
+            case DropPolicy::oldest:
+                for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+                    if (candidate(*it)) {
+                        victim = it;
+                        break;
+                    }
+                }
+                break;
+            case DropPolicy::priority:
+                for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+                    if (candidate(*it) &&
+                        (victim == entries_.end() || it->priority < victim->priority)) {
+                        victim = it;
+                    }
+                }
+                if (victim != entries_.end() && incoming.priority < victim->priority) {
+                    return false;
+                }
+                break;
+        }
+        if (victim == entries_.end()) {
+            return false;
+        }
+        erase(victim);
+        return true;
+    }
+
+    void erase(Iterator it) {
+        if (it->spill_id) {
+            spill_->discard(*it->spill_id);
+        } else {
+            memory_bytes_ -= it->bytes;
+        }
+        entries_.erase(it);
+    }
+
+    PendingLimits limits_;
+    SpillStore* spill_;
+    std::deque<Entry> entries_;
+    std::size_t memory_bytes_ = 0;
+    std::size_t lost_ = 0;
+};
+
+}  // namespace dist::common
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <zmq.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace dist::common {
+
+// Single-threaded event loop over zmq::poll: socket readiness handlers, periodic
+// timers, and a thread-safe wake() for work finished elsewhere (worker results,
+// monitor events). The poll sleeps exactly until the next socket event, timer or
+// wake-up, so there is neither a receive timeout nor a busy-poll interval.
+class Reactor {
+  public:
+    using Handler = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+
+    // Throws std::system_error when the wake-up pipe cannot be created.
+    Reactor();
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    // `events` is a ZMQ_POLLIN / ZMQ_POLLOUT mask; 0 registers the socket idle. Returns
+    // the id used by set_events(). The socket must outlive the reactor's run().
+    std::size_t add_socket(zmq::socket_t& socket, short events, Handler handler);
+    void set_events(std::size_t id, short events);
+
+    // Runs `handler` every `interval` (hence also first after one interval).
+    void add_timer(std::chrono::milliseconds interval, Handler handler);
+
+    // Runs before every poll; the place to recompute socket interest from state.
+    void on_prepare(Handler handler) { prepare_ = std::move(handler); }
+    // Runs on the loop thread after wake() was called from any thread.
+    void on_wake(Handler handler) { wake_handler_ = std::move(handler); }
+    void wake();
+
+    // Dispatch until stop() or `keep_running` turns false. `keep_running` is checked
+    // at least every `stop_check` even when nothing happens (signal flags do not wake).
+    void run(const std::atomic_bool& keep_running,
+             std::chrono::milliseconds stop_check = std::chrono::milliseconds(500));
+    void stop();
+
+  private:
+    struct SocketEntry {
+        zmq::socket_t* socket = nullptr;
+        short events = 0;
+        Handler handler;
+    };
+    struct Timer {
+        std::chrono::milliseconds interval{};
+        Clock::time_point due;
+        Handler handler;
+    };
+
+    void drain_wake_pipe();
+
+    std::vector<SocketEntry> sockets_;
+    std::vector<Timer> timers_;
+    Handler prepare_;
+    Handler wake_handler_;
+    int wake_read_fd_ = -1;
+    int wake_write_fd_ = -1;
+    std::atomic_bool wake_pending_{false};
+    std::atomic_bool stopped_{false};
+};
+
+}  // namespace dist::common
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace dist::common {
+
+// Where one payload lives inside the segment files; `offset` points past the record
+// header at the payload bytes themselves.
+struct SegmentLocation {
+    std::uint32_t segment_id = 0;
+    std::uint64_t offset = 0;
+    std::uint64_t length = 0;
+};
+
+enum class SegmentRecordKind : std::uint32_t { raw = 1, annotated = 2 };
+
+// Prefix written in front of every payload so a segment can be re-indexed (or checked)
+// without the database.
+struct SegmentRecordHeader {
+    std::uint32_t magic = 0;
+    std::uint32_t kind = 0;
+    std::int64_t frame_id = -1;
+    std::uint64_t length = 0;
+};
+static_assert(sizeof(SegmentRecordHeader) == 24, "SegmentRecordHeader layout changed");
+
+inline constexpr std::uint32_t kSegmentRecordMagic = 0x47455344;  // "DSEG" little-endian
+
+// `segment_000042.dat` under `dir`.
+[[nodiscard]] std::filesystem::path segment_path(const std::filesystem::path& dir,
+                                                 std::uint32_t segment_id);
+
+// Appends payloads to large rolling segment files instead of one file per frame.
+// Each start opens a fresh segment after the highest one on disk, so a torn tail
+// from a crash is never appended to. Not thread-safe.
+class SegmentWriter {
+  public:
+    // Throws std::runtime_error when the directory or first segment cannot be created.
+    SegmentWriter(std::filesystem::path dir, std::uint64_t max_segment_bytes);
+    ~SegmentWriter();
+
+    SegmentWriter(const SegmentWriter&) = delete;
+    SegmentWriter& operator=(const SegmentWriter&) = delete;
+
+    // Header and payload go out in one writev; nullopt on I/O failure.
+    std::optional<SegmentLocation> append(std::int64_t frame_id,
+                                          SegmentRecordKind kind,
+                                          const void* data,
+                                          std::size_t size);
+
+    // fdatasync the open segment (closed segments were synced when they rolled over).
+    bool sync();
+
+    [[nodiscard]] std::uint32_t current_segment() const { return segment_id_; }
+
+  private:
+    bool open_segment(std::uint32_t segment_id);
+
+    std::filesystem::path dir_;
+    std::uint64_t max_segment_bytes_;
+    std::uint32_t segment_id_ = 0;
+    std::uint64_t segment_bytes_ = 0;
+    int fd_ = -1;
+};
+
+// Read-only view over segment files. Segments are mapped on first use and remapped
+// when a read lands past the mapped size (the writer may still be appending).
+class SegmentReader {
+  public:
+    explicit SegmentReader(std::filesystem::path dir);
+    ~SegmentReader();
+
+    SegmentReader(const SegmentReader&) = delete;
+    SegmentReader& operator=(const SegmentReader&) = delete;
+
+    // Zero-copy span into the mapping, valid until the reader is destroyed (outgrown
+    // mappings are retired, not unmapped); nullopt if the location is out of range or
+    // its record header does not match.
+    std::optional<std::span<const std::uint8_t>> read(const SegmentLocation& location);
+
+  private:
+    struct Mapping {
+        const std::uint8_t* base = nullptr;
+        std::size_t size = 0;
+    };
+
+    const Mapping* map_segment(std::uint32_t segment_id, std::uint64_t min_size);
+
+    std::filesystem::path dir_;
+    std::map<std::uint32_t, Mapping> mappings_;
+    std::vector<Mapping> retired_;
+};
+
+}  // namespace dist::common
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <zmq.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dist::common {
+
+// "shm://<name>" endpoints keep payloads off the socket for stages on one host: the
+// sender copies each large part into its shared-memory ring once and sends a small
+// descriptor over "ipc:///tmp/dist-shm-<name>.ipc" instead; receivers map the ring and
+// hand the bytes on without copying. Names are letters, digits, '-' and '_' (max 32).
+[[nodiscard]] bool is_shm_endpoint(std::string_view endpoint);
+
+// What the ZeroMQ socket binds or connects to: the ipc descriptor channel for a valid
+// shm endpoint, `endpoint` itself otherwise (so a bad one fails at bind/connect).
+[[nodiscard]] std::string zmq_endpoint(std::string_view endpoint);
+
+// Sending side of one shm endpoint. Owns the ring segment "/dist-<name>-<pid>" (one per
+// sender, so several PUSH peers can share an endpoint) and reuses its oldest space once
+// no receiver still maps it. A part that does not fit, because it is too large or the
+// space is still mapped downstream, is sent inline, so delivery never waits on the ring.
+// Receivers must share the sender's PID namespace for a crashed one to be detected.
+// Not thread-safe.
+class ShmWriter {
+  public:
+    static constexpr std::size_t kMinPartBytes = 16 * 1024;  // Smaller parts stay inline
+
+    // Throws std::runtime_error when the segment cannot be created.
+    ShmWriter(std::string_view endpoint, std::size_t capacity);
+    ~ShmWriter();
+
+    ShmWriter(const ShmWriter&) = delete;
+    ShmWriter& operator=(const ShmWriter&) = delete;
+
+    // Like send_parts(): every part is sent and `parts` stays intact for a retry.
+    bool send(zmq::socket_t& socket,
+              std::vector<zmq::message_t>& parts,
+              zmq::send_flags flags = zmq::send_flags::none);
+
+    [[nodiscard]] const std::string& segment() const { return segment_; }
+
+  private:
+    struct Block {
+        std::uint64_t offset = 0;
+        std::uint64_t size = 0;
+        std::uint64_t sequence = 0;
+    };
+
+    // Descriptor for a copy of `part` in the ring; nullopt when it has to go inline.
+    std::optional<zmq::message_t> publish(const zmq::message_t& part);
+    // True when a receiver still maps a block up to `sequence` (dead receivers are freed).
+    bool pinned(std::uint64_t sequence);
+
+    std::string segment_;
+    void* base_ = nullptr;
+    std::size_t mapped_bytes_ = 0;
+    std::uint8_t* data_ = nullptr;
+    std::uint64_t capacity_ = 0;
+    std::uint64_t head_ = 0;
+    std::uint64_t next_sequence_ = 1;
+    std::deque<Block> live_;  // Oldest first
+};
+
+// Receiving side: turns descriptors back into messages over the sender's ring, mapping
+// each segment on first use. Thread-safe; resolved messages may be released anywhere.
+class ShmReader {
+  public:
+    ShmReader() = default;
+    ~ShmReader();
+
+    ShmReader(const ShmReader&) = delete;
+    ShmReader& operator=(const ShmReader&) = delete;
+
+    // `part` unchanged unless it is a descriptor; nullopt when the ring space was reused
+    // before the descriptor was read (the frame is lost, like a high-water-mark drop).
+    [[nodiscard]] std::optional<zmq::message_t> resolve(zmq::message_t part);
+
+    struct Segment;
+
+  private:
+    std::shared_ptr<Segment> open(const std::string& name);
+
+    std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<Segment>> segments_;
+};
+
+// The reader every receiving socket of this process resolves through.
+[[nodiscard]] ShmReader& shm_reader();
+
+}  // namespace dist::common
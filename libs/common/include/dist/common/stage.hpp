@@ -0,0 +1,23 @@
+#pragma once
+
+#include <zmq.hpp>
+
+#include <map>
+#include <string>
+
+namespace dist::common {
+
+// How a stage's run() is hosted: alone, as its binary's main() (the defaults), or as one
+// thread of a fused pipeline that shares its ZeroMQ context, so inproc:// endpoints reach
+// the other stages, and handles signals itself.
+struct StageRuntime {
+    zmq::context_t* context = nullptr;  // Null: the stage creates its own
+    bool handle_signals = true;
+    // False: the host has set the log level, buffer pool budget and OpenCV thread count
+    // once for every stage, so run() leaves them alone.
+    bool configure_process = true;
+    // Applied over the loaded .env, e.g. the fused pipeline's inproc endpoints.
+    std::map<std::string, std::string> env_overrides;
+};
+
+}  // namespace dist::common
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <zmq.hpp>
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dist/common/metrics.hpp"
+
+namespace dist::common {
+
+// Every message travels as [stream topic][header][payload parts...]. The topic is the
+// stream id plus a '/' terminator, so a SUB subscription to "cam1/" does not also match
+// "cam10/". Ids are [A-Za-z0-9_.-]+; single-camera setups use kDefaultStream.
+inline constexpr std::string_view kDefaultStream = "default";
+
+[[nodiscard]] bool valid_stream_id(std::string_view id);
+[[nodiscard]] std::string stream_topic(std::string_view id);
+// Stream id carried by a topic part; nullopt if the part is not a topic.
+[[nodiscard]] std::optional<std::string> stream_from_topic(std::string_view topic);
+// Metric label set (`stream="cam0"`) for per-stream series.
+[[nodiscard]] std::string stream_label(std::string_view id);
+
+// "cam0,cam1" -> {"cam0", "cam1"}; invalid ids are logged against `setting` and skipped.
+// An empty list means every stream.
+[[nodiscard]] std::vector<std::string> parse_stream_list(std::string_view list,
+                                                         std::string_view setting);
+
+// Subscribe a SUB socket to `streams`, or to everything when the list is empty.
+void subscribe_streams(zmq::socket_t& socket, const std::vector<std::string>& streams);
+
+// SequenceGaps per stream, since frame ids count per stream. Each stream reports into
+// its own `name{stream="..."}` counter, registered on first sight. Single-threaded.
+class StreamGaps {
+  public:
+    StreamGaps(MetricsRegistry& registry, std::string name, std::string help);
+
+    void observe(const std::string& stream, std::int64_t id);
+
+    // Missing frames summed over every stream seen so far.
+    [[nodiscard]] std::uint64_t total() const;
+
+  private:
+    struct Entry {
+        Counter& missing;
+        SequenceGaps gaps;
+    };
+
+    MetricsRegistry& registry_;
+    const std::string name_;
+    const std::string help_;
+    std::map<std::string, Entry> streams_;
+};
+
+}  // namespace dist::common
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <zmq.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace dist::common {
+
+// Counts peers attached to a sending socket from its monitor events, so a sender can
+// tell "nobody is listening" (PUB drops silently, PUSH has no pipe) from "listener is
+// busy", and block until a peer arrives instead of sleeping on a fixed backoff.
+class SubscriberMonitor : public zmq::monitor_t {
+  public:
+    // `address` is the inproc endpoint the monitor binds; unique per socket.
+    explicit SubscriberMonitor(std::string address);
+    ~SubscriberMonitor() override;
+
+    SubscriberMonitor(const SubscriberMonitor&) = delete;
+    SubscriberMonitor& operator=(const SubscriberMonitor&) = delete;
+
+    // Called from the monitor thread after the peer count changes (e.g. Reactor::wake).
+    // Set before start().
+    void on_change(std::function<void()> callback) { on_change_ = std::move(callback); }
+
+    void start(zmq::socket_t& socket);
+    void stop();
+
+    [[nodiscard]] bool has_subscriber() const { return sub_count_.load() > 0; }
+
+    // Returns as soon as a peer is attached (true) or once `timeout` passes (false).
+    bool wait_for_subscriber(std::chrono::milliseconds timeout);
+
+  protected:
+    void on_event_connected(const zmq_event_t&, const char*) override { adjust(1); }
+    void on_event_accepted(const zmq_event_t&, const char*) override { adjust(1); }
+    void on_event_disconnected(const zmq_event_t&, const char*) override { adjust(-1); }
+    void on_event_closed(const zmq_event_t&, const char*) override { adjust(-1); }
+
+  private:
+    void adjust(int delta);
+
+    const std::string address_;
+    std::atomic_int sub_count_{0};
+    std::atomic_bool stop_flag_{false};
+    std::thread monitor_thread_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::function<void()> on_change_;
+};
+
+}  // namespace dist::common
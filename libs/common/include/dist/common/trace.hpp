@@ -0,0 +1,75 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace dist::common {
+
+// Stage boundaries stamped on every frame, in pipeline order. Each stamp marks the end
+// of its stage: `read` once the source bytes are in memory (file or cache), `encode` once
+// the payload is built (decoding the file included, in the reencode and raw modes),
+// `send` when the frame is handed to the socket, `persist` when the row insert completes.
+enum class TraceStage : std::uint8_t {
+    read,
+    encode,
+    send,
+    receive,  // Extractor input
+    decode,
+    detect,
+    serialize,
+    logged,  // Logger input
+    persist,
+};
+inline constexpr std::size_t kTraceStageCount = 9;
+
+[[nodiscard]] std::string_view to_string(TraceStage stage);
+
+// Nanoseconds since the Unix epoch (UTC). Wall-clock rather than steady so stamps from
+// different processes line up; across hosts the durations include their clock offset.
+[[nodiscard]] std::int64_t trace_clock_ns();
+
+// Per-frame stamps; 0 means the stage was not recorded (older peers, skipped stages).
+struct FrameTrace {
+    std::array<std::int64_t, kTraceStageCount> ns{};
+
+    void mark(TraceStage stage) { ns[static_cast<std::size_t>(stage)] = trace_clock_ns(); }
+    void set(TraceStage stage, std::int64_t value) { ns[static_cast<std::size_t>(stage)] = value; }
+    [[nodiscard]] std::int64_t at(TraceStage stage) const {
+        return ns[static_cast<std::size_t>(stage)];
+    }
+    [[nodiscard]] bool empty() const;
+
+    // `to` - `from`, or nullopt if either stamp is missing.
+    [[nodiscard]] std::optional<std::int64_t> between(TraceStage from, TraceStage to) const;
+};
+
+// Durations reported for a trace, between consecutive stage boundaries plus the
+// end-to-end total; `name` matches the frame_traces column without its `_ns` suffix.
+struct TraceSpan {
+    std::string_view name;
+    TraceStage from;
+    TraceStage to;
+};
+inline constexpr std::array<TraceSpan, 9> kTraceSpans{{
+    {"encode", TraceStage::read, TraceStage::encode},
+    {"send", TraceStage::encode, TraceStage::send},
+    {"transit_in", TraceStage::send, TraceStage::receive},
+    {"decode", TraceStage::receive, TraceStage::decode},
+    {"detect", TraceStage::decode, TraceStage::detect},
+    {"serialize", TraceStage::detect, TraceStage::serialize},
+    {"transit_out", TraceStage::serialize, TraceStage::logged},
+    {"persist", TraceStage::logged, TraceStage::persist},
+    {"total", TraceStage::read, TraceStage::persist},
+}};
+
+// {"read": ns, "encode": ns, ...} with unrecorded stages left out; parsing ignores
+// unknown keys so peers can add stages.
+[[nodiscard]] nlohmann::json trace_to_json(const FrameTrace& trace);
+[[nodiscard]] FrameTrace trace_from_json(const nlohmann::json& json);
+
+}  // namespace dist::common
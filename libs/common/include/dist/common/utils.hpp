@@ -1,6 +1,9 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <string_view>
 
@@ -14,6 +17,13 @@ namespace dist::common {
 // Current UTC timestamp in ISO-8601 "YYYY-MM-DDTHH:MM:SSZ" format.
 [[nodiscard]] std::string now_iso8601();
 
+// Milliseconds since the Unix epoch for a UTC "YYYY-MM-DDTHH:MM:SS[.fff]Z" timestamp.
+[[nodiscard]] std::optional<std::int64_t> iso8601_to_epoch_ms(std::string_view text);
+
+// FNV-1a-style 64-bit hash over 8-byte words (then the tail bytes). Fast enough to key caches on
+// multi-megabyte payloads; not a cryptographic hash.
+[[nodiscard]] std::uint64_t content_hash(const void* data, std::size_t size);
+
 // Install SIGINT/SIGTERM handlers that flip the provided atomic flag to false.
 // This lets every binary reuse the same shutdown plumbing.
 void install_signal_handlers(std::atomic_bool& keep_running_flag);
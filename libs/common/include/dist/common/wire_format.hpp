@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+#include "dist/common/trace.hpp"
+
+namespace dist::common::wire {
+
+// Binary framing between the extractor and the logger:
+// [FrameHeader][PackedKeypoint x keypoint_count][descriptors][raw image][optional annotated].
+// Structs are copied byte-for-byte on little-endian hosts; bump kFrameVersion on any change.
+inline constexpr std::uint32_t kFrameMagic = 0x46534944;  // "DISF"
+inline constexpr std::uint16_t kFrameVersion = 4;
+
+// FrameHeader::flags bits.
+inline constexpr std::uint16_t kFlagAnnotate = 1U << 0;  // Logger should render the overlay
+inline constexpr std::uint16_t kFlagReused = 1U << 1;    // Features copied from a cached frame
+
+// Fixed-layout processed-frame header. Every field is naturally aligned so the
+// layout has no padding and can be read straight out of a message buffer.
+struct FrameHeader {
+    std::uint32_t magic = kFrameMagic;
+    std::uint16_t version = kFrameVersion;
+    std::uint16_t flags = 0;
+    std::int64_t frame_id = -1;
+    std::int64_t loop_iteration = 0;
+    std::int32_t width = 0;
+    std::int32_t height = 0;
+    std::int32_t channels = 0;
+    std::int32_t cv_type = -1;  // Raw payloads only
+    std::uint64_t step = 0;
+    std::uint64_t raw_bytes = 0;
+    std::uint64_t image_bytes = 0;
+    std::uint64_t keypoint_count = 0;
+    std::int32_t descriptor_rows = 0;
+    std::int32_t descriptor_cols = 0;
+    std::int32_t descriptor_elem_size = 0;
+    std::int32_t descriptor_type = 0;      // Stored format: CV_32F, CV_16F or CV_8U
+    std::uint64_t descriptors_bytes = 0;   // On the wire (after descriptor_compression)
+    std::uint64_t descriptors_raw_bytes = 0;
+    std::uint64_t annotated_bytes = 0;
+    // FrameTrace stamps (UTC ns, 0 = not recorded), indexed by TraceStage.
+    std::int64_t trace_ns[kTraceStageCount] = {};
+    // NUL-padded strings; a full-width value is not terminated.
+    char source_timestamp[32] = {};
+    char processed_timestamp[32] = {};
+    char encoding[16] = {};
+    char compression[16] = {};
+    char descriptor_compression[16] = {};
+    char detector[16] = {};  // Backend that produced the keypoints ("sift", "orb", ...)
+    char filename[256] = {};
+};
+
+// cv::KeyPoint without the OpenCV dependency.
+struct PackedKeypoint {
+    float x = 0.0F;
+    float y = 0.0F;
+    float size = 0.0F;
+    float angle = -1.0F;
+    float response = 0.0F;
+    std::int32_t octave = 0;
+    std::int32_t class_id = -1;
+};
+
+static_assert(std::endian::native == std::endian::little, "wire format assumes little-endian");
+static_assert(std::is_trivially_copyable_v<FrameHeader> && std::is_standard_layout_v<FrameHeader>);
+static_assert(std::is_trivially_copyable_v<PackedKeypoint>);
+static_assert(sizeof(FrameHeader) == 568, "FrameHeader layout changed; bump kFrameVersion");
+static_assert(sizeof(PackedKeypoint) == 28, "PackedKeypoint layout changed; bump kFrameVersion");
+
+template <std::size_t N>
+void set_field(char (&dst)[N], std::string_view value) {
+    const std::size_t count = std::min(value.size(), N);
+    std::memcpy(dst, value.data(), count);
+    std::memset(dst + count, 0, N - count);
+}
+
+template <std::size_t N>
+[[nodiscard]] std::string_view get_field(const char (&src)[N]) {
+    const auto* end = static_cast<const char*>(std::memchr(src, '\0', N));
+    return {src, end == nullptr ? N : static_cast<std::size_t>(end - src)};
+}
+
+// True when `data` starts with a binary frame header (JSON headers start with '{').
+[[nodiscard]] inline bool is_frame_header(const void* data, std::size_t size) {
+    std::uint32_t magic = 0;
+    if (size < sizeof(magic)) {
+        return false;
+    }
+    std::memcpy(&magic, data, sizeof(magic));
+    return magic == kFrameMagic;
+}
+
+// Copy the header out of `data`; nullopt on short buffers or a version mismatch.
+// A memcpy keeps this valid for small messages that libzmq stores unaligned.
+[[nodiscard]] inline std::optional<FrameHeader> read_frame_header(const void* data, std::size_t size) {
+    if (size != sizeof(FrameHeader) || !is_frame_header(data, size)) {
+        return std::nullopt;
+    }
+    FrameHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != kFrameVersion) {
+        return std::nullopt;
+    }
+    return header;
+}
+
+[[nodiscard]] inline PackedKeypoint read_keypoint(const void* base, std::size_t index) {
+    PackedKeypoint kp;
+    std::memcpy(&kp, static_cast<const std::uint8_t*>(base) + index * sizeof(PackedKeypoint), sizeof(kp));
+    return kp;
+}
+
+}  // namespace dist::common::wire
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <zmq.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dist::common {
+
+namespace detail {
+inline void release_byte_vector(void* /*data*/, void* hint) {
+    delete static_cast<std::vector<std::uint8_t>*>(hint);
+}
+}  // namespace detail
+
+// Hand an owned buffer to ZeroMQ without copying; it is freed once libzmq
+// releases the last reference to the message body.
+[[nodiscard]] inline zmq::message_t make_message(std::vector<std::uint8_t>&& buffer) {
+    if (buffer.empty()) {
+        return zmq::message_t{};
+    }
+    auto* owned = new std::vector<std::uint8_t>(std::move(buffer));
+    return zmq::message_t(owned->data(), owned->size(), &detail::release_byte_vector, owned);
+}
+
+// Reference memory that outlives the socket (e.g. the generator frame cache).
+// No free function is registered, so the caller keeps ownership.
+[[nodiscard]] inline zmq::message_t borrow_message(const void* data, std::size_t size) {
+    if (size == 0) {
+        return zmq::message_t{};
+    }
+    return zmq::message_t(const_cast<void*>(data), size, nullptr, nullptr);
+}
+
+// Send every part while leaving `parts` intact for a later retry. zmq_msg_copy
+// shares large bodies by reference count, so no payload bytes are duplicated.
+inline bool send_parts(zmq::socket_t& socket,
+                       std::vector<zmq::message_t>& parts,
+                       zmq::send_flags flags = zmq::send_flags::none) {
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        zmq::message_t part;
+        part.copy(parts[i]);
+        const bool last = i + 1 == parts.size();
+        if (!socket.send(part, last ? flags : flags | zmq::send_flags::sndmore)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace dist::common
@@ -0,0 +1,67 @@
+#include "dist/common/bench_report.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace dist::common {
+
+namespace {
+
+// Nearest-rank percentile of an unsorted sample (reordered in place).
+double percentile_ms(std::vector<std::int64_t>& values, double fraction) {
+    const auto rank = static_cast<std::size_t>(fraction * static_cast<double>(values.size() - 1));
+    const auto nth = values.begin() + static_cast<std::ptrdiff_t>(rank);
+    std::nth_element(values.begin(), nth, values.end());
+    return static_cast<double>(values[rank]) / 1e6;
+}
+
+}  // namespace
+
+void BenchReport::record(const FrameTrace& trace) {
+    const auto now = Clock::now();
+    std::lock_guard lock(mutex_);
+    if (frames_ == 0) {
+        first_ = now;
+    }
+    last_ = now;
+    ++frames_;
+    for (std::size_t i = 0; i < kTraceSpans.size(); ++i) {
+        if (const auto span = trace.between(kTraceSpans[i].from, kTraceSpans[i].to)) {
+            samples_[i].push_back(*span);
+        }
+    }
+}
+
+std::uint64_t BenchReport::frames() const {
+    std::lock_guard lock(mutex_);
+    return frames_;
+}
+
+void BenchReport::log_summary(std::string_view service, std::uint64_t drops) const {
+    std::lock_guard lock(mutex_);
+    const double seconds = std::chrono::duration<double>(last_ - first_).count();
+    // Rate between the first and last completion, so start-up idle time is excluded.
+    const double fps = frames_ > 1 && seconds > 0.0 ? static_cast<double>(frames_ - 1) / seconds
+                                                     : 0.0;
+    spdlog::info("[bench] {}: {} frames in {:.2f} s ({:.1f} fps), {} dropped",
+                 service,
+                 frames_,
+                 seconds,
+                 fps,
+                 drops);
+    for (std::size_t i = 0; i < kTraceSpans.size(); ++i) {
+        if (samples_[i].empty()) {
+            continue;
+        }
+        auto values = samples_[i];
+        spdlog::info("[bench] {}: {:<12} p50 {:>9.3f} ms  p99 {:>9.3f} ms  ({} samples)",
+                     service,
+                     kTraceSpans[i].name,
+                     percentile_ms(values, 0.50),
+                     percentile_ms(values, 0.99),
+                     values.size());
+    }
+}
+
+}  // namespace dist::common
@@ -0,0 +1,107 @@
+#include "dist/common/buffer_pool.hpp"
+
+#include <iterator>
+#include <utility>
+
+#include "dist/common/metrics.hpp"
+
+namespace dist::common {
+
+namespace {
+
+struct PoolMetrics {
+    Counter& hits;
+    Counter& misses;
+};
+
+PoolMetrics& pool_metrics() {
+    static PoolMetrics instance{
+        metrics().counter("dist_buffer_pool_hits_total", "Payload buffers reused from the pool"),
+        metrics().counter("dist_buffer_pool_misses_total",
+                          "Payload buffers allocated because nothing pooled fit")};
+    return instance;
+}
+
+void release_pooled_vector(void* /*data*/, void* hint) {
+    auto* owned = static_cast<std::vector<std::uint8_t>*>(hint);
+    buffer_pool().release(std::move(*owned));
+    delete owned;
+}
+
+}  // namespace
+
+void BufferPool::set_max_bytes(std::size_t max_bytes) {
+    std::lock_guard lock(mutex_);
+    max_bytes_ = max_bytes;
+    trim_locked();
+}
+
+std::vector<std::uint8_t> BufferPool::acquire(std::size_t size_hint) {
+    {
+        std::lock_guard lock(mutex_);
+        if (!buffers_.empty()) {
+            auto it = size_hint == 0 ? std::prev(buffers_.end()) : buffers_.lower_bound(size_hint);
+            if (it != buffers_.end()) {
+                std::vector<std::uint8_t> buffer = std::move(it->second);
+                pooled_bytes_ -= it->first;
+                buffers_.erase(it);
+                pool_metrics().hits.inc();
+                buffer.clear();
+                return buffer;
+            }
+        }
+    }
+    pool_metrics().misses.inc();
+    std::vector<std::uint8_t> buffer;
+    buffer.reserve(size_hint);
+    return buffer;
+}
+
+void BufferPool::release(std::vector<std::uint8_t>&& buffer) {
+    const std::size_t capacity = buffer.capacity();
+    if (capacity < kMinPooledBytes) {
+        return;
+    }
+    std::vector<std::uint8_t> kept = std::move(buffer);
+    std::lock_guard lock(mutex_);
+    if (pooled_bytes_ + capacity > max_bytes_) {
+        return;  // `kept` is freed outside the budget
+    }
+    pooled_bytes_ += capacity;
+    buffers_.emplace(capacity, std::move(kept));
+}
+
+std::size_t BufferPool::pooled_bytes() const {
+    std::lock_guard lock(mutex_);
+    return pooled_bytes_;
+}
+
+void BufferPool::trim_locked() {
+    // Smallest buffers go first; the large ones are the expensive ones to fault in again.
+    while (pooled_bytes_ > max_bytes_ && !buffers_.empty()) {
+        pooled_bytes_ -= buffers_.begin()->first;
+        buffers_.erase(buffers_.begin());
+    }
+}
+
+BufferPool& buffer_pool() {
+    static BufferPool pool;
+    static const bool registered = [] {
+        metrics().gauge_callback("dist_buffer_pool_bytes",
+                                 "Payload buffer capacity held for reuse",
+                                 [] { return static_cast<double>(pool.pooled_bytes()); });
+        return true;
+    }();
+    (void)registered;
+    return pool;
+}
+
+zmq::message_t make_pooled_message(std::vector<std::uint8_t>&& buffer) {
+    if (buffer.empty()) {
+        return zmq::message_t{};
+    }
+    auto* owned = new std::vector<std::uint8_t>(std::move(buffer));
+    return zmq::message_t(owned->data(), owned->size(), &release_pooled_vector, owned);
+}
+
+}  // namespace dist::common
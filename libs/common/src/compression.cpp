@@ -0,0 +1,157 @@
+#include "dist/common/compression.hpp"
+
+#include <cstring>
+#include <limits>
+
+#if defined(DIST_HAVE_LZ4)
+#include <lz4.h>
+#endif
+#if defined(DIST_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace dist::common {
+
+namespace {
+// Favour speed: descriptors and raw frames are compressed on the hot path.
+constexpr int kZstdLevel = 3;
+}  // namespace
+
+std::optional<Compression> parse_compression(std::string_view value) {
+    if (value.empty() || value == "none") {
+        return Compression::none;
+    }
+    if (value == "lz4") {
+        return Compression::lz4;
+    }
+    if (value == "zstd") {
+        return Compression::zstd;
+    }
+    return std::nullopt;
+}
+
+std::string_view to_string(Compression compression) {
+    switch (compression) {
+        case Compression::lz4:
+            return "lz4";
+        case Compression::zstd:
+            return "zstd";
+        case Compression::none:
+            break;
+    }
+    return "none";
+}
+
+bool compression_available(Compression compression) {
+    switch (compression) {
+        case Compression::none:
+            return true;
+        case Compression::lz4:
+#if defined(DIST_HAVE_LZ4)
+            return true;
+#else
+            return false;
+#endif
+        case Compression::zstd:
+#if defined(DIST_HAVE_ZSTD)
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+bool compress(Compression compression,
+              const std::uint8_t* data,
+              std::size_t size,
+              std::vector<std::uint8_t>& out) {
+    switch (compression) {
+        case Compression::none:
+            out.assign(data, data + size);
+            return true;
+        case Compression::lz4: {
+#if defined(DIST_HAVE_LZ4)
+            if (size > static_cast<std::size_t>(LZ4_MAX_INPUT_SIZE)) {
+                return false;
+            }
+            const int src_size = static_cast<int>(size);
+            out.resize(static_cast<std::size_t>(LZ4_compressBound(src_size)));
+            const int written = LZ4_compress_default(reinterpret_cast<const char*>(data),
+                                                     reinterpret_cast<char*>(out.data()),
+                                                     src_size,
+                                                     static_cast<int>(out.size()));
+            if (written <= 0) {
+                return false;
+            }
+            out.resize(static_cast<std::size_t>(written));
+            return true;
+#else
+            return false;
+#endif
+        }
+        case Compression::zstd: {
+#if defined(DIST_HAVE_ZSTD)
+            out.resize(ZSTD_compressBound(size));
+            const std::size_t written = ZSTD_compress(out.data(), out.size(), data, size, kZstdLevel);
+            if (ZSTD_isError(written) != 0U) {
+                return false;
+            }
+            out.resize(written);
+            return true;
+#else
+            return false;
+#endif
+        }
+    }
+    return false;
+}
+
+bool decompress(Compression compression,
+                const std::uint8_t* data,
+                std::size_t size,
+                std::uint8_t* out,
+                std::size_t out_size) {
+    switch (compression) {
+        case Compression::none:
+            if (size != out_size) {
+                return false;
+            }
+            std::memcpy(out, data, size);
+            return true;
+        case Compression::lz4: {
+#if defined(DIST_HAVE_LZ4)
+            constexpr auto kIntMax = static_cast<std::size_t>(std::numeric_limits<int>::max());
+            if (size > kIntMax || out_size > kIntMax) {
+                return false;
+            }
+            const int written = LZ4_decompress_safe(reinterpret_cast<const char*>(data),
+                                                    reinterpret_cast<char*>(out),
+                                                    static_cast<int>(size),
+                                                    static_cast<int>(out_size));
+            return written >= 0 && static_cast<std::size_t>(written) == out_size;
+#else
+            (void)data;
+            (void)size;
+            (void)out;
+            (void)out_size;
+            return false;
+#endif
+        }
+        case Compression::zstd: {
+#if defined(DIST_HAVE_ZSTD)
+            const std::size_t written = ZSTD_decompress(out, out_size, data, size);
+            return ZSTD_isError(written) == 0U && written == out_size;
+#else
+            (void)data;
+            (void)size;
+            (void)out;
+            (void)out_size;
+            return false;
+#endif
+        }
+    }
+    return false;
+}
+
+}  // namespace dist::common
@@ -28,6 +28,18 @@ double to_double(const EnvLoader& env, std::string_view key, double fallback) {
     return fallback;
 }
 
+bool to_bool(const EnvLoader& env, std::string_view key, bool fallback) {
+    if (auto value = env.get(key)) {
+        if (*value == "1" || *value == "true" || *value == "yes" || *value == "on") {
+            return true;
+        }
+        if (*value == "0" || *value == "false" || *value == "no" || *value == "off") {
+            return false;
+        }
+    }
+    return fallback;
+}
+
 std::filesystem::path to_path(const EnvLoader& env,
                               std::string_view key,
                               const std::filesystem::path& fallback,
@@ -41,6 +53,38 @@ std::filesystem::path to_path(const EnvLoader& env,
     }
     return fallback.is_relative() ? (root / fallback) : fallback;
 }
+
+// Like to_path(), but unset or empty stays empty (feature off).
+std::filesystem::path to_optional_path(const EnvLoader& env,
+                                       std::string_view key,
+                                       const std::filesystem::path& root) {
+    if (env.get(key).value_or("").empty()) {
+        return {};
+    }
+    return to_path(env, key, {}, root);
+}
+
+// "id=dir,id=dir"; entries without an '=' are skipped, ids are validated by the generator.
+std::vector<StreamInput> to_streams(const EnvLoader& env,
+                                    std::string_view key,
+                                    const std::filesystem::path& root) {
+    std::vector<StreamInput> streams;
+    const std::string list = env.get_or(key, "");
+    std::string_view rest = list;
+    while (!rest.empty()) {
+        const auto comma = rest.find(',');
+        const auto entry = rest.substr(0, comma);
+        rest = comma == std::string_view::npos ? std::string_view{} : rest.substr(comma + 1);
+        const auto equals = entry.find('=');
+        if (equals == std::string_view::npos || equals == 0 || equals + 1 == entry.size()) {
+            continue;
+        }
+        std::filesystem::path dir{std::string(entry.substr(equals + 1))};
+        streams.push_back({std::string(entry.substr(0, equals)),
+                           dir.is_relative() ? root / dir : dir});
+    }
+    return streams;
+}
 }  // namespace
 
 AppConfig load_app_config(const EnvLoader& env, const std::filesystem::path& root_dir) {
@@ -51,34 +95,110 @@ AppConfig load_app_config(const EnvLoader& env, const std::filesystem::path& roo
     // Image generator tuning knobs.
     cfg.generator.input_dir =
         to_path(env, "IMAGE_GENERATOR_INPUT_DIR", "./data/images", root_dir);
+    cfg.generator.source_mode =
+        env.get_or("IMAGE_GENERATOR_SOURCE_MODE", cfg.generator.source_mode);
     cfg.generator.loop_delay_ms =
         to_int(env, "IMAGE_GENERATOR_LOOP_DELAY_MS", cfg.generator.loop_delay_ms);
+    cfg.generator.target_fps =
+        to_double(env, "IMAGE_GENERATOR_TARGET_FPS", cfg.generator.target_fps);
+    cfg.generator.burst = to_int(env, "IMAGE_GENERATOR_BURST", cfg.generator.burst);
     cfg.generator.start_delay_ms =
         to_int(env, "IMAGE_GENERATOR_START_DELAY_MS", cfg.generator.start_delay_ms);
     cfg.generator.subscriber_wait_ms =
         to_int(env, "IMAGE_GENERATOR_SUBSCRIBER_WAIT_MS", cfg.generator.subscriber_wait_ms);
     cfg.generator.pub_endpoint =
         env.get_or("IMAGE_GENERATOR_PUB_ENDPOINT", "tcp://127.0.0.1:5555");
+    cfg.generator.shm_mb = to_int(env, "IMAGE_GENERATOR_SHM_MB", cfg.generator.shm_mb);
     cfg.generator.heartbeat_ms =
         to_int(env, "IMAGE_GENERATOR_HEARTBEAT_MS", cfg.generator.heartbeat_ms);
     const int extractor_queue_fallback =
         to_int(env, "FEATURE_EXTRACTOR_QUEUE_DEPTH", cfg.generator.queue_depth);
     cfg.generator.queue_depth =
         to_int(env, "IMAGE_GENERATOR_QUEUE_DEPTH", extractor_queue_fallback);
+    cfg.generator.queue_mb = to_int(env, "IMAGE_GENERATOR_QUEUE_MB", cfg.generator.queue_mb);
+    cfg.generator.drop_policy =
+        env.get_or("IMAGE_GENERATOR_DROP_POLICY", cfg.generator.drop_policy);
+    cfg.generator.spill_dir = to_optional_path(env, "IMAGE_GENERATOR_SPILL_DIR", root_dir);
+    cfg.generator.spill_mb = to_int(env, "IMAGE_GENERATOR_SPILL_MB", cfg.generator.spill_mb);
+    cfg.generator.buffer_pool_mb =
+        to_int(env, "IMAGE_GENERATOR_BUFFER_POOL_MB", cfg.generator.buffer_pool_mb);
+    cfg.generator.publish_mode =
+        env.get_or("IMAGE_GENERATOR_PUBLISH_MODE", cfg.generator.publish_mode);
+    cfg.generator.raw_compression =
+        env.get_or("IMAGE_GENERATOR_RAW_COMPRESSION", cfg.generator.raw_compression);
+    cfg.generator.cache_mode = env.get_or("IMAGE_GENERATOR_CACHE_MODE", cfg.generator.cache_mode);
+    cfg.generator.cache_budget_mb =
+        to_int(env, "IMAGE_GENERATOR_CACHE_BUDGET_MB", cfg.generator.cache_budget_mb);
+    cfg.generator.cache_dir =
+        to_path(env, "IMAGE_GENERATOR_CACHE_DIR", "./storage/frame_cache", root_dir);
+    cfg.generator.prefetch_threads =
+        to_int(env, "IMAGE_GENERATOR_PREFETCH_THREADS", cfg.generator.prefetch_threads);
+    cfg.generator.prefetch_depth =
+        to_int(env, "IMAGE_GENERATOR_PREFETCH_DEPTH", cfg.generator.prefetch_depth);
+    cfg.generator.distribution =
+        env.get_or("IMAGE_GENERATOR_DISTRIBUTION", cfg.generator.distribution);
+    cfg.generator.metrics_endpoint = env.get_or("IMAGE_GENERATOR_METRICS_ENDPOINT", "");
+    cfg.generator.streams = to_streams(env, "IMAGE_GENERATOR_STREAMS", root_dir);
 
     // Feature extractor tuning knobs.
     cfg.extractor.sub_endpoint =
         env.get_or("FEATURE_EXTRACTOR_SUB_ENDPOINT", "tcp://127.0.0.1:5555");
     cfg.extractor.pub_endpoint =
         env.get_or("FEATURE_EXTRACTOR_PUB_ENDPOINT", "tcp://127.0.0.1:5556");
+    cfg.extractor.shm_mb = to_int(env, "FEATURE_EXTRACTOR_SHM_MB", cfg.extractor.shm_mb);
+    cfg.extractor.detector = env.get_or("FEATURE_EXTRACTOR_DETECTOR", cfg.extractor.detector);
     cfg.extractor.sift_n_features =
         to_int(env, "FEATURE_EXTRACTOR_SIFT_N_FEATURES", cfg.extractor.sift_n_features);
     cfg.extractor.sift_contrast_threshold = to_double(
         env, "FEATURE_EXTRACTOR_SIFT_CONTRAST_THRESHOLD", cfg.extractor.sift_contrast_threshold);
     cfg.extractor.sift_edge_threshold =
         to_double(env, "FEATURE_EXTRACTOR_SIFT_EDGE_THRESHOLD", cfg.extractor.sift_edge_threshold);
+    cfg.extractor.orb_n_features =
+        to_int(env, "FEATURE_EXTRACTOR_ORB_N_FEATURES", cfg.extractor.orb_n_features);
+    cfg.extractor.akaze_threshold =
+        to_double(env, "FEATURE_EXTRACTOR_AKAZE_THRESHOLD", cfg.extractor.akaze_threshold);
+    cfg.extractor.tile_size = to_int(env, "FEATURE_EXTRACTOR_TILE_SIZE", cfg.extractor.tile_size);
+    cfg.extractor.tile_overlap =
+        to_int(env, "FEATURE_EXTRACTOR_TILE_OVERLAP", cfg.extractor.tile_overlap);
+    cfg.extractor.max_dimension =
+        to_int(env, "FEATURE_EXTRACTOR_MAX_DIMENSION", cfg.extractor.max_dimension);
+    cfg.extractor.grayscale = to_bool(env, "FEATURE_EXTRACTOR_GRAYSCALE", cfg.extractor.grayscale);
+    cfg.extractor.roi = env.get_or("FEATURE_EXTRACTOR_ROI", cfg.extractor.roi);
+    cfg.extractor.roi_mode = env.get_or("FEATURE_EXTRACTOR_ROI_MODE", cfg.extractor.roi_mode);
+    cfg.extractor.mask_path = to_optional_path(env, "FEATURE_EXTRACTOR_MASK_PATH", root_dir);
+    cfg.extractor.reuse_cache_mb =
+        to_int(env, "FEATURE_EXTRACTOR_REUSE_CACHE_MB", cfg.extractor.reuse_cache_mb);
+    cfg.extractor.reuse_diff_threshold = to_double(
+        env, "FEATURE_EXTRACTOR_REUSE_DIFF_THRESHOLD", cfg.extractor.reuse_diff_threshold);
     cfg.extractor.queue_depth =
         to_int(env, "FEATURE_EXTRACTOR_QUEUE_DEPTH", cfg.extractor.queue_depth);
+    cfg.extractor.queue_mb = to_int(env, "FEATURE_EXTRACTOR_QUEUE_MB", cfg.extractor.queue_mb);
+    cfg.extractor.drop_policy =
+        env.get_or("FEATURE_EXTRACTOR_DROP_POLICY", cfg.extractor.drop_policy);
+    cfg.extractor.spill_dir = to_optional_path(env, "FEATURE_EXTRACTOR_SPILL_DIR", root_dir);
+    cfg.extractor.spill_mb = to_int(env, "FEATURE_EXTRACTOR_SPILL_MB", cfg.extractor.spill_mb);
+    cfg.extractor.buffer_pool_mb =
+        to_int(env, "FEATURE_EXTRACTOR_BUFFER_POOL_MB", cfg.extractor.buffer_pool_mb);
+    cfg.extractor.workers = to_int(env, "FEATURE_EXTRACTOR_WORKERS", cfg.extractor.workers);
+    cfg.extractor.ordered_output =
+        to_bool(env, "FEATURE_EXTRACTOR_ORDERED_OUTPUT", cfg.extractor.ordered_output);
+    cfg.extractor.annotate_every_n =
+        to_int(env, "FEATURE_EXTRACTOR_ANNOTATE_EVERY_N", cfg.extractor.annotate_every_n);
+    cfg.extractor.annotation_stage =
+        env.get_or("FEATURE_EXTRACTOR_ANNOTATION_STAGE", cfg.extractor.annotation_stage);
+    cfg.extractor.header_format =
+        env.get_or("FEATURE_EXTRACTOR_HEADER_FORMAT", cfg.extractor.header_format);
+    cfg.extractor.descriptor_format =
+        env.get_or("FEATURE_EXTRACTOR_DESCRIPTOR_FORMAT", cfg.extractor.descriptor_format);
+    cfg.extractor.descriptor_compression =
+        env.get_or("FEATURE_EXTRACTOR_DESCRIPTOR_COMPRESSION", cfg.extractor.descriptor_compression);
+    // Stages default to the generator's distribution so one setting switches the pipeline.
+    cfg.extractor.distribution =
+        env.get_or("FEATURE_EXTRACTOR_DISTRIBUTION", cfg.generator.distribution);
+    cfg.extractor.metrics_endpoint = env.get_or("FEATURE_EXTRACTOR_METRICS_ENDPOINT", "");
+    cfg.extractor.streams = env.get_or("FEATURE_EXTRACTOR_STREAMS", "");
+    cfg.extractor.stream_queue_depth =
+        to_int(env, "FEATURE_EXTRACTOR_STREAM_QUEUE_DEPTH", cfg.extractor.stream_queue_depth);
 
     // Data logger tuning knobs.
     cfg.logger.sub_endpoint =
@@ -89,6 +209,34 @@ AppConfig load_app_config(const EnvLoader& env, const std::filesystem::path& roo
         to_path(env, "DATA_LOGGER_RAW_IMAGE_DIR", "./storage/raw_frames", root_dir);
     cfg.logger.annotated_image_dir =
         to_path(env, "DATA_LOGGER_ANNOTATED_DIR", "./storage/annotated_frames", root_dir);
+    cfg.logger.queue_depth = to_int(env, "DATA_LOGGER_QUEUE_DEPTH", cfg.logger.queue_depth);
+    cfg.logger.stats_interval_ms =
+        to_int(env, "DATA_LOGGER_STATS_INTERVAL_MS", cfg.logger.stats_interval_ms);
+    cfg.logger.payload_backend =
+        env.get_or("DATA_LOGGER_PAYLOAD_BACKEND", cfg.logger.payload_backend);
+    cfg.logger.write_batch = to_int(env, "DATA_LOGGER_WRITE_BATCH", cfg.logger.write_batch);
+    cfg.logger.fdatasync = to_bool(env, "DATA_LOGGER_FDATASYNC", cfg.logger.fdatasync);
+    cfg.logger.storage = env.get_or("DATA_LOGGER_STORAGE", cfg.logger.storage);
+    cfg.logger.segment_dir =
+        to_path(env, "DATA_LOGGER_SEGMENT_DIR", "./storage/segments", root_dir);
+    cfg.logger.segment_max_mb =
+        to_int(env, "DATA_LOGGER_SEGMENT_MAX_MB", cfg.logger.segment_max_mb);
+    cfg.logger.render_annotations =
+        to_bool(env, "DATA_LOGGER_RENDER_ANNOTATIONS", cfg.logger.render_annotations);
+    cfg.logger.batch_size = to_int(env, "DATA_LOGGER_BATCH_SIZE", cfg.logger.batch_size);
+    cfg.logger.flush_interval_ms =
+        to_int(env, "DATA_LOGGER_FLUSH_INTERVAL_MS", cfg.logger.flush_interval_ms);
+    cfg.logger.sqlite_journal_mode =
+        env.get_or("DATA_LOGGER_SQLITE_JOURNAL_MODE", cfg.logger.sqlite_journal_mode);
+    cfg.logger.sqlite_synchronous =
+        env.get_or("DATA_LOGGER_SQLITE_SYNCHRONOUS", cfg.logger.sqlite_synchronous);
+    cfg.logger.sqlite_cache_size =
+        to_int(env, "DATA_LOGGER_SQLITE_CACHE_SIZE", cfg.logger.sqlite_cache_size);
+    cfg.logger.distribution = env.get_or("DATA_LOGGER_DISTRIBUTION", cfg.extractor.distribution);
+    cfg.logger.metrics_endpoint = env.get_or("DATA_LOGGER_METRICS_ENDPOINT", "");
+    cfg.logger.streams = env.get_or("DATA_LOGGER_STREAMS", "");
+
+    cfg.pipeline.metrics_endpoint = env.get_or("PIPELINE_METRICS_ENDPOINT", "");
 
     return cfg;
 }
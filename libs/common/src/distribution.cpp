@@ -0,0 +1,35 @@
+#include "dist/common/distribution.hpp"
+
+namespace dist::common {
+
+std::optional<Distribution> parse_distribution(std::string_view value) {
+    if (value.empty() || value == "pubsub") {
+        return Distribution::pubsub;
+    }
+    if (value == "pushpull") {
+        return Distribution::pushpull;
+    }
+    return std::nullopt;
+}
+
+std::string_view to_string(Distribution distribution) {
+    switch (distribution) {
+        case Distribution::pushpull:
+            return "pushpull";
+        case Distribution::pubsub:
+            break;
+    }
+    return "pubsub";
+}
+
+zmq::socket_type sender_socket_type(Distribution distribution) {
+    return distribution == Distribution::pushpull ? zmq::socket_type::push
+                                                  : zmq::socket_type::pub;
+}
+
+zmq::socket_type receiver_socket_type(Distribution distribution) {
+    return distribution == Distribution::pushpull ? zmq::socket_type::pull
+                                                  : zmq::socket_type::sub;
+}
+
+}  // namespace dist::common
@@ -4,6 +4,7 @@
 #include <sstream>
 #include <string>
 #include <cstdlib>
+#include <utility>
 
 #if !defined(_WIN32)
 extern char** environ;
@@ -102,6 +103,10 @@ std::string EnvLoader::get_or(std::string_view key,
     return std::string(fallback);
 }
 
+void EnvLoader::set(std::string key, std::string value) {
+    values_[std::move(key)] = std::move(value);
+}
+
 std::string EnvLoader::trim(std::string_view in) {
     const auto is_ws = [](char c) { return std::isspace(static_cast<unsigned char>(c)); };
     size_t start = 0;
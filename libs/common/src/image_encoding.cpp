@@ -0,0 +1,68 @@
+#include "dist/common/image_encoding.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <string>
+#include <utility>
+
+namespace dist::common {
+
+namespace {
+// Single table keeps the generator, extractor and logger naming in sync.
+constexpr std::array<std::pair<std::string_view, std::string_view>, 6> kExtensionToEncoding{{
+    {".png", "png"},
+    {".jpg", "jpeg"},
+    {".jpeg", "jpeg"},
+    {".bmp", "bmp"},
+    {".tif", "tiff"},
+    {".tiff", "tiff"},
+}};
+
+std::string to_lower(std::string_view value) {
+    std::string out(value);
+    std::transform(out.begin(), out.end(), out.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return out;
+}
+}  // namespace
+
+std::string_view encoding_for_extension(std::string_view extension) {
+    const auto lowered = to_lower(extension);
+    for (const auto& [ext, encoding] : kExtensionToEncoding) {
+        if (lowered == ext) {
+            return encoding;
+        }
+    }
+    return {};
+}
+
+std::string_view extension_for_encoding(std::string_view encoding) {
+    if (encoding == "jpg") {
+        return ".jpg";
+    }
+    if (encoding == "raw") {
+        return ".raw";  // bare pixel buffer; layout lives in the header metadata
+    }
+    for (const auto& [ext, known] : kExtensionToEncoding) {
+        if (encoding == known) {
+            return ext;  // First match wins, so "jpeg" maps to ".jpg" and "tiff" to ".tif".
+        }
+    }
+    return ".bin";
+}
+
+bool is_image_codec(std::string_view encoding) {
+    if (encoding == "jpg") {
+        return true;
+    }
+    for (const auto& [ext, known] : kExtensionToEncoding) {
+        if (encoding == known) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace dist::common
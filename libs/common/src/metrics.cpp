@@ -0,0 +1,322 @@
+#include "dist/common/metrics.hpp"
+
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <utility>
+
+namespace dist::common {
+
+namespace {
+
+constexpr std::size_t kMaxRequestBytes = 8192;
+
+std::string format_value(double value) {
+    if (std::isinf(value)) {
+        return value > 0 ? "+Inf" : "-Inf";
+    }
+    return fmt::format("{}", value);
+}
+
+// `name{labels,extra}` with the braces dropped when both are empty.
+std::string series(std::string_view name, std::string_view labels, std::string_view extra = {}) {
+    if (labels.empty() && extra.empty()) {
+        return std::string(name);
+    }
+    if (labels.empty() || extra.empty()) {
+        return fmt::format("{}{{{}{}}}", name, labels, extra);
+    }
+    return fmt::format("{}{{{},{}}}", name, labels, extra);
+}
+
+std::string http_response(std::string_view status, std::string_view body) {
+    return fmt::format(
+        "HTTP/1.1 {}\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: {}\r\n"
+        "Connection: close\r\n\r\n{}",
+        status,
+        body.size(),
+        body);
+}
+
+}  // namespace
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)),
+      buckets_(std::make_unique<std::atomic<std::uint64_t>[]>(bounds_.size() + 1)) {
+    std::sort(bounds_.begin(), bounds_.end());
+}
+
+void Histogram::observe(double value) {
+    const auto it = std::lower_bound(bounds_.begin(), bounds_.end(), value);
+    buckets_[static_cast<std::size_t>(it - bounds_.begin())].fetch_add(1,
+                                                                        std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+std::uint64_t Histogram::bucket(std::size_t index) const {
+    return buckets_[index].load(std::memory_order_relaxed);
+}
+
+std::vector<double> latency_buckets() {
+    return {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+            0.025,  0.05,    0.1,    0.25,  0.5,    1.0,   2.5, 5.0, 10.0};
+}
+
+std::vector<double> byte_buckets() {
+    std::vector<double> bounds;
+    for (double bytes = 1024.0; bytes <= 64.0 * 1024.0 * 1024.0; bytes *= 4.0) {
+        bounds.push_back(bytes);
+    }
+    return bounds;
+}
+
+MetricsRegistry::Entry* MetricsRegistry::find(std::string_view name, std::string_view labels) {
+    for (auto& entry : entries_) {
+        if (entry->name == name && entry->labels == labels) {
+            return entry.get();
+        }
+    }
+    return nullptr;
+}
+
+MetricsRegistry::Entry& MetricsRegistry::add(std::string_view name,
+                                             std::string_view help,
+                                             std::string_view labels,
+                                             Kind kind) {
+    auto entry = std::make_unique<Entry>();
+    entry->name = std::string(name);
+    entry->help = std::string(help);
+    entry->labels = std::string(labels);
+    entry->kind = kind;
+    entries_.push_back(std::move(entry));
+    return *entries_.back();
+}
+
+Counter& MetricsRegistry::counter(std::string_view name,
+                                  std::string_view help,
+                                  std::string_view labels) {
+    std::lock_guard lock(mutex_);
+    if (auto* entry = find(name, labels); entry != nullptr && entry->counter) {
+        return *entry->counter;
+    }
+    auto& entry = add(name, help, labels, Kind::counter);
+    entry.counter = std::make_unique<Counter>();
+    return *entry.counter;
+}
+
+Gauge& MetricsRegistry::gauge(std::string_view name,
+                              std::string_view help,
+                              std::string_view labels) {
+    std::lock_guard lock(mutex_);
+    if (auto* entry = find(name, labels); entry != nullptr && entry->gauge) {
+        return *entry->gauge;
+    }
+    auto& entry = add(name, help, labels, Kind::gauge);
+    entry.gauge = std::make_unique<Gauge>();
+    return *entry.gauge;
+}
+
+Histogram& MetricsRegistry::histogram(std::string_view name,
+                                      std::string_view help,
+                                      std::vector<double> bounds,
+                                      std::string_view labels) {
+    std::lock_guard lock(mutex_);
+    if (auto* entry = find(name, labels); entry != nullptr && entry->histogram) {
+        return *entry->histogram;
+    }
+    auto& entry = add(name, help, labels, Kind::histogram);
+    entry.histogram = std::make_unique<Histogram>(std::move(bounds));
+    return *entry.histogram;
+}
+
+void MetricsRegistry::gauge_callback(std::string_view name,
+                                     std::string_view help,
+                                     std::function<double()> sample,
+                                     std::string_view labels) {
+    std::lock_guard lock(mutex_);
+    auto* entry = find(name, labels);
+    if (entry == nullptr) {
+        entry = &add(name, help, labels, Kind::gauge);
+    }
+    entry->sample = std::move(sample);
+}
+
+void MetricsRegistry::counter_callback(std::string_view name,
+                                       std::string_view help,
+                                       std::function<double()> sample,
+                                       std::string_view labels) {
+    std::lock_guard lock(mutex_);
+    auto* entry = find(name, labels);
+    if (entry == nullptr) {
+        entry = &add(name, help, labels, Kind::counter);
+    }
+    entry->sample = std::move(sample);
+}
+
+void MetricsRegistry::freeze_callbacks(std::string_view prefix) {
+    std::lock_guard lock(mutex_);
+    for (auto& entry : entries_) {
+        if (entry->sample && std::string_view(entry->name).substr(0, prefix.size()) == prefix) {
+            entry->sample = [value = entry->sample()] { return value; };
+        }
+    }
+}
+
+std::string MetricsRegistry::render() const {
+    std::lock_guard lock(mutex_);
+
+    // The text format wants each family contiguous, so group by name in first-seen order.
+    std::vector<std::string_view> names;
+    for (const auto& entry : entries_) {
+        if (std::find(names.begin(), names.end(), entry->name) == names.end()) {
+            names.push_back(entry->name);
+        }
+    }
+
+    std::string out;
+    for (const auto name : names) {
+        bool header_written = false;
+        for (const auto& entry : entries_) {
+            if (entry->name != name) {
+                continue;
+            }
+            if (!header_written) {
+                const char* type = entry->kind == Kind::counter ? "counter"
+                                   : entry->kind == Kind::gauge ? "gauge"
+                                                                : "histogram";
+                out += fmt::format("# HELP {} {}\n# TYPE {} {}\n", name, entry->help, name, type);
+                header_written = true;
+            }
+
+            if (entry->sample) {
+                out += fmt::format("{} {}\n",
+                                   series(name, entry->labels),
+                                   format_value(entry->sample()));
+            } else if (entry->counter) {
+                out += fmt::format("{} {}\n", series(name, entry->labels), entry->counter->value());
+            } else if (entry->gauge) {
+                out += fmt::format("{} {}\n",
+                                   series(name, entry->labels),
+                                   format_value(entry->gauge->value()));
+            } else if (entry->histogram) {
+                const auto& histogram = *entry->histogram;
+                const auto bucket_name = fmt::format("{}_bucket", name);
+                std::uint64_t cumulative = 0;
+                for (std::size_t i = 0; i <= histogram.bounds().size(); ++i) {
+                    cumulative += histogram.bucket(i);
+                    const double bound = i < histogram.bounds().size()
+                                             ? histogram.bounds()[i]
+                                             : std::numeric_limits<double>::infinity();
+                    const auto le = fmt::format("le=\"{}\"", format_value(bound));
+                    out += fmt::format(
+                        "{} {}\n", series(bucket_name, entry->labels, le), cumulative);
+                }
+                out += fmt::format("{} {}\n",
+                                   series(fmt::format("{}_sum", name), entry->labels),
+                                   format_value(histogram.sum()));
+                out += fmt::format("{} {}\n",
+                                   series(fmt::format("{}_count", name), entry->labels),
+                                   histogram.count());
+            }
+        }
+    }
+    return out;
+}
+
+MetricsRegistry& metrics() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsServer::MetricsServer(zmq::context_t& context,
+                             std::string endpoint,
+                             MetricsRegistry& registry)
+    : context_(context), endpoint_(std::move(endpoint)), registry_(registry) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+void MetricsServer::start() {
+    if (endpoint_.empty() || thread_.joinable()) {
+        return;
+    }
+    stop_flag_.store(false);
+    thread_ = std::thread([this]() { run(); });
+}
+
+void MetricsServer::stop() {
+    stop_flag_.store(true);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void MetricsServer::run() {
+    zmq::socket_t socket(context_, zmq::socket_type::stream);
+    socket.set(zmq::sockopt::linger, 0);
+    try {
+        socket.bind(endpoint_);
+    } catch (const zmq::error_t& ex) {
+        spdlog::warn("Metrics endpoint {} unavailable: {}", endpoint_, ex.what());
+        return;
+    }
+    spdlog::info("Serving metrics on {}", endpoint_);
+
+    // A STREAM socket delivers [peer id][bytes]; an empty payload marks connect/disconnect.
+    std::map<std::string, std::string> requests;
+    while (!stop_flag_.load()) {
+        zmq::pollitem_t item{socket.handle(), 0, ZMQ_POLLIN, 0};
+        try {
+            zmq::poll(&item, 1, std::chrono::milliseconds(250));
+        } catch (const zmq::error_t& ex) {
+            if (ex.num() == EINTR) {
+                continue;
+            }
+            spdlog::warn("Metrics endpoint poll failed: {}", ex.what());
+            return;
+        }
+        if ((item.revents & ZMQ_POLLIN) == 0) {
+            continue;
+        }
+
+        zmq::message_t id;
+        zmq::message_t data;
+        if (!socket.recv(id, zmq::recv_flags::dontwait) || !id.more() ||
+            !socket.recv(data, zmq::recv_flags::dontwait)) {
+            continue;
+        }
+        const auto peer = id.to_string();
+        if (data.size() == 0) {
+            requests.erase(peer);
+            continue;
+        }
+
+        auto& request = requests[peer];
+        request.append(static_cast<const char*>(data.data()), data.size());
+        if (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequestBytes) {
+            continue;  // Headers not complete yet
+        }
+
+        const bool wants_metrics = request.rfind("GET /metrics", 0) == 0 ||
+                                   request.rfind("GET / ", 0) == 0;
+        const auto response = wants_metrics ? http_response("200 OK", registry_.render())
+                                            : http_response("404 Not Found", "not found\n");
+        requests.erase(peer);
+
+        // Reply, then an empty frame to the same peer closes the connection.
+        socket.send(zmq::buffer(peer), zmq::send_flags::sndmore);
+        socket.send(zmq::buffer(response), zmq::send_flags::none);
+        socket.send(zmq::buffer(peer), zmq::send_flags::sndmore);
+        socket.send(zmq::message_t{}, zmq::send_flags::none);
+    }
+}
+
+}  // namespace dist::common
@@ -0,0 +1,226 @@
+#include "dist/common/pending_queue.hpp"
+
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace dist::common {
+
+namespace {
+
+constexpr std::uint32_t kMaxSpillParts = 64;  // Sanity bound when reading a file back
+
+// Spill file layout: [u32 part count][u64 size per part][part bytes...].
+bool write_all(int fd, std::vector<iovec>& iov) {
+    std::size_t index = 0;
+    while (index < iov.size()) {
+        const auto count = static_cast<int>(std::min<std::size_t>(iov.size() - index, IOV_MAX));
+        const ssize_t rc = ::writev(fd, iov.data() + index, count);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        auto done = static_cast<std::size_t>(rc);
+        while (index < iov.size() && done >= iov[index].iov_len) {
+            done -= iov[index].iov_len;
+            ++index;
+        }
+        if (index < iov.size()) {
+            iov[index].iov_base = static_cast<std::uint8_t*>(iov[index].iov_base) + done;
+            iov[index].iov_len -= done;
+        }
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, std::size_t size) {
+    auto* out = static_cast<std::uint8_t*>(data);
+    while (size > 0) {
+        const ssize_t rc = ::read(fd, out, size);
+        if (rc < 0 && errno == EINTR) {
+            continue;
+        }
+        if (rc <= 0) {
+            return false;
+        }
+        out += rc;
+        size -= static_cast<std::size_t>(rc);
+    }
+    return true;
+}
+
+// Part sizes read back from a file must add up to what was written, so a corrupt
+// size is not trusted with an allocation.
+bool sizes_match(const std::vector<std::uint64_t>& sizes, std::uint64_t expected) {
+    std::uint64_t total = 0;
+    for (const auto size : sizes) {
+        if (size > expected - total) {
+            return false;
+        }
+        total += size;
+    }
+    return total == expected;
+}
+
+}  // namespace
+
+std::optional<DropPolicy> parse_drop_policy(std::string_view value) {
+    if (value.empty() || value == "oldest") {
+        return DropPolicy::oldest;
+    }
+    if (value == "newest") {
+        return DropPolicy::newest;
+    }
+    if (value == "priority") {
+        return DropPolicy::priority;
+    }
+    return std::nullopt;
+}
+
+std::string_view to_string(DropPolicy policy) {
+    switch (policy) {
+        case DropPolicy::newest:
+            return "newest";
+        case DropPolicy::priority:
+            return "priority";
+        case DropPolicy::oldest:
+            break;
+    }
+    return "oldest";
+}
+
+SpillStore::SpillStore(fs::path dir, std::size_t max_bytes)
+    : dir_(std::move(dir)), max_bytes_(max_bytes) {
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    if (ec) {
+        throw std::runtime_error("Unable to create spill directory " + dir_.string() + ": " +
+                                 ec.message());
+    }
+    // A previous run's backlog cannot be resumed (its frames were never accounted here).
+    for (const auto& entry : fs::directory_iterator(dir_, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("spill_", 0) == 0 && entry.path().extension() == ".bin") {
+            fs::remove(entry.path(), ec);
+        }
+    }
+}
+
+SpillStore::~SpillStore() {
+    std::error_code ec;
+    for (const auto& [id, size] : sizes_) {
+        fs::remove(path_for(id), ec);
+    }
+}
+
+fs::path SpillStore::path_for(std::uint64_t id) const {
+    return dir_ / fmt::format("spill_{:08}.bin", id);
+}
+
+std::optional<std::uint64_t> SpillStore::write(const std::vector<zmq::message_t>& parts) {
+    std::size_t size = 0;
+    for (const auto& part : parts) {
+        size += part.size();
+    }
+    if (bytes_ + size > max_bytes_) {
+        return std::nullopt;
+    }
+
+    const std::uint64_t id = next_id_++;
+    const fs::path path = path_for(id);
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        spdlog::warn("Failed to create spill file {}: {}", path.string(), std::strerror(errno));
+        return std::nullopt;
+    }
+
+    auto count = static_cast<std::uint32_t>(parts.size());
+    std::vector<std::uint64_t> sizes;
+    sizes.reserve(parts.size());
+    std::vector<iovec> iov;
+    iov.reserve(parts.size() + 2);
+    iov.push_back({&count, sizeof(count)});
+    for (const auto& part : parts) {
+        sizes.push_back(part.size());
+    }
+    iov.push_back({sizes.data(), sizes.size() * sizeof(std::uint64_t)});
+    for (const auto& part : parts) {
+        if (part.size() > 0) {
+            iov.push_back({const_cast<void*>(part.data()), part.size()});
+        }
+    }
+    const bool ok = write_all(fd, iov);
+    ::close(fd);
+    if (!ok) {
+        spdlog::warn("Failed to write spill file {}: {}", path.string(), std::strerror(errno));
+        std::error_code ec;
+        fs::remove(path, ec);
+        return std::nullopt;
+    }
+    sizes_.emplace(id, size);
+    bytes_ += size;
+    return id;
+}
+
+std::optional<std::vector<zmq::message_t>> SpillStore::read(std::uint64_t id) {
+    const fs::path path = path_for(id);
+    const auto known = sizes_.find(id);
+    const std::uint64_t expected = known != sizes_.end() ? known->second : 0;
+    std::optional<std::vector<zmq::message_t>> parts;
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    std::uint32_t count = 0;
+    if (fd >= 0 && read_all(fd, &count, sizeof(count)) && count <= kMaxSpillParts) {
+        std::vector<std::uint64_t> sizes(count);
+        if (read_all(fd, sizes.data(), sizes.size() * sizeof(std::uint64_t)) &&
+            sizes_match(sizes, expected)) {
+            parts.emplace();
+            parts->reserve(count);
+            for (const auto size : sizes) {
+                zmq::message_t part(static_cast<std::size_t>(size));
+                if (size > 0 && !read_all(fd, part.data(), part.size())) {
+                    parts.reset();
+                    break;
+                }
+                parts->push_back(std::move(part));
+            }
+        }
+    }
+    if (!parts) {
+        spdlog::warn("Failed to read spill file {}; frame lost", path.string());
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    discard(id);
+    return parts;
+}
+
+void SpillStore::discard(std::uint64_t id) {
+    const auto it = sizes_.find(id);
+    if (it == sizes_.end()) {
+        return;
+    }
+    bytes_ -= it->second;
+    sizes_.erase(it);
+    std::error_code ec;
+    fs::remove(path_for(id), ec);
+}
+
+}  // namespace dist::common
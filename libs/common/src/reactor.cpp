@@ -0,0 +1,134 @@
+#include "dist/common/reactor.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+namespace dist::common {
+
+namespace {
+
+void set_nonblocking(int fd) {
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+}  // namespace
+
+Reactor::Reactor() {
+    // A plain pipe (not eventfd) so the loop also runs on macOS.
+    int fds[2] = {-1, -1};
+    if (::pipe(fds) != 0) {
+        throw std::system_error(errno, std::generic_category(), "Reactor wake-up pipe");
+    }
+    set_nonblocking(fds[0]);
+    set_nonblocking(fds[1]);
+    wake_read_fd_ = fds[0];
+    wake_write_fd_ = fds[1];
+}
+
+Reactor::~Reactor() {
+    ::close(wake_read_fd_);
+    ::close(wake_write_fd_);
+}
+
+std::size_t Reactor::add_socket(zmq::socket_t& socket, short events, Handler handler) {
+    sockets_.push_back(SocketEntry{&socket, events, std::move(handler)});
+    return sockets_.size() - 1;
+}
+
+void Reactor::set_events(std::size_t id, short events) {
+    sockets_.at(id).events = events;
+}
+
+void Reactor::add_timer(std::chrono::milliseconds interval, Handler handler) {
+    interval = std::max(interval, std::chrono::milliseconds(1));
+    timers_.push_back(Timer{interval, Clock::now() + interval, std::move(handler)});
+}
+
+void Reactor::wake() {
+    // One byte in the pipe is enough however many threads call this before the loop runs.
+    if (!wake_pending_.exchange(true)) {
+        const char byte = 1;
+        [[maybe_unused]] const auto written = ::write(wake_write_fd_, &byte, 1);
+    }
+}
+
+void Reactor::stop() {
+    stopped_.store(true);
+    wake();
+}
+
+void Reactor::drain_wake_pipe() {
+    char buffer[64];
+    while (::read(wake_read_fd_, buffer, sizeof(buffer)) > 0) {
+    }
+    // Cleared before the handler runs so a wake() during it is not lost.
+    wake_pending_.store(false);
+}
+
+void Reactor::run(const std::atomic_bool& keep_running, std::chrono::milliseconds stop_check) {
+    std::vector<zmq::pollitem_t> items;
+    std::vector<std::size_t> owners;  // items[i] belongs to sockets_[owners[i]]
+    while (keep_running.load() && !stopped_.load()) {
+        if (prepare_) {
+            prepare_();
+        }
+
+        items.clear();
+        owners.clear();
+        items.push_back({nullptr, wake_read_fd_, ZMQ_POLLIN, 0});
+        for (std::size_t i = 0; i < sockets_.size(); ++i) {
+            if (sockets_[i].events != 0) {
+                items.push_back({sockets_[i].socket->handle(), 0, sockets_[i].events, 0});
+                owners.push_back(i);
+            }
+        }
+
+        auto now = Clock::now();
+        auto timeout = stop_check;
+        for (const auto& timer : timers_) {
+            const auto until = std::chrono::ceil<std::chrono::milliseconds>(timer.due - now);
+            timeout = std::min(timeout, std::max(until, std::chrono::milliseconds(0)));
+        }
+
+        try {
+            zmq::poll(items, timeout);
+        } catch (const zmq::error_t& ex) {
+            if (ex.num() == EINTR) {
+                continue;  // Signal; re-check keep_running
+            }
+            throw;
+        }
+
+        if ((items[0].revents & ZMQ_POLLIN) != 0) {
+            drain_wake_pipe();
+            if (wake_handler_) {
+                wake_handler_();
+            }
+        }
+        for (std::size_t i = 1; i < items.size(); ++i) {
+            if ((items[i].revents & items[i].events) != 0) {
+                sockets_[owners[i - 1]].handler();
+            }
+        }
+
+        now = Clock::now();
+        for (auto& timer : timers_) {
+            if (timer.due <= now) {
+                timer.handler();
+                timer.due += timer.interval;
+                if (timer.due <= now) {
+                    timer.due = now + timer.interval;  // Skip missed ticks, no catch-up burst
+                }
+            }
+        }
+    }
+}
+
+}  // namespace dist::common
@@ -0,0 +1,236 @@
+#include "dist/common/segment_store.hpp"
+
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace dist::common {
+
+namespace {
+
+constexpr std::uint64_t kMinSegmentBytes = 1024 * 1024;
+
+// Highest segment id already on disk (0 when the directory is empty).
+std::uint32_t last_segment_id(const fs::path& dir) {
+    std::uint32_t last = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("segment_", 0) != 0 || entry.path().extension() != ".dat") {
+            continue;
+        }
+        try {
+            last = std::max(last, static_cast<std::uint32_t>(std::stoul(name.substr(8))));
+        } catch (const std::exception&) {
+            // Not one of ours.
+        }
+    }
+    return last;
+}
+
+}  // namespace
+
+fs::path segment_path(const fs::path& dir, std::uint32_t segment_id) {
+    return dir / fmt::format("segment_{:06}.dat", segment_id);
+}
+
+SegmentWriter::SegmentWriter(fs::path dir, std::uint64_t max_segment_bytes)
+    : dir_(std::move(dir)), max_segment_bytes_(std::max(max_segment_bytes, kMinSegmentBytes)) {
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    if (ec) {
+        throw std::runtime_error("Unable to create segment directory " + dir_.string() + ": " +
+                                 ec.message());
+    }
+    if (!open_segment(last_segment_id(dir_) + 1)) {
+        throw std::runtime_error("Unable to open a segment file in " + dir_.string());
+    }
+}
+
+SegmentWriter::~SegmentWriter() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool SegmentWriter::open_segment(std::uint32_t segment_id) {
+    const fs::path path = segment_path(dir_, segment_id);
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        spdlog::error("Failed to create segment {}: {}", path.string(), std::strerror(errno));
+        return false;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = fd;
+    segment_id_ = segment_id;
+    segment_bytes_ = 0;
+    spdlog::debug("Opened segment {}", path.string());
+    return true;
+}
+
+std::optional<SegmentLocation> SegmentWriter::append(std::int64_t frame_id,
+                                                     SegmentRecordKind kind,
+                                                     const void* data,
+                                                     std::size_t size) {
+    const std::uint64_t record_bytes = sizeof(SegmentRecordHeader) + size;
+    // Roll before the limit rather than after, but never leave a segment empty.
+    if (segment_bytes_ > 0 && segment_bytes_ + record_bytes > max_segment_bytes_) {
+        // Sealed segments are durable before the next one starts.
+        if (::fdatasync(fd_) != 0) {
+            spdlog::warn("fdatasync on segment {} failed: {}", segment_id_, std::strerror(errno));
+        }
+        if (!open_segment(segment_id_ + 1)) {
+            return std::nullopt;
+        }
+    }
+
+    SegmentRecordHeader header;
+    header.magic = kSegmentRecordMagic;
+    header.kind = static_cast<std::uint32_t>(kind);
+    header.frame_id = frame_id;
+    header.length = size;
+
+    iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = const_cast<void*>(data);
+    iov[1].iov_len = size;
+
+    // pwritev at our own offset, so a failed append is simply overwritten by the next one.
+    iovec* pending = iov;
+    int pending_count = 2;
+    auto position = static_cast<off_t>(segment_bytes_);
+    while (pending_count > 0) {
+        const ssize_t rc = ::pwritev(fd_, pending, pending_count, position);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            spdlog::error("Failed to append frame {} to segment {}: {}",
+                          frame_id,
+                          segment_id_,
+                          std::strerror(errno));
+            return std::nullopt;
+        }
+        position += rc;
+        auto done = static_cast<std::size_t>(rc);
+        while (pending_count > 0 && done >= pending->iov_len) {
+            done -= pending->iov_len;
+            ++pending;
+            --pending_count;
+        }
+        if (pending_count > 0) {
+            pending->iov_base = static_cast<std::uint8_t*>(pending->iov_base) + done;
+            pending->iov_len -= done;
+        }
+    }
+
+    SegmentLocation location;
+    location.segment_id = segment_id_;
+    location.offset = segment_bytes_ + sizeof(SegmentRecordHeader);
+    location.length = size;
+    segment_bytes_ += record_bytes;
+    return location;
+}
+
+bool SegmentWriter::sync() {
+    if (fd_ < 0 || segment_bytes_ == 0) {
+        return true;
+    }
+    if (::fdatasync(fd_) != 0) {
+        spdlog::error("fdatasync on segment {} failed: {}", segment_id_, std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+SegmentReader::SegmentReader(fs::path dir) : dir_(std::move(dir)) {}
+
+SegmentReader::~SegmentReader() {
+    for (const auto& [id, mapping] : mappings_) {
+        ::munmap(const_cast<std::uint8_t*>(mapping.base), mapping.size);
+    }
+    for (const auto& mapping : retired_) {
+        ::munmap(const_cast<std::uint8_t*>(mapping.base), mapping.size);
+    }
+}
+
+const SegmentReader::Mapping* SegmentReader::map_segment(std::uint32_t segment_id,
+                                                         std::uint64_t min_size) {
+    auto it = mappings_.find(segment_id);
+    if (it != mappings_.end() && it->second.size >= min_size) {
+        return &it->second;
+    }
+
+    const fs::path path = segment_path(dir_, segment_id);
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        spdlog::warn("Unable to open segment {}: {}", path.string(), std::strerror(errno));
+        return nullptr;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || static_cast<std::uint64_t>(st.st_size) < min_size ||
+        st.st_size == 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    const auto size = static_cast<std::size_t>(st.st_size);
+    void* base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        spdlog::warn("Unable to map segment {}: {}", path.string(), std::strerror(errno));
+        return nullptr;
+    }
+
+    if (it != mappings_.end()) {
+        retired_.push_back(it->second);  // Earlier spans may still point into it
+        it->second = {static_cast<const std::uint8_t*>(base), size};
+        return &it->second;
+    }
+    auto [inserted, ok] =
+        mappings_.emplace(segment_id, Mapping{static_cast<const std::uint8_t*>(base), size});
+    (void)ok;
+    return &inserted->second;
+}
+
+std::optional<std::span<const std::uint8_t>> SegmentReader::read(const SegmentLocation& location) {
+    if (location.offset < sizeof(SegmentRecordHeader)) {
+        return std::nullopt;
+    }
+    const Mapping* mapping = map_segment(location.segment_id, location.offset + location.length);
+    if (mapping == nullptr) {
+        return std::nullopt;
+    }
+
+    // Cheap sanity check that the index and the segment agree.
+    SegmentRecordHeader header;
+    std::memcpy(&header, mapping->base + location.offset - sizeof(header), sizeof(header));
+    if (header.magic != kSegmentRecordMagic || header.length != location.length) {
+        spdlog::warn("Segment {} has no record of {} bytes at offset {}",
+                     location.segment_id,
+                     location.length,
+                     location.offset);
+        return std::nullopt;
+    }
+    return std::span<const std::uint8_t>(mapping->base + location.offset,
+                                         static_cast<std::size_t>(location.length));
+}
+
+}  // namespace dist::common
@@ -0,0 +1,482 @@
+#include "dist/common/shm_transport.hpp"
+
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <new>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+#include "dist/common/metrics.hpp"
+
+namespace dist::common {
+
+namespace {
+
+constexpr std::string_view kScheme = "shm://";
+constexpr std::size_t kMaxNameBytes = 32;
+constexpr std::uint32_t kRingMagic = 0x47525344;        // "DSRG" little-endian
+constexpr std::uint32_t kDescriptorMagic = 0x4d485344;  // "DSHM" little-endian
+constexpr std::uint32_t kRingVersion = 1;
+constexpr std::size_t kMaxReaders = 32;
+constexpr std::size_t kSegmentNameBytes = 48;
+constexpr std::uint64_t kBlockAlign = 64;
+constexpr std::uint64_t kPageBytes = 4096;
+constexpr std::uint64_t kMinCapacity = 1024 * 1024;
+constexpr std::uint64_t kNothingHeld = std::numeric_limits<std::uint64_t>::max();
+constexpr std::size_t kMaxMappedSegments = 8;  // Idle mappings of restarted senders go first
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "shared-memory ring needs lock-free 64-bit atomics");
+
+// One receiving process; `oldest` is the oldest sequence it still maps.
+struct ReaderSlot {
+    std::atomic<std::int32_t> pid;
+    std::atomic<std::uint64_t> oldest;
+};
+
+struct RingHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t capacity;     // Bytes of block space after data_offset
+    std::uint64_t data_offset;  // Page-aligned start of the block space
+    ReaderSlot slots[kMaxReaders];
+};
+
+// Each block is [BlockHeader][payload] at a kBlockAlign boundary; sequence 0 marks it
+// free or being rewritten.
+struct BlockHeader {
+    std::atomic<std::uint64_t> sequence;
+    std::uint64_t length;
+};
+
+// Sent in place of a part that went through the ring.
+struct ShmDescriptor {
+    std::uint32_t magic;
+    std::uint32_t version;
+    char segment[kSegmentNameBytes];
+    std::uint64_t offset;  // Block header offset within the block space
+    std::uint64_t length;
+    std::uint64_t sequence;
+};
+static_assert(sizeof(ShmDescriptor) == 80, "ShmDescriptor layout changed");
+
+struct ShmMetrics {
+    Counter& written;
+    Counter& inlined;
+    Counter& mapped;
+    Counter& copied;
+    Counter& lost;
+};
+
+ShmMetrics& shm_metrics() {
+    static ShmMetrics instance{
+        metrics().counter("dist_shm_parts_written_total", "Parts sent through a shared-memory ring"),
+        metrics().counter("dist_shm_parts_inline_total",
+                          "Large parts sent inline because the ring had no free space"),
+        metrics().counter("dist_shm_parts_mapped_total",
+                          "Received parts mapped from a sender's ring"),
+        metrics().counter("dist_shm_parts_copied_total",
+                          "Received parts copied out of a ring with no free reader slot"),
+        metrics().counter("dist_shm_parts_lost_total",
+                          "Received descriptors whose ring space was already reused")};
+    return instance;
+}
+
+constexpr std::uint64_t align_up(std::uint64_t value, std::uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+std::optional<std::string_view> shm_name(std::string_view endpoint) {
+    if (endpoint.substr(0, kScheme.size()) != kScheme) {
+        return std::nullopt;
+    }
+    const auto name = endpoint.substr(kScheme.size());
+    const bool valid =
+        !name.empty() && name.size() <= kMaxNameBytes &&
+        std::all_of(name.begin(), name.end(), [](char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                   c == '-' || c == '_';
+        });
+    if (!valid) {
+        return std::nullopt;
+    }
+    return name;
+}
+
+bool process_gone(std::int32_t pid) {
+    return ::kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+// Segments left behind by senders of this endpoint that died without unlinking them.
+void remove_stale_segments(std::string_view name) {
+    const std::string prefix = fmt::format("dist-{}-", name);
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/dev/shm", ec)) {
+        const std::string file = entry.path().filename().string();
+        if (file.rfind(prefix, 0) != 0) {
+            continue;
+        }
+        std::int32_t pid = 0;
+        const char* first = file.data() + prefix.size();
+        const char* last = file.data() + file.size();
+        const auto [end, error] = std::from_chars(first, last, pid);
+        if (error != std::errc{} || end != last || pid == ::getpid() || !process_gone(pid)) {
+            continue;
+        }
+        if (::shm_unlink(("/" + file).c_str()) == 0) {
+            spdlog::info("Removed stale shared-memory segment /{}", file);
+        }
+    }
+}
+
+}  // namespace
+
+// A sender's ring as mapped by this process, with the sequences it still hands out.
+struct ShmReader::Segment {
+    void* base = nullptr;
+    std::size_t mapped_bytes = 0;
+    std::uint8_t* data = nullptr;
+    std::uint64_t capacity = 0;
+    ReaderSlot* slot = nullptr;  // Null when every slot is taken; parts are copied then
+    std::mutex mutex;
+    std::multiset<std::uint64_t> held;
+
+    ~Segment() {
+        if (slot != nullptr) {
+            slot->oldest.store(kNothingHeld);
+            slot->pid.store(0);
+        }
+        if (base != nullptr) {
+            ::munmap(base, mapped_bytes);
+        }
+    }
+
+    [[nodiscard]] BlockHeader* block_at(std::uint64_t offset) const {
+        return reinterpret_cast<BlockHeader*>(data + offset);
+    }
+
+    void hold(std::uint64_t sequence) {
+        std::lock_guard lock(mutex);
+        held.insert(sequence);
+        publish_oldest_locked();
+    }
+
+    void release(std::uint64_t sequence) {
+        std::lock_guard lock(mutex);
+        if (const auto it = held.find(sequence); it != held.end()) {
+            held.erase(it);
+        }
+        publish_oldest_locked();
+    }
+
+  private:
+    void publish_oldest_locked() {
+        slot->oldest.store(held.empty() ? kNothingHeld : *held.begin());
+    }
+};
+
+namespace {
+
+struct Hold {
+    std::shared_ptr<ShmReader::Segment> segment;
+    std::uint64_t sequence = 0;
+};
+
+void release_hold(void* /*data*/, void* hint) {
+    auto* hold = static_cast<Hold*>(hint);
+    hold->segment->release(hold->sequence);
+    delete hold;
+}
+
+}  // namespace
+
+bool is_shm_endpoint(std::string_view endpoint) {
+    return shm_name(endpoint).has_value();
+}
+
+std::string zmq_endpoint(std::string_view endpoint) {
+    if (const auto name = shm_name(endpoint)) {
+        return fmt::format("ipc:///tmp/dist-shm-{}.ipc", *name);
+    }
+    return std::string(endpoint);
+}
+
+ShmWriter::ShmWriter(std::string_view endpoint, std::size_t capacity) {
+    const auto name = shm_name(endpoint);
+    if (!name) {
+        throw std::runtime_error("Invalid shared-memory endpoint " + std::string(endpoint));
+    }
+    remove_stale_segments(*name);
+    segment_ = fmt::format("/dist-{}-{}", *name, ::getpid());
+    capacity_ = std::max<std::uint64_t>(capacity, kMinCapacity) / kBlockAlign * kBlockAlign;
+    const std::uint64_t data_offset = align_up(sizeof(RingHeader), kPageBytes);
+    mapped_bytes_ = static_cast<std::size_t>(data_offset + capacity_);
+
+    const int fd = ::shm_open(segment_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        throw std::runtime_error(fmt::format(
+            "Unable to create shared-memory segment {}: {}", segment_, std::strerror(errno)));
+    }
+    // Reserve the pages now: a tmpfs that runs out under a mapping raises SIGBUS later.
+    void* base = MAP_FAILED;
+    int error = ::posix_fallocate(fd, 0, static_cast<off_t>(mapped_bytes_));
+    if (error == 0) {
+        base = ::mmap(nullptr, mapped_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        error = errno;
+    }
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        ::shm_unlink(segment_.c_str());
+        throw std::runtime_error(fmt::format(
+            "Unable to map shared-memory segment {}: {}", segment_, std::strerror(error)));
+    }
+    base_ = base;
+    data_ = static_cast<std::uint8_t*>(base_) + data_offset;
+
+    auto* header = new (base_) RingHeader{};
+    header->version = kRingVersion;
+    header->capacity = capacity_;
+    header->data_offset = data_offset;
+    for (auto& slot : header->slots) {
+        slot.oldest.store(kNothingHeld);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = kRingMagic;
+}
+
+ShmWriter::~ShmWriter() {
+    if (base_ != nullptr) {
+        ::munmap(base_, mapped_bytes_);
+        // Readers keep their mappings; new ones only ever see this sender's next segment.
+        ::shm_unlink(segment_.c_str());
+    }
+}
+
+bool ShmWriter::send(zmq::socket_t& socket,
+                     std::vector<zmq::message_t>& parts,
+                     zmq::send_flags flags) {
+    auto& metrics = shm_metrics();
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        zmq::message_t part;
+        std::optional<zmq::message_t> descriptor;
+        if (parts[i].size() >= kMinPartBytes) {
+            descriptor = publish(parts[i]);
+            (descriptor ? metrics.written : metrics.inlined).inc();
+        }
+        if (descriptor) {
+            part = std::move(*descriptor);
+        } else {
+            part.copy(parts[i]);
+        }
+        const bool last = i + 1 == parts.size();
+        if (!socket.send(part, last ? flags : flags | zmq::send_flags::sndmore)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<zmq::message_t> ShmWriter::publish(const zmq::message_t& part) {
+    const std::uint64_t need = align_up(sizeof(BlockHeader) + part.size(), kBlockAlign);
+    if (need > capacity_ / 2) {
+        return std::nullopt;
+    }
+    const bool wrap = head_ + need > capacity_;
+    const std::uint64_t start = wrap ? 0 : head_;
+    const std::uint64_t end = start + need;
+    const auto block_at = [this](std::uint64_t offset) {
+        return reinterpret_cast<BlockHeader*>(data_ + offset);
+    };
+
+    // The space comes from the oldest blocks: those overlapping it and, on a wrap, those
+    // left between the old head and the end of the ring.
+    std::size_t victims = 0;
+    for (const auto& block : live_) {
+        const bool past_head = wrap && block.offset >= head_;
+        const bool overlaps = block.offset < end && start < block.offset + block.size;
+        if (!past_head && !overlaps) {
+            break;
+        }
+        ++victims;
+    }
+    // Invalidate before checking the readers: one that maps a victim after this sees it
+    // gone, one that mapped it before has already published its hold.
+    for (std::size_t i = 0; i < victims; ++i) {
+        block_at(live_[i].offset)->sequence.store(0);
+    }
+    if (victims > 0 && pinned(live_[victims - 1].sequence)) {
+        for (std::size_t i = 0; i < victims; ++i) {
+            block_at(live_[i].offset)->sequence.store(live_[i].sequence);
+        }
+        return std::nullopt;
+    }
+    live_.erase(live_.begin(), live_.begin() + static_cast<std::ptrdiff_t>(victims));
+
+    auto* block = block_at(start);
+    block->sequence.store(0);
+    block->length = part.size();
+    std::memcpy(data_ + start + sizeof(BlockHeader), part.data(), part.size());
+    const std::uint64_t sequence = next_sequence_++;
+    block->sequence.store(sequence);
+    live_.push_back({start, need, sequence});
+    head_ = end;
+
+    ShmDescriptor descriptor{};
+    descriptor.magic = kDescriptorMagic;
+    descriptor.version = kRingVersion;
+    std::memcpy(descriptor.segment,
+                segment_.data(),
+                std::min(segment_.size(), kSegmentNameBytes - 1));
+    descriptor.offset = start;
+    descriptor.length = part.size();
+    descriptor.sequence = sequence;
+    return zmq::message_t(&descriptor, sizeof(descriptor));
+}
+
+bool ShmWriter::pinned(std::uint64_t sequence) {
+    auto* header = static_cast<RingHeader*>(base_);
+    bool held = false;
+    for (auto& slot : header->slots) {
+        const std::int32_t pid = slot.pid.load();
+        if (pid == 0 || slot.oldest.load() > sequence) {
+            continue;
+        }
+        if (process_gone(pid)) {
+            spdlog::warn("Shared-memory reader {} of {} is gone; releasing its frames",
+                         pid,
+                         segment_);
+            slot.oldest.store(kNothingHeld);
+            slot.pid.store(0);
+            continue;
+        }
+        held = true;
+    }
+    return held;
+}
+
+ShmReader::~ShmReader() = default;
+
+std::shared_ptr<ShmReader::Segment> ShmReader::open(const std::string& name) {
+    std::lock_guard lock(mutex_);
+    if (const auto it = segments_.find(name); it != segments_.end()) {
+        return it->second;
+    }
+    if (segments_.size() >= kMaxMappedSegments) {
+        std::erase_if(segments_, [](const auto& entry) { return entry.second.use_count() <= 1; });
+    }
+    auto& segment = segments_[name];  // Stays null if the mapping fails, so it warns once
+
+    const int fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    struct stat info {};
+    if (fd < 0 || ::fstat(fd, &info) != 0 ||
+        static_cast<std::size_t>(info.st_size) < sizeof(RingHeader)) {
+        spdlog::warn("Unable to open shared-memory segment {}: {}", name, std::strerror(errno));
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return nullptr;
+    }
+    const auto mapped_bytes = static_cast<std::size_t>(info.st_size);
+    void* base = ::mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        spdlog::warn("Unable to map shared-memory segment {}: {}", name, std::strerror(errno));
+        return nullptr;
+    }
+    auto mapped = std::make_shared<Segment>();
+    mapped->base = base;
+    mapped->mapped_bytes = mapped_bytes;
+    auto* header = static_cast<RingHeader*>(base);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->magic != kRingMagic || header->version != kRingVersion ||
+        header->data_offset + header->capacity > mapped_bytes) {
+        spdlog::warn("Shared-memory segment {} is not a frame ring", name);
+        return nullptr;
+    }
+    mapped->data = static_cast<std::uint8_t*>(base) + header->data_offset;
+    mapped->capacity = header->capacity;
+    const auto pid = static_cast<std::int32_t>(::getpid());
+    for (auto& slot : header->slots) {
+        std::int32_t expected = 0;
+        if (slot.pid.compare_exchange_strong(expected, pid)) {
+            slot.oldest.store(kNothingHeld);
+            mapped->slot = &slot;
+            break;
+        }
+    }
+    if (mapped->slot == nullptr) {
+        spdlog::warn("All {} reader slots of {} are taken; copying its frames", kMaxReaders, name);
+    }
+    spdlog::info("Mapped shared-memory segment {} ({} MB)", name, mapped->capacity / (1024 * 1024));
+    segment = std::move(mapped);
+    return segment;
+}
+
+std::optional<zmq::message_t> ShmReader::resolve(zmq::message_t part) {
+    if (part.size() != sizeof(ShmDescriptor)) {
+        return part;
+    }
+    ShmDescriptor descriptor{};
+    std::memcpy(&descriptor, part.data(), sizeof(descriptor));
+    if (descriptor.magic != kDescriptorMagic || descriptor.version != kRingVersion) {
+        return part;
+    }
+    descriptor.segment[kSegmentNameBytes - 1] = '\0';
+
+    auto& metrics = shm_metrics();
+    const auto segment = open(descriptor.segment);
+    if (!segment || descriptor.offset % kBlockAlign != 0 ||
+        descriptor.offset + sizeof(BlockHeader) + descriptor.length > segment->capacity) {
+        metrics.lost.inc();
+        return std::nullopt;
+    }
+    const auto* block = segment->block_at(descriptor.offset);
+    auto* payload = segment->data + descriptor.offset + sizeof(BlockHeader);
+
+    if (segment->slot == nullptr) {
+        // No hold to publish: copy, then check the sender did not rewrite it meanwhile.
+        const bool current = block->sequence.load() == descriptor.sequence;
+        zmq::message_t copy(static_cast<std::size_t>(descriptor.length));
+        std::memcpy(copy.data(), payload, copy.size());
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!current || block->sequence.load() != descriptor.sequence) {
+            metrics.lost.inc();
+            return std::nullopt;
+        }
+        metrics.copied.inc();
+        return copy;
+    }
+
+    // Publish the hold before checking, pairing with the sender's invalidate-then-check.
+    segment->hold(descriptor.sequence);
+    if (block->sequence.load() != descriptor.sequence || block->length != descriptor.length) {
+        segment->release(descriptor.sequence);
+        metrics.lost.inc();
+        return std::nullopt;
+    }
+    metrics.mapped.inc();
+    auto* hold = new Hold{segment, descriptor.sequence};
+    return zmq::message_t(payload, static_cast<std::size_t>(descriptor.length), &release_hold, hold);
+}
+
+ShmReader& shm_reader() {
+    static ShmReader reader;
+    return reader;
+}
+
+}  // namespace dist::common
@@ -0,0 +1,106 @@
+#include "dist/common/stream.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+namespace dist::common {
+
+namespace {
+constexpr char kTopicTerminator = '/';
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && std::isspace(static_cast<unsigned char>(value.front()))) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back()))) {
+        value.remove_suffix(1);
+    }
+    return value;
+}
+}  // namespace
+
+bool valid_stream_id(std::string_view id) {
+    return !id.empty() && std::all_of(id.begin(), id.end(), [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-' || c == '.';
+    });
+}
+
+std::string stream_topic(std::string_view id) {
+    std::string topic(id);
+    topic += kTopicTerminator;
+    return topic;
+}
+
+std::optional<std::string> stream_from_topic(std::string_view topic) {
+    if (topic.empty() || topic.back() != kTopicTerminator) {
+        return std::nullopt;
+    }
+    topic.remove_suffix(1);
+    if (!valid_stream_id(topic)) {
+        return std::nullopt;
+    }
+    return std::string(topic);
+}
+
+std::string stream_label(std::string_view id) {
+    // Valid ids never need escaping inside a label value.
+    std::string label = "stream=\"";
+    label += id;
+    label += '"';
+    return label;
+}
+
+std::vector<std::string> parse_stream_list(std::string_view list, std::string_view setting) {
+    std::vector<std::string> streams;
+    while (!list.empty()) {
+        const auto comma = list.find(',');
+        const auto id = trim(list.substr(0, comma));
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+        if (id.empty()) {
+            continue;
+        }
+        if (!valid_stream_id(id)) {
+            spdlog::warn("{}: ignoring invalid stream id '{}'", setting, id);
+            continue;
+        }
+        if (std::find(streams.begin(), streams.end(), id) == streams.end()) {
+            streams.emplace_back(id);
+        }
+    }
+    return streams;
+}
+
+void subscribe_streams(zmq::socket_t& socket, const std::vector<std::string>& streams) {
+    if (streams.empty()) {
+        socket.set(zmq::sockopt::subscribe, "");
+        return;
+    }
+    for (const auto& id : streams) {
+        socket.set(zmq::sockopt::subscribe, stream_topic(id));
+    }
+}
+
+StreamGaps::StreamGaps(MetricsRegistry& registry, std::string name, std::string help)
+    : registry_(registry), name_(std::move(name)), help_(std::move(help)) {}
+
+void StreamGaps::observe(const std::string& stream, std::int64_t id) {
+    auto it = streams_.find(stream);
+    if (it == streams_.end()) {
+        auto& missing = registry_.counter(name_, help_, stream_label(stream));
+        it = streams_.emplace(stream, Entry{missing, SequenceGaps{missing}}).first;
+    }
+    it->second.gaps.observe(id);
+}
+
+std::uint64_t StreamGaps::total() const {
+    std::uint64_t total = 0;
+    for (const auto& [stream, entry] : streams_) {
+        total += entry.missing.value();
+    }
+    return total;
+}
+
+}  // namespace dist::common
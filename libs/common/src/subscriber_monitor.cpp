@@ -0,0 +1,62 @@
+#include "dist/common/subscriber_monitor.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <utility>
+
+namespace dist::common {
+
+SubscriberMonitor::SubscriberMonitor(std::string address) : address_(std::move(address)) {}
+
+SubscriberMonitor::~SubscriberMonitor() {
+    stop();
+}
+
+void SubscriberMonitor::start(zmq::socket_t& socket) {
+    stop_flag_.store(false);
+    sub_count_.store(0);
+    monitor_thread_ = std::thread([this, &socket]() {
+        try {
+            init(socket,
+                 address_.c_str(),
+                 ZMQ_EVENT_CONNECTED | ZMQ_EVENT_ACCEPTED | ZMQ_EVENT_DISCONNECTED |
+                     ZMQ_EVENT_CLOSED);
+        } catch (const zmq::error_t& ex) {
+            spdlog::warn("Failed to start socket monitor: {}", ex.what());
+            return;
+        }
+
+        while (!stop_flag_.load()) {
+            check_event(250);
+        }
+    });
+}
+
+void SubscriberMonitor::stop() {
+    stop_flag_.store(true);
+    if (monitor_thread_.joinable()) {
+        monitor_thread_.join();
+    }
+    changed_.notify_all();
+}
+
+bool SubscriberMonitor::wait_for_subscriber(std::chrono::milliseconds timeout) {
+    std::unique_lock lock(mutex_);
+    return changed_.wait_for(lock, timeout, [this] {
+        return sub_count_.load() > 0 || stop_flag_.load();
+    }) && sub_count_.load() > 0;
+}
+
+void SubscriberMonitor::adjust(int delta) {
+    {
+        // Taken so a waiter cannot miss the change between its check and its wait.
+        std::lock_guard lock(mutex_);
+        sub_count_.fetch_add(delta);
+    }
+    changed_.notify_all();
+    if (on_change_) {
+        on_change_();
+    }
+}
+
+}  // namespace dist::common
@@ -0,0 +1,63 @@
+#include "dist/common/trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+namespace dist::common {
+
+namespace {
+
+constexpr std::array<std::string_view, kTraceStageCount> kStageNames{
+    "read", "encode", "send", "receive", "decode", "detect", "serialize", "logged", "persist"};
+
+}  // namespace
+
+std::string_view to_string(TraceStage stage) {
+    return kStageNames[static_cast<std::size_t>(stage)];
+}
+
+std::int64_t trace_clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+bool FrameTrace::empty() const {
+    return std::all_of(ns.begin(), ns.end(), [](std::int64_t value) { return value == 0; });
+}
+
+std::optional<std::int64_t> FrameTrace::between(TraceStage from, TraceStage to) const {
+    const std::int64_t start = at(from);
+    const std::int64_t end = at(to);
+    if (start == 0 || end == 0) {
+        return std::nullopt;
+    }
+    return end - start;
+}
+
+nlohmann::json trace_to_json(const FrameTrace& trace) {
+    nlohmann::json json = nlohmann::json::object();
+    for (std::size_t i = 0; i < kTraceStageCount; ++i) {
+        if (trace.ns[i] != 0) {
+            json[std::string(kStageNames[i])] = trace.ns[i];
+        }
+    }
+    return json;
+}
+
+FrameTrace trace_from_json(const nlohmann::json& json) {
+    FrameTrace trace;
+    if (!json.is_object()) {
+        return trace;
+    }
+    for (std::size_t i = 0; i < kTraceStageCount; ++i) {
+        const auto it = json.find(std::string(kStageNames[i]));
+        if (it != json.end() && it->is_number_integer()) {
+            trace.ns[i] = it->get<std::int64_t>();
+        }
+    }
+    return trace;
+}
+
+}  // namespace dist::common
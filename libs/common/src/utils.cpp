@@ -1,7 +1,10 @@
 #include "dist/common/utils.hpp"
 
+#include <bit>
+#include <charconv>
 #include <chrono>
 #include <csignal>
+#include <cstring>
 #include <ctime>
 #include <unordered_map>
 
@@ -47,6 +50,76 @@ std::string now_iso8601() {
     return std::string(buffer);
 }
 
+std::optional<std::int64_t> iso8601_to_epoch_ms(std::string_view text) {
+    // Fixed-width fields: YYYY-MM-DDTHH:MM:SS, then optional fraction, then Z.
+    const auto field = [&](std::size_t pos, std::size_t width) -> std::optional<int> {
+        int value = 0;
+        if (pos + width > text.size()) {
+            return std::nullopt;
+        }
+        const auto* begin = text.data() + pos;
+        const auto [end, ec] = std::from_chars(begin, begin + width, value);
+        if (ec != std::errc{} || end != begin + width) {
+            return std::nullopt;
+        }
+        return value;
+    };
+    if (text.size() < 20 || text[4] != '-' || text[7] != '-' || text[10] != 'T' || text[13] != ':' ||
+        text[16] != ':') {
+        return std::nullopt;
+    }
+    const auto year = field(0, 4);
+    const auto month = field(5, 2);
+    const auto day = field(8, 2);
+    const auto hour = field(11, 2);
+    const auto minute = field(14, 2);
+    const auto second = field(17, 2);
+    if (!year || !month || !day || !hour || !minute || !second) {
+        return std::nullopt;
+    }
+
+    std::size_t pos = 19;
+    std::int64_t millis = 0;
+    if (text[pos] == '.') {
+        int scale = 100;
+        for (++pos; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; ++pos) {
+            millis += (text[pos] - '0') * scale;
+            scale /= 10;
+        }
+    }
+    if (pos + 1 != text.size() || text[pos] != 'Z') {
+        return std::nullopt;
+    }
+
+    const std::chrono::year_month_day date{std::chrono::year{*year},
+                                           std::chrono::month{static_cast<unsigned>(*month)},
+                                           std::chrono::day{static_cast<unsigned>(*day)}};
+    if (!date.ok() || *hour > 23 || *minute > 59 || *second > 60) {
+        return std::nullopt;
+    }
+    const auto midnight = std::chrono::sys_days{date}.time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(midnight).count() +
+           ((*hour * 60 + *minute) * 60 + *second) * std::int64_t{1000} + millis;
+}
+
+std::uint64_t content_hash(const void* data, std::size_t size) {
+    constexpr std::uint64_t kOffsetBasis = 14695981039346656037ULL;
+    constexpr std::uint64_t kPrime = 1099511628211ULL;
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    std::uint64_t hash = kOffsetBasis ^ size;
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        // The rotate feeds high bits back down; a plain multiply only carries upwards.
+        hash = std::rotl((hash ^ word) * kPrime, 29);
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * kPrime;
+    }
+    return hash;
+}
+
 void install_signal_handlers(std::atomic_bool& keep_running_flag) {
     // Remember the flag pointer so the static signal handler can mutate it.
     g_signal_flag = &keep_running_flag;
@@ -0,0 +1,95 @@
+#include "dist/common/buffer_pool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+using dist::common::BufferPool;
+
+namespace {
+
+constexpr std::size_t kKiB = 1024;
+
+std::vector<std::uint8_t> buffer_of(std::size_t capacity) {
+    std::vector<std::uint8_t> buffer;
+    buffer.reserve(capacity);
+    buffer.resize(16);
+    return buffer;
+}
+
+}  // namespace
+
+TEST(BufferPoolTest, SmallBuffersAreNotKept) {
+    BufferPool pool{1024 * kKiB};
+    pool.release(buffer_of(BufferPool::kMinPooledBytes - 1));
+    EXPECT_EQ(pool.pooled_bytes(), 0U);
+}
+
+TEST(BufferPoolTest, ReleasedBufferIsReusedEmpty) {
+    BufferPool pool{1024 * kKiB};
+    auto buffer = buffer_of(128 * kKiB);
+    const std::size_t capacity = buffer.capacity();
+    const auto* data = buffer.data();
+    pool.release(std::move(buffer));
+    EXPECT_EQ(pool.pooled_bytes(), capacity);
+
+    auto reused = pool.acquire(100 * kKiB);
+    EXPECT_EQ(reused.data(), data);
+    EXPECT_TRUE(reused.empty());
+    EXPECT_EQ(reused.capacity(), capacity);
+    EXPECT_EQ(pool.pooled_bytes(), 0U);
+}
+
+TEST(BufferPoolTest, AcquirePicksTheSmallestBufferThatFits) {
+    BufferPool pool{1024 * kKiB};
+    pool.release(buffer_of(64 * kKiB));
+    pool.release(buffer_of(256 * kKiB));
+    pool.release(buffer_of(128 * kKiB));
+
+    EXPECT_EQ(pool.acquire(100 * kKiB).capacity(), 128 * kKiB);
+    EXPECT_EQ(pool.acquire(100 * kKiB).capacity(), 256 * kKiB);
+    // Nothing pooled fits any more: a fresh vector, and the 64 KiB buffer stays.
+    EXPECT_GE(pool.acquire(100 * kKiB).capacity(), 100 * kKiB);
+    EXPECT_EQ(pool.pooled_bytes(), 64 * kKiB);
+    EXPECT_EQ(pool.acquire().capacity(), 64 * kKiB);  // No hint: the largest left
+    EXPECT_EQ(pool.pooled_bytes(), 0U);
+}
+
+TEST(BufferPoolTest, ReleaseBeyondTheBudgetFreesTheBuffer) {
+    BufferPool pool{200 * kKiB};
+    pool.release(buffer_of(128 * kKiB));
+    pool.release(buffer_of(128 * kKiB));
+    EXPECT_EQ(pool.pooled_bytes(), 128 * kKiB);
+}
+
+TEST(BufferPoolTest, ShrinkingTheBudgetTrimsTheSmallestFirst) {
+    BufferPool pool{1024 * kKiB};
+    pool.release(buffer_of(64 * kKiB));
+    pool.release(buffer_of(128 * kKiB));
+    pool.release(buffer_of(256 * kKiB));
+    EXPECT_EQ(pool.pooled_bytes(), 448 * kKiB);
+
+    pool.set_max_bytes(300 * kKiB);
+    EXPECT_EQ(pool.pooled_bytes(), 256 * kKiB);
+    EXPECT_EQ(pool.acquire().capacity(), 256 * kKiB);
+
+    pool.release(buffer_of(128 * kKiB));
+    pool.set_max_bytes(0);  // Disables pooling
+    EXPECT_EQ(pool.pooled_bytes(), 0U);
+    pool.release(buffer_of(128 * kKiB));
+    EXPECT_EQ(pool.pooled_bytes(), 0U);
+}
+
+TEST(BufferPoolTest, PooledMessageReturnsItsBufferWhenReleased) {
+    auto& pool = dist::common::buffer_pool();
+    pool.set_max_bytes(1024 * kKiB);
+    const std::size_t before = pool.pooled_bytes();
+    {
+        auto message = dist::common::make_pooled_message(buffer_of(128 * kKiB));
+        EXPECT_EQ(message.size(), 16U);
+        EXPECT_EQ(pool.pooled_bytes(), before);
+    }
+    EXPECT_EQ(pool.pooled_bytes(), before + 128 * kKiB);
+    pool.set_max_bytes(0);
+}
@@ -0,0 +1,64 @@
+#include "dist/common/fair_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using dist::common::FairQueue;
+
+namespace {
+
+// Everything left in the queue, as "stream:item" in service order.
+std::vector<std::string> drain(FairQueue<int>& queue) {
+    std::vector<std::string> served;
+    while (auto item = queue.pop()) {
+        served.push_back(item->first + ":" + std::to_string(item->second));
+    }
+    return served;
+}
+
+}  // namespace
+
+TEST(FairQueueTest, StreamsAreServedRoundRobin) {
+    FairQueue<int> queue{8};
+    queue.push("a", 1);
+    queue.push("a", 2);
+    queue.push("a", 3);
+    queue.push("b", 1);
+    queue.push("c", 1);
+    queue.push("b", 2);
+    EXPECT_EQ(queue.size(), 6U);
+    EXPECT_EQ(drain(queue), (std::vector<std::string>{"a:1", "b:1", "c:1", "a:2", "b:2", "a:3"}));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(FairQueueTest, FullStreamEvictsItsOwnOldestItem) {
+    FairQueue<int> queue{2};
+    EXPECT_FALSE(queue.push("a", 1).has_value());
+    EXPECT_FALSE(queue.push("a", 2).has_value());
+    EXPECT_FALSE(queue.push("b", 1).has_value());
+    EXPECT_EQ(queue.push("a", 3), 1);
+    EXPECT_EQ(queue.size(), 3U);
+    EXPECT_EQ(drain(queue), (std::vector<std::string>{"a:2", "b:1", "a:3"}));
+}
+
+TEST(FairQueueTest, DrainedStreamRejoinsAtTheBack) {
+    FairQueue<int> queue{4};
+    queue.push("a", 1);
+    queue.push("b", 1);
+    ASSERT_EQ(queue.pop()->first, "a");
+    queue.push("a", 2);  // "a" was empty, so it queues behind "b"
+    queue.push("c", 1);
+    EXPECT_EQ(drain(queue), (std::vector<std::string>{"b:1", "a:2", "c:1"}));
+}
+
+TEST(FairQueueTest, EmptyQueuePopsNothing) {
+    FairQueue<int> queue{0};  // Depth 0 is treated as 1
+    EXPECT_FALSE(queue.pop().has_value());
+    queue.push("a", 1);
+    EXPECT_EQ(queue.push("a", 2), 1);
+    EXPECT_EQ(drain(queue), (std::vector<std::string>{"a:2"}));
+    EXPECT_FALSE(queue.pop().has_value());
+}
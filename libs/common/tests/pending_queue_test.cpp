@@ -0,0 +1,315 @@
+#include "dist/common/pending_queue.hpp"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using dist::common::DropPolicy;
+using dist::common::PendingQueue;
+using dist::common::SpillStore;
+
+namespace {
+
+struct Frame {
+    int id = 0;
+    std::vector<zmq::message_t> parts;
+};
+
+// One part of `size` bytes, every byte set to `id` so a reload can be checked.
+Frame make_frame(int id, std::size_t size = 100) {
+    Frame frame;
+    frame.id = id;
+    zmq::message_t part(size);
+    std::memset(part.data(), id, size);
+    frame.parts.push_back(std::move(part));
+    return frame;
+}
+
+bool intact(const Frame& frame, std::size_t size = 100) {
+    if (frame.parts.size() != 1 || frame.parts[0].size() != size) {
+        return false;
+    }
+    const auto* bytes = static_cast<const std::uint8_t*>(frame.parts[0].data());
+    for (std::size_t i = 0; i < size; ++i) {
+        if (bytes[i] != static_cast<std::uint8_t>(frame.id)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<int> drain(PendingQueue<Frame>& queue) {
+    std::vector<int> ids;
+    while (auto* frame = queue.front()) {
+        ids.push_back(frame->id);
+        queue.pop_front();
+    }
+    return ids;
+}
+
+std::vector<fs::path> spill_files(const fs::path& dir) {
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        files.push_back(entry.path());
+    }
+    return files;
+}
+
+class SpillTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        dir_ = fs::temp_directory_path() /
+               ("dist_spill_" + std::string(info->name()) + "_" + std::to_string(::getpid()));
+        fs::remove_all(dir_);
+    }
+    void TearDown() override { fs::remove_all(dir_); }
+
+    fs::path dir_;
+};
+
+}  // namespace
+
+TEST(DropPolicyTest, ParsesAndFormats) {
+    EXPECT_EQ(dist::common::parse_drop_policy(""), DropPolicy::oldest);
+    EXPECT_EQ(dist::common::parse_drop_policy("oldest"), DropPolicy::oldest);
+    EXPECT_EQ(dist::common::parse_drop_policy("newest"), DropPolicy::newest);
+    EXPECT_EQ(dist::common::parse_drop_policy("priority"), DropPolicy::priority);
+    EXPECT_EQ(dist::common::parse_drop_policy("Oldest"), std::nullopt);
+    EXPECT_EQ(dist::common::to_string(DropPolicy::priority), "priority");
+    EXPECT_EQ(dist::common::to_string(DropPolicy::newest), "newest");
+    EXPECT_EQ(dist::common::to_string(DropPolicy::oldest), "oldest");
+}
+
+TEST(PendingQueueTest, OldestPolicyDropsTheOldestFrame) {
+    PendingQueue<Frame> queue{{3, 0, DropPolicy::oldest}};
+    for (int id = 0; id < 3; ++id) {
+        EXPECT_EQ(queue.push(make_frame(id), 100), 0U);
+    }
+    EXPECT_TRUE(queue.full());
+    EXPECT_EQ(queue.push(make_frame(3), 100), 1U);
+    EXPECT_EQ(drain(queue), (std::vector<int>{1, 2, 3}));
+}
+
+TEST(PendingQueueTest, NewestPolicyDropsTheArrivingFrame) {
+    PendingQueue<Frame> queue{{3, 0, DropPolicy::newest}};
+    for (int id = 0; id < 3; ++id) {
+        queue.push(make_frame(id), 100);
+    }
+    EXPECT_EQ(queue.push(make_frame(3), 100), 1U);
+    EXPECT_EQ(queue.size(), 3U);
+    EXPECT_EQ(queue.memory_bytes(), 300U);
+    EXPECT_EQ(drain(queue), (std::vector<int>{0, 1, 2}));
+}
+
+TEST(PendingQueueTest, PriorityPolicyDropsTheLowestPriorityOldestFirst) {
+    PendingQueue<Frame> queue{{3, 0, DropPolicy::priority}};
+    queue.push(make_frame(0), 100, 1);
+    queue.push(make_frame(1), 100, 0);
+    queue.push(make_frame(2), 100, 0);
+    EXPECT_EQ(queue.push(make_frame(3), 100, 1), 1U);  // Frame 1 gives way
+    EXPECT_EQ(queue.push(make_frame(4), 100, 0), 1U);  // Then frame 2, its equal
+    EXPECT_EQ(drain(queue), (std::vector<int>{0, 3, 4}));
+}
+
+TEST(PendingQueueTest, PriorityPolicyDropsAnArrivingFrameRankedBelowTheQueue) {
+    PendingQueue<Frame> queue{{2, 0, DropPolicy::priority}};
+    queue.push(make_frame(0), 100, 1);
+    queue.push(make_frame(1), 100, 1);
+    EXPECT_EQ(queue.push(make_frame(2), 100, 0), 1U);
+    EXPECT_EQ(drain(queue), (std::vector<int>{0, 1}));
+}
+
+TEST(PendingQueueTest, ByteBudgetEvictsUntilTheFrameFits) {
+    PendingQueue<Frame> queue{{10, 250, DropPolicy::oldest}};
+    EXPECT_EQ(queue.push(make_frame(0), 100), 0U);
+    EXPECT_EQ(queue.push(make_frame(1), 100), 0U);
+    EXPECT_EQ(queue.memory_bytes(), 200U);
+    EXPECT_EQ(queue.push(make_frame(2, 200), 200), 2U);
+    EXPECT_EQ(queue.size(), 1U);
+    EXPECT_EQ(queue.memory_bytes(), 200U);
+    EXPECT_FALSE(queue.full());
+    EXPECT_EQ(queue.push(make_frame(3, 50), 50), 0U);
+    EXPECT_TRUE(queue.full());  // At the byte budget with no spill store
+}
+
+TEST(PendingQueueTest, PopReleasesTheFrameBytes) {
+    PendingQueue<Frame> queue{{10, 1000, DropPolicy::oldest}};
+    queue.push(make_frame(0), 100);
+    queue.push(make_frame(1, 300), 300);
+    queue.pop_front();
+    EXPECT_EQ(queue.memory_bytes(), 300U);
+    queue.pop_front();
+    EXPECT_EQ(queue.memory_bytes(), 0U);
+    EXPECT_TRUE(queue.empty());
+    queue.pop_front();  // No-op when empty
+    EXPECT_EQ(queue.front(), nullptr);
+}
+
+TEST(PendingQueueTest, OversizedFrameQueuesBehindAnEmptyMemory) {
+    PendingQueue<Frame> queue{{10, 50, DropPolicy::oldest}};
+    EXPECT_EQ(queue.push(make_frame(0), 100), 0U);
+    EXPECT_EQ(queue.memory_bytes(), 100U);
+    EXPECT_EQ(queue.push(make_frame(1), 100), 1U);
+    EXPECT_EQ(drain(queue), (std::vector<int>{1}));
+}
+
+TEST(PendingQueueTest, BorrowedFramesOnlyCountAgainstTheFrameLimit) {
+    PendingQueue<Frame> queue{{3, 100, DropPolicy::oldest}};
+    for (int id = 0; id < 3; ++id) {
+        EXPECT_EQ(queue.push(make_frame(id), 0), 0U);
+    }
+    EXPECT_EQ(queue.memory_bytes(), 0U);
+    EXPECT_EQ(queue.push(make_frame(3), 0), 1U);
+    EXPECT_EQ(drain(queue), (std::vector<int>{1, 2, 3}));
+}
+
+TEST_F(SpillTest, OverflowIsSpilledAndReloadedInOrder) {
+    SpillStore spill{dir_, 1000};
+    PendingQueue<Frame> queue{{10, 150, DropPolicy::oldest}, &spill};
+    for (int id = 0; id < 4; ++id) {
+        EXPECT_EQ(queue.push(make_frame(id), 100), 0U);
+    }
+    EXPECT_EQ(queue.size(), 4U);
+    EXPECT_EQ(queue.memory_bytes(), 100U);
+    EXPECT_EQ(spill.bytes(), 300U);
+    EXPECT_EQ(spill_files(dir_).size(), 3U);
+
+    for (int id = 0; id < 4; ++id) {
+        auto* frame = queue.front();
+        ASSERT_NE(frame, nullptr);
+        EXPECT_EQ(frame->id, id);
+        EXPECT_TRUE(intact(*frame));
+        queue.pop_front();
+    }
+    EXPECT_EQ(queue.front(), nullptr);
+    EXPECT_EQ(queue.memory_bytes(), 0U);
+    EXPECT_EQ(queue.lost(), 0U);
+    EXPECT_EQ(spill.bytes(), 0U);
+    EXPECT_TRUE(spill_files(dir_).empty());
+}
+
+TEST_F(SpillTest, FullSpillStoreFallsBackToTheDropPolicy) {
+    SpillStore spill{dir_, 150};
+    PendingQueue<Frame> queue{{10, 100, DropPolicy::oldest}, &spill};
+    queue.push(make_frame(0), 100);
+    queue.push(make_frame(1), 100);  // Spilled
+    EXPECT_EQ(queue.push(make_frame(2), 100), 1U);  // No spill room: frame 0 gives way
+    EXPECT_EQ(spill.bytes(), 100U);
+    EXPECT_EQ(drain(queue), (std::vector<int>{1, 2}));
+    EXPECT_EQ(spill.bytes(), 0U);
+}
+
+TEST_F(SpillTest, EvictingASpilledFrameRemovesItsFile) {
+    SpillStore spill{dir_, 1000};
+    PendingQueue<Frame> queue{{3, 100, DropPolicy::priority}, &spill};
+    queue.push(make_frame(0), 100, 1);
+    queue.push(make_frame(1), 100, 0);  // Spilled
+    queue.push(make_frame(2), 100, 1);  // Spilled
+    ASSERT_EQ(spill_files(dir_).size(), 2U);
+    EXPECT_EQ(queue.push(make_frame(3), 100, 1), 1U);  // Frame count: frame 1 gives way
+    EXPECT_EQ(spill_files(dir_).size(), 2U);  // Frame 2's file and frame 3's
+    EXPECT_EQ(spill.bytes(), 200U);
+    EXPECT_EQ(drain(queue), (std::vector<int>{0, 2, 3}));
+}
+
+TEST_F(SpillTest, TruncatedSpillFileIsSkippedAndCountedLost) {
+    SpillStore spill{dir_, 1000};
+    PendingQueue<Frame> queue{{10, 100, DropPolicy::oldest}, &spill};
+    queue.push(make_frame(0), 100);
+    queue.push(make_frame(1), 100);  // Spilled
+    queue.push(make_frame(2), 100);  // Spilled
+    auto files = spill_files(dir_);
+    ASSERT_EQ(files.size(), 2U);
+    std::sort(files.begin(), files.end());
+    fs::resize_file(files[0], 20);  // Frame 1: header intact, payload cut short
+
+    EXPECT_EQ(drain(queue), (std::vector<int>{0, 2}));
+    EXPECT_EQ(queue.lost(), 1U);
+    EXPECT_EQ(spill.bytes(), 0U);
+    EXPECT_TRUE(spill_files(dir_).empty());
+}
+
+TEST_F(SpillTest, ImplausiblePartCountIsRejected) {
+    SpillStore spill{dir_, 1000};
+    const auto id = spill.write(make_frame(7).parts);
+    ASSERT_TRUE(id.has_value());
+    const auto files = spill_files(dir_);
+    ASSERT_EQ(files.size(), 1U);
+    {
+        std::fstream file(files[0], std::ios::binary | std::ios::in | std::ios::out);
+        const std::uint32_t count = 100000;
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    }
+    EXPECT_FALSE(spill.read(*id).has_value());
+    EXPECT_EQ(spill.bytes(), 0U);
+    EXPECT_TRUE(spill_files(dir_).empty());
+}
+
+TEST_F(SpillTest, CorruptPartSizeIsRejected) {
+    SpillStore spill{dir_, 1000};
+    const auto id = spill.write(make_frame(7).parts);
+    ASSERT_TRUE(id.has_value());
+    const auto files = spill_files(dir_);
+    ASSERT_EQ(files.size(), 1U);
+    {
+        std::fstream file(files[0], std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(sizeof(std::uint32_t));
+        const std::uint64_t size = std::uint64_t{1} << 62;
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    }
+    EXPECT_FALSE(spill.read(*id).has_value());
+    EXPECT_EQ(spill.bytes(), 0U);
+    EXPECT_TRUE(spill_files(dir_).empty());
+}
+
+TEST_F(SpillTest, MultiPartFramesRoundTrip) {
+    SpillStore spill{dir_, 1000};
+    std::vector<zmq::message_t> parts;
+    parts.emplace_back(std::string_view("header"));
+    parts.emplace_back();  // Empty part
+    parts.push_back(std::move(make_frame(9, 300).parts[0]));
+    const auto id = spill.write(parts);
+    ASSERT_TRUE(id.has_value());
+    EXPECT_EQ(spill.bytes(), 306U);
+
+    auto loaded = spill.read(*id);
+    ASSERT_TRUE(loaded.has_value());
+    ASSERT_EQ(loaded->size(), 3U);
+    EXPECT_EQ((*loaded)[0].to_string(), "header");
+    EXPECT_EQ((*loaded)[1].size(), 0U);
+    ASSERT_EQ((*loaded)[2].size(), 300U);
+    EXPECT_EQ(std::memcmp((*loaded)[2].data(), parts[2].data(), 300), 0);
+    EXPECT_FALSE(spill.read(*id).has_value());  // Read removes the frame
+}
+
+TEST_F(SpillTest, WriteBeyondTheBudgetIsRefused) {
+    SpillStore spill{dir_, 150};
+    EXPECT_TRUE(spill.write(make_frame(0).parts).has_value());
+    EXPECT_FALSE(spill.write(make_frame(1).parts).has_value());
+    EXPECT_EQ(spill.bytes(), 100U);
+    EXPECT_EQ(spill_files(dir_).size(), 1U);
+}
+
+TEST_F(SpillTest, LeftoversAreRemovedAndOutstandingFilesCleanedUp) {
+    fs::create_directories(dir_);
+    std::ofstream(dir_ / "spill_00000042.bin") << "stale";
+    std::ofstream(dir_ / "notes.txt") << "kept";
+    {
+        SpillStore spill{dir_, 1000};
+        EXPECT_FALSE(fs::exists(dir_ / "spill_00000042.bin"));
+        EXPECT_TRUE(fs::exists(dir_ / "notes.txt"));
+        ASSERT_TRUE(spill.write(make_frame(0).parts).has_value());
+        EXPECT_EQ(spill_files(dir_).size(), 2U);
+    }
+    EXPECT_EQ(spill_files(dir_), std::vector<fs::path>{dir_ / "notes.txt"});
+}
@@ -0,0 +1,223 @@
+#include "dist/common/shm_transport.hpp"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using dist::common::ShmReader;
+using dist::common::ShmWriter;
+
+namespace {
+
+constexpr std::size_t kRingBytes = 1024 * 1024;  // The smallest ring a writer creates
+constexpr std::size_t kPartBytes = 200 * 1024;   // Five fit in the ring, the sixth wraps
+constexpr std::size_t kDescriptorBytes = 80;
+
+zmq::message_t filled(std::size_t size, int value) {
+    zmq::message_t part(size);
+    std::memset(part.data(), value, size);
+    return part;
+}
+
+bool filled_with(const zmq::message_t& part, std::size_t size, int value) {
+    if (part.size() != size) {
+        return false;
+    }
+    const auto* bytes = static_cast<const std::uint8_t*>(part.data());
+    for (std::size_t i = 0; i < size; ++i) {
+        if (bytes[i] != static_cast<std::uint8_t>(value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Writer and reader ends of one endpoint, joined by an inproc PAIR like a stage link.
+class ShmTransportTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        name_ = std::string("test-") + std::to_string(::getpid()) + "-" +
+                std::to_string(info->line());
+        writer_.emplace("shm://" + name_, kRingBytes);
+        const std::string link = "inproc://" + name_;
+        sender_.bind(link);
+        receiver_.connect(link);
+    }
+
+    // Send one single-part frame of `size` bytes filled with `value`; returns the size
+    // that went over the socket (the descriptor's when the part went through the ring).
+    zmq::message_t send(std::size_t size, int value) {
+        std::vector<zmq::message_t> parts;
+        parts.push_back(filled(size, value));
+        EXPECT_TRUE(writer_->send(sender_, parts));
+        EXPECT_TRUE(filled_with(parts[0], size, value));  // Left intact for a retry
+        zmq::message_t wire;
+        EXPECT_TRUE(receiver_.recv(wire));
+        return wire;
+    }
+
+    std::string name_;
+    std::optional<ShmWriter> writer_;
+    zmq::context_t context_{1};
+    zmq::socket_t sender_{context_, zmq::socket_type::pair};
+    zmq::socket_t receiver_{context_, zmq::socket_type::pair};
+    ShmReader reader_;
+};
+
+}  // namespace
+
+TEST(ShmEndpointTest, ParsesNamesAndMapsToTheIpcChannel) {
+    EXPECT_TRUE(dist::common::is_shm_endpoint("shm://frames"));
+    EXPECT_TRUE(dist::common::is_shm_endpoint("shm://Frames_2-b"));
+    EXPECT_FALSE(dist::common::is_shm_endpoint("shm://"));
+    EXPECT_FALSE(dist::common::is_shm_endpoint("shm://two words"));
+    EXPECT_FALSE(dist::common::is_shm_endpoint("shm://../frames"));
+    EXPECT_FALSE(dist::common::is_shm_endpoint("shm://" + std::string(33, 'a')));
+    EXPECT_FALSE(dist::common::is_shm_endpoint("tcp://127.0.0.1:5555"));
+    EXPECT_EQ(dist::common::zmq_endpoint("shm://frames"), "ipc:///tmp/dist-shm-frames.ipc");
+    EXPECT_EQ(dist::common::zmq_endpoint("tcp://*:5555"), "tcp://*:5555");
+    EXPECT_EQ(dist::common::zmq_endpoint("shm://bad name"), "shm://bad name");
+    EXPECT_THROW(ShmWriter("tcp://*:5555", kRingBytes), std::runtime_error);
+}
+
+TEST_F(ShmTransportTest, LargePartsGoThroughTheRingAndSmallOnesInline) {
+    std::vector<zmq::message_t> parts;
+    parts.emplace_back(std::string_view("header"));
+    parts.push_back(filled(kPartBytes, 7));
+    ASSERT_TRUE(writer_->send(sender_, parts));
+
+    zmq::message_t header;
+    zmq::message_t payload;
+    ASSERT_TRUE(receiver_.recv(header));
+    ASSERT_TRUE(header.more());
+    ASSERT_TRUE(receiver_.recv(payload));
+    EXPECT_FALSE(payload.more());
+    EXPECT_EQ(payload.size(), kDescriptorBytes);
+
+    const auto resolved_header = reader_.resolve(std::move(header));
+    ASSERT_TRUE(resolved_header.has_value());
+    EXPECT_EQ(resolved_header->to_string(), "header");
+    const auto resolved = reader_.resolve(std::move(payload));
+    ASSERT_TRUE(resolved.has_value());
+    EXPECT_TRUE(filled_with(*resolved, kPartBytes, 7));
+}
+
+TEST_F(ShmTransportTest, UnrelatedDescriptorSizedPartsPassThrough) {
+    const auto resolved = reader_.resolve(filled(kDescriptorBytes, 1));
+    ASSERT_TRUE(resolved.has_value());
+    EXPECT_TRUE(filled_with(*resolved, kDescriptorBytes, 1));
+}
+
+TEST_F(ShmTransportTest, ReleasedSpaceIsReusedAcrossWraps) {
+    for (int i = 0; i < 20; ++i) {
+        auto wire = send(kPartBytes, i);
+        ASSERT_EQ(wire.size(), kDescriptorBytes) << "frame " << i << " was sent inline";
+        const auto resolved = reader_.resolve(std::move(wire));
+        ASSERT_TRUE(resolved.has_value()) << "frame " << i;
+        EXPECT_TRUE(filled_with(*resolved, kPartBytes, i));
+    }
+}
+
+TEST_F(ShmTransportTest, HeldBlockForcesInlineUntilReleased) {
+    auto held = reader_.resolve(send(kPartBytes, 1));
+    ASSERT_TRUE(held.has_value());
+    for (int i = 2; i <= 5; ++i) {
+        ASSERT_TRUE(reader_.resolve(send(kPartBytes, i)).has_value());
+    }
+
+    // The next block wraps onto the one still mapped: it goes inline, untouched.
+    auto inline_part = send(kPartBytes, 6);
+    EXPECT_TRUE(filled_with(inline_part, kPartBytes, 6));
+    const auto passed = reader_.resolve(std::move(inline_part));
+    ASSERT_TRUE(passed.has_value());
+    EXPECT_TRUE(filled_with(*passed, kPartBytes, 6));
+    EXPECT_TRUE(filled_with(*held, kPartBytes, 1));
+
+    held.reset();
+    auto wire = send(kPartBytes, 7);
+    ASSERT_EQ(wire.size(), kDescriptorBytes);
+    const auto resolved = reader_.resolve(std::move(wire));
+    ASSERT_TRUE(resolved.has_value());
+    EXPECT_TRUE(filled_with(*resolved, kPartBytes, 7));
+}
+
+TEST_F(ShmTransportTest, DescriptorReadAfterItsSpaceWasReusedIsLost) {
+    auto stale = send(kPartBytes, 1);
+    ASSERT_EQ(stale.size(), kDescriptorBytes);
+    for (int i = 2; i <= 6; ++i) {
+        ASSERT_EQ(send(kPartBytes, i).size(), kDescriptorBytes);  // Never resolved
+    }
+    EXPECT_FALSE(reader_.resolve(std::move(stale)).has_value());
+}
+
+TEST_F(ShmTransportTest, ReadersBeyondTheSlotCountCopy) {
+    std::vector<std::unique_ptr<ShmReader>> readers;
+    std::vector<zmq::message_t> holds;
+    auto wire = send(kPartBytes, 3);
+    const std::string descriptor = wire.to_string();
+    for (int i = 0; i < 32; ++i) {  // Every reader slot, each pinning the block
+        readers.push_back(std::make_unique<ShmReader>());
+        auto resolved =
+            readers.back()->resolve(zmq::message_t(descriptor.data(), descriptor.size()));
+        ASSERT_TRUE(resolved.has_value());
+        holds.push_back(std::move(*resolved));
+    }
+    const auto copied = reader_.resolve(std::move(wire));
+    ASSERT_TRUE(copied.has_value());
+    EXPECT_TRUE(filled_with(*copied, kPartBytes, 3));
+    EXPECT_NE(copied->data(), holds.front().data());
+}
+
+TEST_F(ShmTransportTest, ReaderThatExitedWhileHoldingIsReleased) {
+    auto wire = send(kPartBytes, 1);
+    const std::string descriptor = wire.to_string();
+    const pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        // Map and hold the block, then exit without releasing it.
+        ShmReader reader;
+        auto held = reader.resolve(zmq::message_t(descriptor.data(), descriptor.size()));
+        ::_exit(held.has_value() && filled_with(*held, kPartBytes, 1) ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+
+    for (int i = 2; i <= 8; ++i) {
+        auto part = send(kPartBytes, i);
+        ASSERT_EQ(part.size(), kDescriptorBytes) << "frame " << i << " was sent inline";
+        ASSERT_TRUE(reader_.resolve(std::move(part)).has_value());
+    }
+}
+
+TEST(ShmWriterTest, RemovesSegmentsOfSendersThatDied) {
+    const pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        ::_exit(0);
+    }
+    ASSERT_EQ(::waitpid(child, nullptr, 0), child);
+
+    const std::string name = "stale-" + std::to_string(::getpid());
+    const std::string stale = "/dist-" + name + "-" + std::to_string(child);
+    const int fd = ::shm_open(stale.c_str(), O_RDWR | O_CREAT, 0600);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+
+    const ShmWriter writer{"shm://" + name, kRingBytes};
+    EXPECT_FALSE(std::filesystem::exists("/dev/shm" + stale));
+    EXPECT_TRUE(std::filesystem::exists("/dev/shm" + writer.segment()));
+}
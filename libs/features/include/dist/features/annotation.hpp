@@ -0,0 +1,44 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace dist::features {
+
+// Where keypoint overlays are drawn: inline in the extractor, or deferred to the
+// logger so visualization stays off the detection path.
+enum class AnnotationStage { extractor, logger };
+
+// Parse "extractor" / "logger" (nullopt for anything else).
+[[nodiscard]] std::optional<AnnotationStage> parse_annotation_stage(std::string_view value);
+[[nodiscard]] std::string_view to_string(AnnotationStage stage);
+
+// Picks the frames that get an overlay: every `every_n`-th frame id while sampling
+// is enabled, plus any frame whose source header sets "annotate": true.
+class AnnotationSampler {
+  public:
+    AnnotationSampler() = default;
+    AnnotationSampler(bool enabled, int every_n);
+
+    [[nodiscard]] bool should_annotate(const nlohmann::json& source_header) const;
+    [[nodiscard]] bool sampling() const { return enabled_ && every_n_ > 0; }
+
+  private:
+    bool enabled_ = false;
+    int every_n_ = 1;
+};
+
+// Draw rich keypoints over `image` and PNG-encode the result (empty on failure).
+[[nodiscard]] std::vector<std::uint8_t> render_annotation(const cv::Mat& image,
+                                                          const std::vector<cv::KeyPoint>& keypoints);
+// Same, encoding into `encoded` so a recycled buffer's capacity is reused.
+bool render_annotation(const cv::Mat& image,
+                       const std::vector<cv::KeyPoint>& keypoints,
+                       std::vector<std::uint8_t>& encoded);
+
+}  // namespace dist::features
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+#include "dist/common/compression.hpp"
+
+namespace dist::features {
+
+// Element type descriptors are shipped and stored as. SIFT values are already
+// scaled to [0, 255], so u8 only drops the fraction; f16 keeps ~3 significant digits.
+enum class DescriptorFormat { f32, f16, u8 };
+
+// Parse "f32" / "f16" / "u8" (nullopt for anything else).
+[[nodiscard]] std::optional<DescriptorFormat> parse_descriptor_format(std::string_view value);
+[[nodiscard]] std::string_view to_string(DescriptorFormat format);
+
+// Convert floating-point detector output to `format`; integer descriptors (e.g. binary
+// ORB bits) are returned unchanged since narrowing them would be meaningless.
+[[nodiscard]] cv::Mat convert_descriptors(const cv::Mat& descriptors, DescriptorFormat format);
+
+// Reverse of the extractor's encoding for consumers: decompress a stored blob and
+// return it as a rows x cols matrix of `cv_type` (empty on mismatch).
+[[nodiscard]] cv::Mat decode_descriptors(const void* data,
+                                         std::size_t size,
+                                         int rows,
+                                         int cols,
+                                         int cv_type,
+                                         dist::common::Compression compression);
+
+}  // namespace dist::features
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "dist/common/config.hpp"
+
+namespace dist::features {
+
+// Keypoint detector + descriptor extractor implementations selectable from .env.
+// SIFT gives float descriptors; ORB, AKAZE and CUDA ORB give binary (CV_8U) ones.
+enum class DetectorBackend { sift, orb, akaze, cuda_orb };
+
+// Parse "sift" / "orb" / "akaze" / "cuda_orb" ("cuda" is an alias); nullopt otherwise.
+[[nodiscard]] std::optional<DetectorBackend> parse_detector_backend(std::string_view value);
+[[nodiscard]] std::string_view to_string(DetectorBackend backend);
+
+// False when the backend is not compiled in or, for CUDA, no device is present.
+[[nodiscard]] bool detector_available(DetectorBackend backend);
+
+// One detector instance per thread; implementations are not shared across workers.
+class FeatureDetector {
+  public:
+    virtual ~FeatureDetector() = default;
+
+    virtual void detect_and_compute(const cv::Mat& image,
+                                    const cv::Mat& mask,
+                                    std::vector<cv::KeyPoint>& keypoints,
+                                    cv::Mat& descriptors) = 0;
+
+    [[nodiscard]] virtual DetectorBackend backend() const = 0;
+};
+
+// Build `backend` configured from the extractor's .env parameters. Callers check
+// detector_available() first; an unavailable backend falls back to SIFT.
+[[nodiscard]] std::unique_ptr<FeatureDetector> make_detector(
+    DetectorBackend backend,
+    const dist::common::FeatureExtractorConfig& config);
+
+}  // namespace dist::features
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <opencv2/core.hpp>
+#include <zmq.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace dist::features {
+
+// The generator header fields needed to interpret a payload.
+struct FrameLayout {
+    std::string encoding = "png";
+    int width = 0;
+    int height = 0;
+    int cv_type = -1;  // Raw payloads only
+    std::size_t step = 0;
+    std::string compression = "none";
+};
+
+[[nodiscard]] FrameLayout layout_from_header(const nlohmann::json& source_header);
+
+// Turn a generator payload back into pixels using its header. Encoded images go
+// through cv::imdecode; uncompressed raw buffers alias `payload` (no copy), so the
+// message must outlive the returned matrix. Empty on malformed input.
+[[nodiscard]] cv::Mat decode_frame(const FrameLayout& layout, zmq::message_t& payload);
+[[nodiscard]] cv::Mat decode_frame(const nlohmann::json& source_header, zmq::message_t& payload);
+
+}  // namespace dist::features
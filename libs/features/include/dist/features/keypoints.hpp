@@ -0,0 +1,22 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <opencv2/core.hpp>
+
+#include <cstddef>
+#include <vector>
+
+#include "dist/common/wire_format.hpp"
+
+namespace dist::features {
+
+// Debug format: the header's "keypoints" array of objects.
+[[nodiscard]] nlohmann::json keypoints_to_json(const std::vector<cv::KeyPoint>& keypoints);
+[[nodiscard]] std::vector<cv::KeyPoint> keypoints_from_json(const nlohmann::json& keypoints);
+
+// Binary format: write keypoints.size() PackedKeypoint records into `out` (any alignment).
+void pack_keypoints(const std::vector<cv::KeyPoint>& keypoints, void* out);
+// Rebuild keypoints from a packed buffer of `size` bytes (any alignment).
+[[nodiscard]] std::vector<cv::KeyPoint> unpack_keypoints(const void* data, std::size_t size);
+
+}  // namespace dist::features
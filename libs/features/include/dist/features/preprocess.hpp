@@ -0,0 +1,54 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "dist/common/config.hpp"
+
+namespace dist::features {
+
+// How FEATURE_EXTRACTOR_ROI restricts detection: "crop" detects on the sub-image,
+// "mask" keeps the full frame and passes a mask to the detector.
+enum class RoiMode { crop, mask };
+
+[[nodiscard]] std::optional<RoiMode> parse_roi_mode(std::string_view value);
+
+// Parse "x,y,w,h" (nullopt when empty or malformed).
+[[nodiscard]] std::optional<cv::Rect> parse_roi(std::string_view value);
+
+// The detector's view of a frame plus what is needed to map results back.
+struct PreparedFrame {
+    cv::Mat image;  // Cropped / grayscale / downscaled; may alias the decoded frame
+    cv::Mat mask;   // Empty = whole image
+    double scale = 1.0;     // Working pixels per source pixel
+    cv::Point2f offset{};   // Source position of the working image's origin
+};
+
+// Shrinks the detector's input before detectAndCompute: crop or mask a region of
+// interest, convert to grayscale once, and downscale so the longer side fits
+// max_dimension. Detector cost scales with pixel count, so a 4K frame capped at
+// 1920 does about a quarter of the work. One instance per worker (caches masks).
+class Preprocessor {
+  public:
+    explicit Preprocessor(const dist::common::FeatureExtractorConfig& config);
+
+    [[nodiscard]] PreparedFrame prepare(const cv::Mat& image);
+
+    // Map keypoints found on `prepared.image` back to source-frame coordinates.
+    static void restore_keypoints(const PreparedFrame& prepared, std::vector<cv::KeyPoint>& keypoints);
+
+  private:
+    [[nodiscard]] cv::Mat source_mask(const cv::Size& frame_size);
+
+    int max_dimension_ = 0;
+    bool grayscale_ = true;
+    std::optional<cv::Rect> roi_;
+    RoiMode roi_mode_ = RoiMode::crop;
+    cv::Mat mask_image_;   // FEATURE_EXTRACTOR_MASK_PATH as loaded
+    cv::Mat cached_mask_;  // Full-frame mask for the last frame size
+};
+
+}  // namespace dist::features
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+
+namespace dist::features {
+
+// Deterministic BGR test frame (gradient background plus random shapes) with enough
+// corners and blobs for every detector backend; the same seed yields the same pixels.
+// Used by the --bench load mode and the microbenchmarks instead of files on disk.
+[[nodiscard]] cv::Mat synthetic_frame(int width, int height, std::uint64_t seed);
+
+}  // namespace dist::features
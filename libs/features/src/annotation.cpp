@@ -0,0 +1,71 @@
+#include "dist/features/annotation.hpp"
+
+#include <opencv2/features2d.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+namespace dist::features {
+
+std::optional<AnnotationStage> parse_annotation_stage(std::string_view value) {
+    if (value.empty() || value == "extractor") {
+        return AnnotationStage::extractor;
+    }
+    if (value == "logger") {
+        return AnnotationStage::logger;
+    }
+    return std::nullopt;
+}
+
+std::string_view to_string(AnnotationStage stage) {
+    switch (stage) {
+        case AnnotationStage::logger:
+            return "logger";
+        case AnnotationStage::extractor:
+            break;
+    }
+    return "extractor";
+}
+
+AnnotationSampler::AnnotationSampler(bool enabled, int every_n)
+    : enabled_(enabled), every_n_(every_n) {}
+
+bool AnnotationSampler::should_annotate(const nlohmann::json& source_header) const {
+    if (source_header.value("annotate", false)) {
+        return true;
+    }
+    if (!sampling()) {
+        return false;
+    }
+    // Keyed on frame id rather than a local counter so every worker and every
+    // extractor instance picks the same frames.
+    const auto frame_id = source_header.value<long long>("frame_id", 0);
+    return frame_id % every_n_ == 0;
+}
+
+std::vector<std::uint8_t> render_annotation(const cv::Mat& image,
+                                            const std::vector<cv::KeyPoint>& keypoints) {
+    std::vector<std::uint8_t> encoded;
+    render_annotation(image, keypoints, encoded);
+    return encoded;
+}
+
+bool render_annotation(const cv::Mat& image,
+                       const std::vector<cv::KeyPoint>& keypoints,
+                       std::vector<std::uint8_t>& encoded) {
+    encoded.clear();
+    if (image.empty()) {
+        return false;
+    }
+    cv::Mat annotated;
+    cv::drawKeypoints(image,
+                      keypoints,
+                      annotated,
+                      cv::Scalar(0, 255, 0),
+                      cv::DrawMatchesFlags::DRAW_RICH_KEYPOINTS);
+    if (annotated.empty() || !cv::imencode(".png", annotated, encoded)) {
+        encoded.clear();
+        return false;
+    }
+    return true;
+}
+
+}  // namespace dist::features
@@ -0,0 +1,63 @@
+#include "dist/features/descriptors.hpp"
+
+#include <cstdint>
+
+namespace dist::features {
+
+std::optional<DescriptorFormat> parse_descriptor_format(std::string_view value) {
+    if (value == "f32" || value == "float32") {
+        return DescriptorFormat::f32;
+    }
+    if (value == "f16" || value == "float16") {
+        return DescriptorFormat::f16;
+    }
+    if (value == "u8" || value == "uint8") {
+        return DescriptorFormat::u8;
+    }
+    return std::nullopt;
+}
+
+std::string_view to_string(DescriptorFormat format) {
+    switch (format) {
+        case DescriptorFormat::f16:
+            return "f16";
+        case DescriptorFormat::u8:
+            return "u8";
+        case DescriptorFormat::f32:
+            break;
+    }
+    return "f32";
+}
+
+cv::Mat convert_descriptors(const cv::Mat& descriptors, DescriptorFormat format) {
+    if (descriptors.empty() || descriptors.depth() != CV_32F || format == DescriptorFormat::f32) {
+        return descriptors;
+    }
+    cv::Mat converted;
+    // convertTo rounds and saturates, so out-of-range values clamp instead of wrapping.
+    descriptors.convertTo(converted, format == DescriptorFormat::f16 ? CV_16F : CV_8U);
+    return converted;
+}
+
+cv::Mat decode_descriptors(const void* data,
+                           std::size_t size,
+                           int rows,
+                           int cols,
+                           int cv_type,
+                           dist::common::Compression compression) {
+    if (rows <= 0 || cols <= 0 || cv_type < 0) {
+        return {};
+    }
+    cv::Mat descriptors(rows, cols, cv_type);
+    const std::size_t expected = descriptors.total() * descriptors.elemSize();
+    if (!dist::common::decompress(compression,
+                                  static_cast<const std::uint8_t*>(data),
+                                  size,
+                                  descriptors.data,
+                                  expected)) {
+        return {};
+    }
+    return descriptors;
+}
+
+}  // namespace dist::features
@@ -0,0 +1,324 @@
+#include "dist/features/detector.hpp"
+
+#include <opencv2/features2d.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <utility>
+
+#if defined(DIST_HAVE_CUDA_FEATURES)
+#include <opencv2/core/cuda.hpp>
+#include <opencv2/cudafeatures2d.hpp>
+#endif
+
+namespace dist::features {
+
+namespace {
+
+// Any cv::Feature2D with a CPU detectAndCompute (SIFT, ORB, AKAZE).
+class Feature2DDetector final : public FeatureDetector {
+  public:
+    Feature2DDetector(cv::Ptr<cv::Feature2D> impl, DetectorBackend backend)
+        : impl_(std::move(impl)), backend_(backend) {}
+
+    void detect_and_compute(const cv::Mat& image,
+                            const cv::Mat& mask,
+                            std::vector<cv::KeyPoint>& keypoints,
+                            cv::Mat& descriptors) override {
+        // An empty mask means "whole image" to OpenCV.
+        impl_->detectAndCompute(image, mask, keypoints, descriptors);
+    }
+
+    [[nodiscard]] DetectorBackend backend() const override { return backend_; }
+
+  private:
+    cv::Ptr<cv::Feature2D> impl_;
+    DetectorBackend backend_;
+};
+
+#if defined(DIST_HAVE_CUDA_FEATURES)
+// cv::cuda::ORB on an 8-bit grayscale upload; descriptors are downloaded per frame.
+class CudaOrbDetector final : public FeatureDetector {
+  public:
+    explicit CudaOrbDetector(int n_features) : impl_(cv::cuda::ORB::create(n_features)) {}
+
+    void detect_and_compute(const cv::Mat& image,
+                            const cv::Mat& mask,
+                            std::vector<cv::KeyPoint>& keypoints,
+                            cv::Mat& descriptors) override {
+        cv::Mat gray = image;
+        if (image.channels() == 3) {
+            cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+        } else if (image.channels() == 4) {
+            cv::cvtColor(image, gray, cv::COLOR_BGRA2GRAY);
+        }
+        if (gray.depth() != CV_8U) {
+            gray.convertTo(gray, CV_8U);
+        }
+        gpu_image_.upload(gray);
+        if (mask.empty()) {
+            gpu_mask_.release();
+        } else {
+            gpu_mask_.upload(mask);
+        }
+        impl_->detectAndCompute(gpu_image_, gpu_mask_, keypoints, gpu_descriptors_);
+        gpu_descriptors_.download(descriptors);
+    }
+
+    [[nodiscard]] DetectorBackend backend() const override { return DetectorBackend::cuda_orb; }
+
+  private:
+    cv::Ptr<cv::cuda::ORB> impl_;
+    // Reused across frames so device buffers are allocated once.
+    cv::cuda::GpuMat gpu_image_;
+    cv::cuda::GpuMat gpu_mask_;
+    cv::cuda::GpuMat gpu_descriptors_;
+};
+#endif
+
+// Splits large images into a grid of tiles detected in parallel. Each tile is read with
+// `overlap` pixels of context around its core cell and keeps only keypoints inside the
+// core, so features near a seam are found once and see the same neighbourhood as in a
+// whole-image pass. Results are merged in tile order, which keeps output deterministic.
+class TiledDetector final : public FeatureDetector {
+  public:
+    using Factory = std::function<std::unique_ptr<FeatureDetector>()>;
+
+    TiledDetector(Factory factory, int tile_size, int overlap, int max_features)
+        : factory_(std::move(factory)),
+          tile_size_(tile_size),
+          overlap_(std::max(overlap, 0)),
+          max_features_(max_features),
+          whole_(factory_()) {}
+
+    void detect_and_compute(const cv::Mat& image,
+                            const cv::Mat& mask,
+                            std::vector<cv::KeyPoint>& keypoints,
+                            cv::Mat& descriptors) override {
+        if (image.cols <= tile_size_ && image.rows <= tile_size_) {
+            whole_->detect_and_compute(image, mask, keypoints, descriptors);
+            return;
+        }
+
+        const int tiles_x = (image.cols + tile_size_ - 1) / tile_size_;
+        const int tiles_y = (image.rows + tile_size_ - 1) / tile_size_;
+        const auto tile_count =
+            static_cast<std::size_t>(tiles_x) * static_cast<std::size_t>(tiles_y);
+        // One detector per tile index so parallel bodies never share an instance.
+        while (tile_detectors_.size() < tile_count) {
+            tile_detectors_.push_back(factory_());
+        }
+        std::vector<std::vector<cv::KeyPoint>> tile_keypoints(tile_count);
+        std::vector<cv::Mat> tile_descriptors(tile_count);
+        const cv::Rect bounds(0, 0, image.cols, image.rows);
+
+        cv::parallel_for_(cv::Range(0, static_cast<int>(tile_count)), [&](const cv::Range& range) {
+            for (int index = range.start; index < range.end; ++index) {
+                const auto slot = static_cast<std::size_t>(index);
+                const cv::Rect core = cv::Rect((index % tiles_x) * tile_size_,
+                                               (index / tiles_x) * tile_size_,
+                                               tile_size_,
+                                               tile_size_) &
+                                      bounds;
+                const cv::Rect context =
+                    cv::Rect(core.x - overlap_,
+                             core.y - overlap_,
+                             core.width + 2 * overlap_,
+                             core.height + 2 * overlap_) &
+                    bounds;
+
+                std::vector<cv::KeyPoint> found;
+                cv::Mat found_descriptors;
+                tile_detectors_[slot]->detect_and_compute(image(context),
+                                                          mask.empty() ? cv::Mat{} : mask(context),
+                                                          found,
+                                                          found_descriptors);
+
+                auto& kept = tile_keypoints[slot];
+                std::vector<int> rows;
+                kept.reserve(found.size());
+                rows.reserve(found.size());
+                for (std::size_t i = 0; i < found.size(); ++i) {
+                    cv::KeyPoint kp = found[i];
+                    kp.pt.x += static_cast<float>(context.x);
+                    kp.pt.y += static_cast<float>(context.y);
+                    if (!core.contains(cv::Point(static_cast<int>(kp.pt.x),
+                                                 static_cast<int>(kp.pt.y)))) {
+                        continue;  // Reported by the neighbouring tile that owns it.
+                    }
+                    kept.push_back(kp);
+                    rows.push_back(static_cast<int>(i));
+                }
+                tile_descriptors[slot] = select_rows(found_descriptors, rows);
+            }
+        });
+
+        keypoints.clear();
+        std::vector<cv::Mat> parts;
+        for (std::size_t i = 0; i < tile_count; ++i) {
+            keypoints.insert(keypoints.end(), tile_keypoints[i].begin(), tile_keypoints[i].end());
+            if (!tile_descriptors[i].empty()) {
+                parts.push_back(std::move(tile_descriptors[i]));
+            }
+        }
+        if (parts.empty()) {
+            descriptors.release();
+        } else {
+            cv::vconcat(parts, descriptors);
+        }
+        retain_strongest(keypoints, descriptors);
+    }
+
+    [[nodiscard]] DetectorBackend backend() const override { return whole_->backend(); }
+
+  private:
+    static cv::Mat select_rows(const cv::Mat& source, const std::vector<int>& rows) {
+        if (source.empty() || rows.empty()) {
+            return {};
+        }
+        if (static_cast<int>(rows.size()) == source.rows) {
+            return source;
+        }
+        cv::Mat selected(static_cast<int>(rows.size()), source.cols, source.type());
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            cv::Mat target = selected.row(static_cast<int>(i));
+            source.row(rows[i]).copyTo(target);
+        }
+        return selected;
+    }
+
+    // Per-tile detectors each apply the feature cap, so the merged set is trimmed back
+    // to the strongest `max_features_` to match a whole-image pass.
+    void retain_strongest(std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors) const {
+        if (max_features_ <= 0 || keypoints.size() <= static_cast<std::size_t>(max_features_)) {
+            return;
+        }
+        std::vector<int> order(keypoints.size());
+        std::iota(order.begin(), order.end(), 0);
+        const auto limit = static_cast<std::size_t>(max_features_);
+        std::nth_element(order.begin(),
+                         order.begin() + static_cast<std::ptrdiff_t>(limit),
+                         order.end(),
+                         [&](int a, int b) {
+                             return keypoints[static_cast<std::size_t>(a)].response >
+                                    keypoints[static_cast<std::size_t>(b)].response;
+                         });
+        order.resize(limit);
+        std::sort(order.begin(), order.end());  // Keep tile order among the survivors
+
+        std::vector<cv::KeyPoint> kept;
+        kept.reserve(limit);
+        for (const int index : order) {
+            kept.push_back(keypoints[static_cast<std::size_t>(index)]);
+        }
+        keypoints = std::move(kept);
+        descriptors = select_rows(descriptors, order);
+    }
+
+    Factory factory_;
+    int tile_size_;
+    int overlap_;
+    int max_features_;
+    std::unique_ptr<FeatureDetector> whole_;
+    std::vector<std::unique_ptr<FeatureDetector>> tile_detectors_;
+};
+
+std::unique_ptr<FeatureDetector> make_base_detector(
+    DetectorBackend backend,
+    const dist::common::FeatureExtractorConfig& config) {
+    switch (backend) {
+        case DetectorBackend::orb:
+            return std::make_unique<Feature2DDetector>(
+                cv::ORB::create(config.orb_n_features > 0 ? config.orb_n_features : 500), backend);
+        case DetectorBackend::akaze: {
+            auto akaze = cv::AKAZE::create();
+            akaze->setThreshold(config.akaze_threshold);
+            return std::make_unique<Feature2DDetector>(akaze, backend);
+        }
+        case DetectorBackend::cuda_orb:
+#if defined(DIST_HAVE_CUDA_FEATURES)
+            if (detector_available(backend)) {
+                return std::make_unique<CudaOrbDetector>(
+                    config.orb_n_features > 0 ? config.orb_n_features : 500);
+            }
+#endif
+            break;
+        case DetectorBackend::sift:
+            break;
+    }
+    return std::make_unique<Feature2DDetector>(
+        cv::SIFT::create(config.sift_n_features > 0 ? config.sift_n_features : 0,
+                         3,
+                         config.sift_contrast_threshold,
+                         config.sift_edge_threshold,
+                         1.6),
+        DetectorBackend::sift);
+}
+
+}  // namespace
+
+std::optional<DetectorBackend> parse_detector_backend(std::string_view value) {
+    if (value.empty() || value == "sift") {
+        return DetectorBackend::sift;
+    }
+    if (value == "orb") {
+        return DetectorBackend::orb;
+    }
+    if (value == "akaze") {
+        return DetectorBackend::akaze;
+    }
+    if (value == "cuda_orb" || value == "cuda") {
+        return DetectorBackend::cuda_orb;
+    }
+    return std::nullopt;
+}
+
+std::string_view to_string(DetectorBackend backend) {
+    switch (backend) {
+        case DetectorBackend::orb:
+            return "orb";
+        case DetectorBackend::akaze:
+            return "akaze";
+        case DetectorBackend::cuda_orb:
+            return "cuda_orb";
+        case DetectorBackend::sift:
+            break;
+    }
+    return "sift";
+}
+
+bool detector_available(DetectorBackend backend) {
+    if (backend != DetectorBackend::cuda_orb) {
+        return true;
+    }
+#if defined(DIST_HAVE_CUDA_FEATURES)
+    return cv::cuda::getCudaEnabledDeviceCount() > 0;
+#else
+    return false;
+#endif
+}
+
+std::unique_ptr<FeatureDetector> make_detector(DetectorBackend backend,
+                                               const dist::common::FeatureExtractorConfig& config) {
+    auto detector = make_base_detector(backend, config);
+    // The GPU detector already parallelises internally; tiling only helps CPU backends.
+    if (config.tile_size <= 0 || detector->backend() == DetectorBackend::cuda_orb) {
+        return detector;
+    }
+    const DetectorBackend resolved = detector->backend();
+    int max_features = 0;
+    if (resolved == DetectorBackend::sift) {
+        max_features = config.sift_n_features;
+    } else if (resolved == DetectorBackend::orb) {
+        max_features = config.orb_n_features > 0 ? config.orb_n_features : 500;
+    }
+    return std::make_unique<TiledDetector>(
+        [resolved, config] { return make_base_detector(resolved, config); },
+        config.tile_size,
+        config.tile_overlap,
+        max_features);
+}
+
+}  // namespace dist::features
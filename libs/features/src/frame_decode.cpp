@@ -0,0 +1,85 @@
+#include "dist/features/frame_decode.hpp"
+
+#include <opencv2/imgcodecs.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "dist/common/compression.hpp"
+#include "dist/common/image_encoding.hpp"
+
+namespace dist::features {
+
+namespace {
+
+cv::Mat wrap_raw_frame(const FrameLayout& layout, zmq::message_t& payload) {
+    const int width = layout.width;
+    const int height = layout.height;
+    const int cv_type = layout.cv_type;
+    const std::size_t step = layout.step;
+    const auto compression = dist::common::parse_compression(layout.compression);
+    if (width <= 0 || height <= 0 || cv_type < 0 || CV_MAT_CN(cv_type) > 4 || !compression) {
+        return {};
+    }
+
+    const auto row_bytes = static_cast<std::size_t>(width) * static_cast<std::size_t>(CV_ELEM_SIZE(cv_type));
+    const std::size_t stride = step == 0 ? row_bytes : step;
+    if (stride < row_bytes) {
+        return {};
+    }
+    const std::size_t expected = stride * static_cast<std::size_t>(height);
+
+    if (*compression == dist::common::Compression::none) {
+        if (payload.size() < expected) {
+            return {};
+        }
+        return cv::Mat(height, width, cv_type, payload.data(), stride);
+    }
+
+    // Compressed buffers are inflated straight into a freshly allocated matrix.
+    cv::Mat buffer = stride == row_bytes ? cv::Mat(height, width, cv_type)
+                                         : cv::Mat(1, static_cast<int>(expected), CV_8U);
+    if (!dist::common::decompress(*compression,
+                                  static_cast<const std::uint8_t*>(payload.data()),
+                                  payload.size(),
+                                  buffer.data,
+                                  expected)) {
+        return {};
+    }
+    if (stride == row_bytes) {
+        return buffer;
+    }
+    return cv::Mat(height, width, cv_type, buffer.data, stride).clone();
+}
+
+}  // namespace
+
+FrameLayout layout_from_header(const nlohmann::json& source_header) {
+    FrameLayout layout;
+    layout.encoding = source_header.value("encoding", layout.encoding);
+    layout.width = source_header.value("width", 0);
+    layout.height = source_header.value("height", 0);
+    layout.cv_type = source_header.value("cv_type", -1);
+    layout.step = source_header.value<std::size_t>("step", 0);
+    layout.compression = source_header.value("compression", layout.compression);
+    return layout;
+}
+
+cv::Mat decode_frame(const FrameLayout& layout, zmq::message_t& payload) {
+    if (layout.encoding == "raw") {
+        return wrap_raw_frame(layout, payload);
+    }
+    if (!dist::common::is_image_codec(layout.encoding) || payload.size() == 0) {
+        return {};
+    }
+    // Decode straight out of the message; callers may forward it untouched afterwards.
+    const cv::Mat encoded(1, static_cast<int>(payload.size()), CV_8U, payload.data());
+    return cv::imdecode(encoded, cv::IMREAD_COLOR);
+}
+
+cv::Mat decode_frame(const nlohmann::json& source_header, zmq::message_t& payload) {
+    return decode_frame(layout_from_header(source_header), payload);
+}
+
+}  // namespace dist::features
@@ -0,0 +1,62 @@
+#include "dist/features/keypoints.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace dist::features {
+
+nlohmann::json keypoints_to_json(const std::vector<cv::KeyPoint>& keypoints) {
+    nlohmann::json keypoints_json = nlohmann::json::array();
+    for (const auto& kp : keypoints) {
+        keypoints_json.push_back({
+            {"x", kp.pt.x},
+            {"y", kp.pt.y},
+            {"size", kp.size},
+            {"angle", kp.angle},
+            {"response", kp.response},
+            {"octave", kp.octave},
+            {"class_id", kp.class_id},
+        });
+    }
+    return keypoints_json;
+}
+
+std::vector<cv::KeyPoint> keypoints_from_json(const nlohmann::json& keypoints) {
+    std::vector<cv::KeyPoint> result;
+    if (!keypoints.is_array()) {
+        return result;
+    }
+    result.reserve(keypoints.size());
+    for (const auto& kp : keypoints) {
+        result.emplace_back(cv::Point2f(kp.value("x", 0.0F), kp.value("y", 0.0F)),
+                            kp.value("size", 1.0F),
+                            kp.value("angle", -1.0F),
+                            kp.value("response", 0.0F),
+                            kp.value("octave", 0),
+                            kp.value("class_id", -1));
+    }
+    return result;
+}
+
+void pack_keypoints(const std::vector<cv::KeyPoint>& keypoints, void* out) {
+    auto* cursor = static_cast<std::uint8_t*>(out);
+    for (const auto& kp : keypoints) {
+        const dist::common::wire::PackedKeypoint packed{
+            kp.pt.x, kp.pt.y, kp.size, kp.angle, kp.response, kp.octave, kp.class_id};
+        std::memcpy(cursor, &packed, sizeof(packed));
+        cursor += sizeof(packed);
+    }
+}
+
+std::vector<cv::KeyPoint> unpack_keypoints(const void* data, std::size_t size) {
+    const std::size_t count = size / sizeof(dist::common::wire::PackedKeypoint);
+    std::vector<cv::KeyPoint> result;
+    result.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto kp = dist::common::wire::read_keypoint(data, i);
+        result.emplace_back(cv::Point2f(kp.x, kp.y), kp.size, kp.angle, kp.response, kp.octave, kp.class_id);
+    }
+    return result;
+}
+
+}  // namespace dist::features
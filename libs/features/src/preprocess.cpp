@@ -0,0 +1,139 @@
+#include "dist/features/preprocess.hpp"
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <charconv>
+
+namespace dist::features {
+
+std::optional<RoiMode> parse_roi_mode(std::string_view value) {
+    if (value.empty() || value == "crop") {
+        return RoiMode::crop;
+    }
+    if (value == "mask") {
+        return RoiMode::mask;
+    }
+    return std::nullopt;
+}
+
+std::optional<cv::Rect> parse_roi(std::string_view value) {
+    int fields[4] = {};
+    std::size_t pos = 0;
+    for (int i = 0; i < 4; ++i) {
+        while (pos < value.size() && value[pos] == ' ') {
+            ++pos;
+        }
+        const auto [end, ec] = std::from_chars(value.data() + pos, value.data() + value.size(), fields[i]);
+        if (ec != std::errc{}) {
+            return std::nullopt;
+        }
+        pos = static_cast<std::size_t>(end - value.data());
+        if (i < 3) {
+            if (pos >= value.size() || value[pos] != ',') {
+                return std::nullopt;
+            }
+            ++pos;
+        }
+    }
+    if (pos != value.size() || fields[0] < 0 || fields[1] < 0 || fields[2] <= 0 || fields[3] <= 0) {
+        return std::nullopt;
+    }
+    return cv::Rect(fields[0], fields[1], fields[2], fields[3]);
+}
+
+Preprocessor::Preprocessor(const dist::common::FeatureExtractorConfig& config)
+    : max_dimension_(std::max(config.max_dimension, 0)), grayscale_(config.grayscale) {
+    // main() validates these settings and logs the fallbacks once.
+    if (!config.roi.empty()) {
+        roi_ = parse_roi(config.roi);
+    }
+    roi_mode_ = parse_roi_mode(config.roi_mode).value_or(RoiMode::crop);
+    if (!config.mask_path.empty()) {
+        mask_image_ = cv::imread(config.mask_path.string(), cv::IMREAD_GRAYSCALE);
+    }
+}
+
+cv::Mat Preprocessor::source_mask(const cv::Size& frame_size) {
+    const bool roi_mask = roi_ && roi_mode_ == RoiMode::mask;
+    if (mask_image_.empty() && !roi_mask) {
+        return {};
+    }
+    if (!cached_mask_.empty() && cached_mask_.size() == frame_size) {
+        return cached_mask_;
+    }
+    // Built once per frame size: the mask file stretched to the frame, ANDed with the ROI.
+    if (mask_image_.empty()) {
+        cached_mask_ = cv::Mat(frame_size, CV_8UC1, cv::Scalar(255));
+    } else {
+        cv::resize(mask_image_, cached_mask_, frame_size, 0, 0, cv::INTER_NEAREST);
+    }
+    if (roi_mask) {
+        const cv::Rect inside = *roi_ & cv::Rect(0, 0, frame_size.width, frame_size.height);
+        cv::Mat roi_only(frame_size, CV_8UC1, cv::Scalar(0));
+        if (!inside.empty()) {
+            cv::Mat target = roi_only(inside);  // Header onto roi_only's pixels
+            cached_mask_(inside).copyTo(target);
+        }
+        cached_mask_ = roi_only;
+    }
+    return cached_mask_;
+}
+
+PreparedFrame Preprocessor::prepare(const cv::Mat& image) {
+    PreparedFrame prepared;
+    prepared.image = image;
+    cv::Mat mask = source_mask(image.size());
+
+    if (roi_ && roi_mode_ == RoiMode::crop) {
+        const cv::Rect inside = *roi_ & cv::Rect(0, 0, image.cols, image.rows);
+        if (!inside.empty()) {
+            // A view, not a copy; the offset maps keypoints back.
+            prepared.image = image(inside);
+            prepared.offset = cv::Point2f(static_cast<float>(inside.x), static_cast<float>(inside.y));
+            if (!mask.empty()) {
+                mask = mask(inside);
+            }
+        }
+    }
+
+    // Convert before resizing so the resize touches one channel instead of three.
+    if (grayscale_ && prepared.image.channels() > 1) {
+        cv::Mat gray;
+        cv::cvtColor(prepared.image,
+                     gray,
+                     prepared.image.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+        prepared.image = gray;
+    }
+
+    const int longest = std::max(prepared.image.cols, prepared.image.rows);
+    if (max_dimension_ > 0 && longest > max_dimension_) {
+        prepared.scale = static_cast<double>(max_dimension_) / longest;
+        const cv::Size working(std::max(1, static_cast<int>(prepared.image.cols * prepared.scale + 0.5)),
+                               std::max(1, static_cast<int>(prepared.image.rows * prepared.scale + 0.5)));
+        cv::Mat resized;
+        cv::resize(prepared.image, resized, working, 0, 0, cv::INTER_AREA);
+        prepared.image = resized;
+        if (!mask.empty()) {
+            cv::Mat resized_mask;
+            cv::resize(mask, resized_mask, working, 0, 0, cv::INTER_NEAREST);
+            mask = resized_mask;
+        }
+    }
+    prepared.mask = mask;
+    return prepared;
+}
+
+void Preprocessor::restore_keypoints(const PreparedFrame& prepared, std::vector<cv::KeyPoint>& keypoints) {
+    if (prepared.scale == 1.0 && prepared.offset == cv::Point2f{}) {
+        return;
+    }
+    const auto inverse = static_cast<float>(1.0 / prepared.scale);
+    for (auto& kp : keypoints) {
+        kp.pt = kp.pt * inverse + prepared.offset;
+        kp.size *= inverse;
+    }
+}
+
+}  // namespace dist::features
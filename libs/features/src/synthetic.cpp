@@ -0,0 +1,48 @@
+#include "dist/features/synthetic.hpp"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+
+namespace dist::features {
+
+namespace {
+
+constexpr int kPixelsPerShape = 4000;  // Roughly SIFT-dense at 1080p without saturating
+
+}  // namespace
+
+cv::Mat synthetic_frame(int width, int height, std::uint64_t seed) {
+    width = std::max(width, 16);
+    height = std::max(height, 16);
+    cv::Mat frame(height, width, CV_8UC3);
+    for (int y = 0; y < height; ++y) {
+        auto* row = frame.ptr<cv::Vec3b>(y);
+        for (int x = 0; x < width; ++x) {
+            row[x] = cv::Vec3b(static_cast<uchar>(x * 255 / width),
+                               static_cast<uchar>(y * 255 / height),
+                               static_cast<uchar>((x + y) * 127 / (width + height)));
+        }
+    }
+
+    cv::RNG rng(seed);
+    const int shapes = std::max(width * height / kPixelsPerShape, 1);
+    const int max_extent = std::max(std::min(width, height) / 20, 4);
+    for (int i = 0; i < shapes; ++i) {
+        const cv::Point center(rng.uniform(0, width), rng.uniform(0, height));
+        const int extent = rng.uniform(2, max_extent);
+        const cv::Scalar color(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+        if ((i & 1) == 0) {
+            cv::circle(frame, center, extent, color, cv::FILLED);
+        } else {
+            cv::rectangle(frame,
+                          center,
+                          center + cv::Point(extent, rng.uniform(2, max_extent)),
+                          color,
+                          cv::FILLED);
+        }
+    }
+    return frame;
+}
+
+}  // namespace dist::features
@@ -8,14 +8,23 @@ BIN_DIR="${BIN_DIR:-${BUILD_DIR}/bin}"
 ENV_PATH="${DIST_ENV_PATH:-${ROOT_DIR}/.env}"
 GENERATE_ONCE=false
 ENABLE_ANNOTATED=false
+FUSED=false
+BENCH=false
+declare -a BENCH_ARGS=()
 
 usage() {
     cat <<'EOF'
-Usage: ./scripts/run_all.sh [--once] [--annotated]
+Usage: ./scripts/run_all.sh [--once] [--annotated] [--fused] [--bench [--bench-frames N]
+                            [--bench-width W] [--bench-height H] [--bench-fps F]]
 
   --once        Run the image generator for a single pass through the dataset.
   --annotated   Ask the feature extractor to emit annotated frames (and store
                 them in the logger's annotated output directory).
+  --fused       Run the three stages as threads of the single pipeline binary,
+                linked over inproc:// instead of the configured endpoints.
+  --bench       Synthetic load run: the generator publishes N in-memory frames
+                (default 1000 at 1920x1080, unpaced) and every stage logs its
+                throughput, p50/p99 stage latencies and drops before exiting.
 EOF
 }
 
@@ -29,6 +38,22 @@ while [[ $# -gt 0 ]]; do
             ENABLE_ANNOTATED=true
             shift
             ;;
+        --fused)
+            FUSED=true
+            shift
+            ;;
+        --bench)
+            BENCH=true
+            shift
+            ;;
+        --bench-frames|--bench-width|--bench-height|--bench-fps)
+            if [[ $# -lt 2 ]]; then
+                echo "[run_all] $1 needs a value" >&2
+                exit 1
+            fi
+            BENCH_ARGS+=("$1" "$2")
+            shift 2
+            ;;
         -h|--help)
             usage
             exit 0
@@ -41,7 +66,11 @@ while [[ $# -gt 0 ]]; do
     esac
 done
 
-for exe in image_generator feature_extractor data_logger; do
+declare -a EXES=(image_generator feature_extractor data_logger)
+if [[ "${FUSED}" == true ]]; then
+    EXES=(pipeline)
+fi
+for exe in "${EXES[@]}"; do
     # Fail fast if somebody forgot to build.
     if [[ ! -x "${BIN_DIR}/${exe}" ]]; then
         echo "[run_all] Missing executable ${BIN_DIR}/${exe}. Run scripts/build.sh first." >&2
@@ -56,6 +85,21 @@ fi
 
 export DIST_ENV_PATH="${ENV_PATH}"
 
+if [[ "${FUSED}" == true ]]; then
+    declare -a PIPELINE_ARGS=()
+    if [[ "${GENERATE_ONCE}" == true ]]; then
+        PIPELINE_ARGS+=(--once)
+    fi
+    if [[ "${ENABLE_ANNOTATED}" == true ]]; then
+        PIPELINE_ARGS+=(--annotated)
+    fi
+    if [[ "${BENCH}" == true ]]; then
+        PIPELINE_ARGS+=(--bench ${BENCH_ARGS[@]+"${BENCH_ARGS[@]}"})
+    fi
+    echo "[run_all] Launching fused pipeline (Ctrl+C to stop)"
+    exec "${BIN_DIR}/pipeline" ${PIPELINE_ARGS[@]+"${PIPELINE_ARGS[@]}"}
+fi
+
 echo "[run_all] Launching processes (Ctrl+C to stop)"
 
 declare -a PIDS=()
@@ -80,6 +124,22 @@ cleanup() {
 
 trap cleanup EXIT INT TERM
 
+if [[ "${BENCH}" == true ]]; then
+    # Each stage exits on its own once the generator is done and its input goes quiet.
+    ("${BIN_DIR}/data_logger" --bench) &
+    PIDS+=($!)
+    ("${BIN_DIR}/feature_extractor" --bench ${FE_ARGS[@]+"${FE_ARGS[@]}"}) &
+    PIDS+=($!)
+    ("${BIN_DIR}/image_generator" --bench ${BENCH_ARGS[@]+"${BENCH_ARGS[@]}"}) &
+    PIDS+=($!)
+    status=0
+    for pid in "${PIDS[@]}"; do
+        wait "${pid}" || status=$?
+    done
+    trap - EXIT
+    exit "${status}"
+fi
+
 # Launch order: logger -> extractor -> generator to avoid dropping frames.
 ("${BIN_DIR}/data_logger") &
 PIDS+=($!)